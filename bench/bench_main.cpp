@@ -0,0 +1,68 @@
+#include "stdlib.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+
+#include "bench/sql_bench.h"
+
+int main(int argc, char* argv[])
+{
+    // --repeat N runs every case N times and keeps the median
+    // --max-rows N skips the scans over more than N rows
+    // --filter PREFIX runs only the cases whose name starts with PREFIX
+    // --json PATH writes the results to PATH instead of stdout
+    // --compare PATH flags every result worse than the one saved in PATH by more than --threshold PERCENT
+    sql::bench::BenchOption_t option;
+    for (int index = 1; index < argc; index ++)
+    {
+        bool has_value = (index + 1 < argc);
+        if (has_value && strcmp(argv[index], "--repeat") == 0) option.num_repeat = static_cast<uint32_t>(atoi(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--max-rows") == 0) option.max_row = static_cast<uint32_t>(atoll(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--filter") == 0) option.name_prefix = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--json") == 0) option.json_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--compare") == 0) option.baseline_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--threshold") == 0) option.threshold_percent = atof(argv[++ index]);
+        else
+        {
+            printf("Unknown option \"%s\"\n", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<sql::bench::BenchResult_t> vec_baseline;
+    if (!option.baseline_path.empty() && !sql::bench::loadResultJson(option.baseline_path, vec_baseline))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // the engine prints every result row to stdout, keep the report away from it
+    fflush(stdout);
+    int report_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (report_fd < 0 || null_fd < 0 || dup2(null_fd, STDOUT_FILENO) < 0)
+    {
+        printf("Fail to silence the engine output\n");
+        return EXIT_FAILURE;
+    }
+    close(null_fd);
+
+    sql::bench::SqlBench_t bench(option);
+    bench.run();
+    fflush(stdout);
+
+    FILE* p_report = option.json_path.empty() ? fdopen(report_fd, "w") : fopen(option.json_path.c_str(), "w");
+    std::string source = "sql_bench seed " + std::to_string(BENCH_SEED) + " repeat " + std::to_string(option.num_repeat);
+    if (p_report == nullptr || !sql::bench::writeResultJson(p_report, source, bench.getResult()))
+    {
+        fprintf(stderr, "Fail to write the results\n");
+        return EXIT_FAILURE;
+    }
+    fclose(p_report);
+
+    if (!option.baseline_path.empty() && !sql::bench::compareResult(bench.getResult(), vec_baseline, option.threshold_percent, stderr))
+    {
+        fprintf(stderr, "Regression against \"%s\" beyond %.1f%%\n", option.baseline_path.c_str(), option.threshold_percent);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,78 @@
+#include "map"
+#include "string.h"
+
+#include "bench/bench_result.h"
+
+namespace sql::bench
+{
+
+bool writeResultJson(FILE* p_file, const std::string& source, const std::vector<BenchResult_t>& vec_result)
+{
+    fprintf(p_file, "{\n  \"source\": \"%s\",\n  \"results\": [\n", source.c_str());
+    for (size_t index = 0; index < vec_result.size(); index ++)
+    {
+        auto& result = vec_result[index];
+        fprintf(p_file, "    {\"name\": \"%s\", \"unit\": \"%s\", \"value\": %.3f, \"higher_is_better\": %s}%s\n", result.name.c_str(), result.unit.c_str(),
+                result.value, result.is_higher_better ? "true" : "false", (index + 1 < vec_result.size()) ? "," : "");
+    }
+    fprintf(p_file, "  ]\n}\n");
+    return fflush(p_file) == 0;
+}
+
+// reads back what writeResultJson() wrote, one result per line
+bool loadResultJson(const std::string& path, std::vector<BenchResult_t>& vec_result)
+{
+    FILE* p_file = fopen(path.c_str(), "r");
+    if (p_file == nullptr)
+    {
+        printf("Fail to open baseline \"%s\"\n", path.c_str());
+        return false;
+    }
+
+    char line[512];
+    while (fgets(line, sizeof(line), p_file) != nullptr)
+    {
+        char name[128], unit[32], is_higher_better[8];
+        double value;
+        if (sscanf(line, " {\"name\": \"%127[^\"]\", \"unit\": \"%31[^\"]\", \"value\": %lf, \"higher_is_better\": %7[a-z]", name, unit, &value, is_higher_better) != 4) continue;
+        vec_result.emplace_back(BenchResult_t{name, unit, value, strcmp(is_higher_better, "true") == 0});
+    }
+    fclose(p_file);
+
+    if (vec_result.empty())
+    {
+        printf("Fail to load baseline \"%s\": no result found\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool compareResult(const std::vector<BenchResult_t>& vec_result, const std::vector<BenchResult_t>& vec_baseline, double threshold_percent, FILE* p_file)
+{
+    std::map<std::string, const BenchResult_t*> map_baseline;
+    for (auto& baseline : vec_baseline) map_baseline.emplace(baseline.name, &baseline);
+
+    bool is_passed = true;
+    for (auto& result : vec_result)
+    {
+        auto iter_baseline = map_baseline.find(result.name);
+        if (iter_baseline == map_baseline.end() || iter_baseline->second->value <= 0)
+        {
+            fprintf(p_file, "%-32s %14.3f %-7s no baseline\n", result.name.c_str(), result.value, result.unit.c_str());
+            continue;
+        }
+
+        // positive change is an improvement whichever way the unit points
+        double baseline_value = iter_baseline->second->value;
+        double change_percent = (result.value - baseline_value) / baseline_value * 100;
+        if (!result.is_higher_better) change_percent = -change_percent;
+        bool is_regressed = change_percent < -threshold_percent;
+        is_passed = is_passed && !is_regressed;
+
+        fprintf(p_file, "%-32s %14.3f %-7s baseline %14.3f  %+7.1f%%%s\n", result.name.c_str(), result.value, result.unit.c_str(),
+                baseline_value, change_percent, is_regressed ? "  REGRESSED" : "");
+    }
+    return is_passed;
+}
+
+} // namespace sql::bench
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "string"
+#include "vector"
+#include "stdio.h"
+
+#define BENCH_DEFAULT_THRESHOLD  10.0       // percent a result may get worse before it counts as a regression
+
+namespace sql::bench
+{
+
+// one measured number, sql_bench and sql_replay both report in this form so either can be compared to a baseline
+struct BenchResult_t
+{
+    std::string  name;
+    std::string  unit;
+    double       value = 0;
+    bool         is_higher_better = true;
+};
+
+// source says what produced the results, e.g. the seed of a suite or the trace of a replay
+bool writeResultJson(FILE* p_file, const std::string& source, const std::vector<BenchResult_t>& vec_result);
+bool loadResultJson(const std::string& path, std::vector<BenchResult_t>& vec_result);
+
+// false when a result is worse than its baseline by more than the threshold
+bool compareResult(const std::vector<BenchResult_t>& vec_result, const std::vector<BenchResult_t>& vec_baseline, double threshold_percent, FILE* p_file);
+
+} // namespace sql::bench
@@ -0,0 +1,95 @@
+#include "stdlib.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+
+#include "bench/sql_replay.h"
+#include "trace/sql_span.h"
+
+int main(int argc, char* argv[])
+{
+    // sql_replay TRACE, the trace a shell wrote with --capture, it should start from an empty engine
+    // --paced keeps the captured gaps between the packets instead of sending them as fast as possible
+    // --shard N replays against N shards
+    // --span-trace PATH writes a timeline of the replayed statements in Chrome trace format
+    // --json PATH writes the results to PATH, --compare PATH flags the ones worse than PATH by more than --threshold PERCENT
+    sql::bench::ReplayOption_t option;
+    for (int index = 1; index < argc; index ++)
+    {
+        bool has_value = (index + 1 < argc);
+        if (strcmp(argv[index], "--paced") == 0) option.is_paced = true;
+        else if (has_value && strcmp(argv[index], "--shard") == 0) option.executor.num_shard = static_cast<uint32_t>(atoi(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--span-trace") == 0) option.span_trace_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--json") == 0) option.json_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--compare") == 0) option.baseline_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--threshold") == 0) option.threshold_percent = atof(argv[++ index]);
+        else if (argv[index][0] != '-' && option.trace_path.empty()) option.trace_path = argv[index];
+        else
+        {
+            printf("Unknown option \"%s\"\n", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (option.trace_path.empty())
+    {
+        printf("Usage: sql_replay TRACE [--paced] [--shard N] [--span-trace PATH] [--json PATH] [--compare PATH] [--threshold PERCENT]\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<sql::bench::BenchResult_t> vec_baseline;
+    if (!option.baseline_path.empty() && !sql::bench::loadResultJson(option.baseline_path, vec_baseline))
+    {
+        return EXIT_FAILURE;
+    }
+
+    sql::bench::SqlReplay_t replay(option);
+    if (!replay.open())
+    {
+        return EXIT_FAILURE;
+    }
+    if (!option.span_trace_path.empty() && !sql::trace::SqlSpanTracer_t::getInstance().start(option.span_trace_path))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // the statements print their results to stdout, only the report is wanted
+    fflush(stdout);
+    int report_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (report_fd < 0 || null_fd < 0 || dup2(null_fd, STDOUT_FILENO) < 0)
+    {
+        printf("Fail to silence the engine output\n");
+        return EXIT_FAILURE;
+    }
+    close(null_fd);
+
+    bool is_replayed = replay.run();
+    fflush(stdout);
+
+    FILE* p_report = fdopen(report_fd, "w");
+    if (!is_replayed)
+    {
+        fprintf(p_report, "Fail to replay \"%s\"\n", option.trace_path.c_str());
+        return EXIT_FAILURE;
+    }
+    replay.printReport(p_report);
+    fflush(p_report);
+
+    if (!option.json_path.empty())
+    {
+        FILE* p_json = fopen(option.json_path.c_str(), "w");
+        if (p_json == nullptr || !sql::bench::writeResultJson(p_json, "sql_replay " + option.trace_path, replay.getResult()))
+        {
+            fprintf(p_report, "Fail to write the results to \"%s\"\n", option.json_path.c_str());
+            return EXIT_FAILURE;
+        }
+        fclose(p_json);
+    }
+
+    if (!option.baseline_path.empty() && !sql::bench::compareResult(replay.getResult(), vec_baseline, option.threshold_percent, p_report))
+    {
+        fprintf(p_report, "Regression against \"%s\" beyond %.1f%%\n", option.baseline_path.c_str(), option.threshold_percent);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+#include "algorithm"
+#include "memory"
+#include "numeric"
+#include "random"
+#include "thread"
+
+#include "bench/sql_bench.h"
+#include "common/lock_free_queue.h"
+#include "common/sql_app_util.h"
+#include "parser/parser_fsm.h"
+#include "executor/executor_sql.h"
+#include "executor/executor_metrics.h"
+
+namespace sql::bench
+{
+
+using namespace sql::exec;
+
+#define BENCH_PARSER_ROUND      200000
+#define BENCH_QUEUE_MESSAGE     200000
+#define BENCH_INSERT_ROW        1000000
+#define BENCH_DELETE_ROW        1000000
+#define BENCH_DELETE_ROUND      100      // each round deletes one value of "v", 0.1% of the rows
+#define BENCH_VALUE_RANGE       1000     // "v" is uniform in [0, BENCH_VALUE_RANGE)
+
+static inline double getElapsedSec(uint64_t begin_ns)
+{
+    return (getSteadyNs() - begin_ns) / 1e9;
+}
+
+static SqlTable_t* createTable(SqlDatabase_t& db)
+{
+    db.createTable("t", {{"id", EnumValueType::VALUE_TYPE_INT, true}, {"v", EnumValueType::VALUE_TYPE_INT}});
+    return db.getTableByName("t");
+}
+
+// primary keys in a fixed shuffled order and uniform values, the same for every run
+static void generateRow(uint32_t num_row, std::vector<std::vector<SqlValue_t>>& vec_row)
+{
+    std::mt19937 random(BENCH_SEED);
+    std::uniform_int_distribution<int32_t> value_distribution(0, BENCH_VALUE_RANGE - 1);
+
+    std::vector<int32_t> vec_key(num_row);
+    std::iota(vec_key.begin(), vec_key.end(), 0);
+    std::shuffle(vec_key.begin(), vec_key.end(), random);
+
+    vec_row.clear();
+    vec_row.reserve(num_row);
+    for (uint32_t index = 0; index < num_row; index ++)
+    {
+        vec_row.emplace_back(std::vector<SqlValue_t>{SqlValue_t{vec_key[index]}, SqlValue_t{value_distribution(random)}});
+    }
+}
+
+static void loadTable(SqlTable_t& table, uint32_t num_row)
+{
+    std::vector<std::vector<SqlValue_t>> vec_row;
+    generateRow(num_row, vec_row);
+    for (auto& row : vec_row) table.appendRow(std::move(row));
+}
+
+// one in flight measures the bare handoff, otherwise the producer streams and the latency includes queueing
+static HistogramSnapshot_t runHandoff(uint32_t num_message, bool is_one_in_flight, double& elapsed_sec)
+{
+    LockFreeQueue<uint64_t> lfq(LFQ_MAX_SIZE);
+    SqlHistogram_t latency_ns;
+
+    uint64_t begin_ns = getSteadyNs();
+    std::thread th_consumer([&]()
+    {
+        uint64_t enqueue_ns;
+        for (uint32_t index = 0; index < num_message; )
+        {
+            if (!lfq.pop(enqueue_ns))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            latency_ns.record(getSteadyNs() - enqueue_ns);
+            index ++;
+        }
+    });
+    for (uint32_t index = 0; index < num_message; index ++)
+    {
+        // yield while spinning, on a single core the other side could not run otherwise
+        while (is_one_in_flight && !lfq.isEmpty()) std::this_thread::yield();
+        while (!lfq.push(getSteadyNs())) std::this_thread::yield();
+    }
+    th_consumer.join();
+    elapsed_sec = getElapsedSec(begin_ns);
+
+    HistogramSnapshot_t snapshot;
+    latency_ns.addTo(snapshot);
+    return snapshot;
+}
+
+void SqlBench_t::run()
+{
+    runParser();
+    runQueue();
+    runInsert();
+    runScan();
+    runDelete();
+}
+
+bool SqlBench_t::isWanted(const std::string& name) const
+{
+    return name.compare(0, option_.name_prefix.size(), option_.name_prefix) == 0;
+}
+
+void SqlBench_t::measure(const std::string& name, const std::string& unit, bool is_higher_better, const BenchBody_t& body)
+{
+    if (!isWanted(name)) return;
+
+    std::vector<double> vec_value;
+    for (uint32_t repeat = 0; repeat < std::max<uint32_t>(option_.num_repeat, 1); repeat ++) vec_value.emplace_back(body());
+    addResult(name, unit, is_higher_better, vec_value);
+}
+
+void SqlBench_t::addResult(const std::string& name, const std::string& unit, bool is_higher_better, std::vector<double>& vec_value)
+{
+    if (!isWanted(name) || vec_value.empty()) return;
+
+    // the median of the repeats, one slow run from a noisy neighbour does not move it
+    std::sort(vec_value.begin(), vec_value.end());
+    vec_result_.emplace_back(BenchResult_t{name, unit, vec_value[vec_value.size() / 2], is_higher_better});
+    fprintf(stderr, "%-32s %14.3f %s\n", name.c_str(), vec_result_.back().value, unit.c_str());
+}
+
+void SqlBench_t::runParser()
+{
+    static const std::vector<std::pair<std::string, std::string>> vec_statement = {
+        {"parser.create_table", "create table t id INT PRIMARY v INT name STRING BLOOM"},
+        {"parser.insert",       "insert t values 42 7 n00042"},
+        {"parser.select",       "select * from t"},
+        {"parser.select_where", "select id, v from t where v>=990 order by id desc limit 10"},
+        {"parser.select_group", "select v, count(*), sum(id) from t where id<1000 group by v"},
+        {"parser.select_join",  "select t.id, u.k from t join u on t.id=u.id where v=7"},
+        {"parser.delete",       "delete t where id<5000"},
+        {"parser.transaction",  "begin"},
+    };
+
+    for (auto& [name, statement] : vec_statement)
+    {
+        measure(name, "stmt/s", true, [&statement]()
+        {
+            auto sp_lfq = std::make_shared<LockFreeQueue<PacketEnvelope_t>>(LFQ_MAX_SIZE);
+            auto sp_running = std::make_shared<bool>(true);
+            sql::fsm::FsmParser parser;
+            parser.init(sp_lfq, sp_running);
+
+            // the same path as the shell: split the line, run the state machine, hand the packet over
+            PacketEnvelope_t envelope;
+            uint64_t begin_ns = getSteadyNs();
+            for (uint32_t round = 0; round < BENCH_PARSER_ROUND; round ++)
+            {
+                std::string line = statement;
+                std::vector<std::string> params;
+                splitArgument(line, params);
+                parser.parseInput(params);
+                sp_lfq->popSwap(envelope);
+            }
+            return BENCH_PARSER_ROUND / getElapsedSec(begin_ns);
+        });
+    }
+}
+
+void SqlBench_t::runQueue()
+{
+    measure("queue.handoff_p50", "ns", false, []()
+    {
+        double elapsed_sec;
+        return static_cast<double>(runHandoff(BENCH_QUEUE_MESSAGE, true, elapsed_sec).getPercentile(0.5));
+    });
+    measure("queue.handoff_p99", "ns", false, []()
+    {
+        double elapsed_sec;
+        return static_cast<double>(runHandoff(BENCH_QUEUE_MESSAGE, true, elapsed_sec).getPercentile(0.99));
+    });
+    measure("queue.stream", "msg/s", true, []()
+    {
+        double elapsed_sec;
+        runHandoff(BENCH_QUEUE_MESSAGE, false, elapsed_sec);
+        return BENCH_QUEUE_MESSAGE / elapsed_sec;
+    });
+}
+
+void SqlBench_t::runInsert()
+{
+    uint32_t num_row = std::min<uint32_t>(BENCH_INSERT_ROW, option_.max_row);
+
+    // one autocommitted transaction per row, the way the dispatcher runs an insert
+    measure("insert.checked", "rows/s", true, [num_row]()
+    {
+        std::vector<std::vector<SqlValue_t>> vec_row;
+        generateRow(num_row, vec_row);
+        std::vector<std::vector<std::string>> vec_raw_row;
+        vec_raw_row.reserve(num_row);
+        for (auto& row : vec_row)
+        {
+            vec_raw_row.emplace_back(std::vector<std::string>{std::to_string(std::get<int32_t>(row[0])), std::to_string(std::get<int32_t>(row[1]))});
+        }
+
+        SqlDatabase_t db;
+        auto p_table = createTable(db);
+        SqlTransactionManager_t txn_manager;
+        uint64_t begin_ns = getSteadyNs();
+        for (auto& raw_row : vec_raw_row)
+        {
+            auto txn = txn_manager.begin();
+            if (p_table->insertRow(txn, raw_row)) txn_manager.commit(txn);
+            else txn_manager.rollback(txn);
+        }
+        return num_row / getElapsedSec(begin_ns);
+    });
+
+    // every table needs a primary key, the unchecked path is the bulk append a shard gather uses:
+    // typed values, no duplicate probe, no transaction
+    measure("insert.unchecked", "rows/s", true, [num_row]()
+    {
+        std::vector<std::vector<SqlValue_t>> vec_row;
+        generateRow(num_row, vec_row);
+
+        SqlDatabase_t db;
+        auto p_table = createTable(db);
+        uint64_t begin_ns = getSteadyNs();
+        for (auto& row : vec_row) p_table->appendRow(std::move(row));
+        return num_row / getElapsedSec(begin_ns);
+    });
+}
+
+void SqlBench_t::runScan()
+{
+    static const std::vector<std::pair<uint32_t, std::string>> vec_size = {{10000, "10k"}, {1000000, "1m"}, {10000000, "10m"}};
+
+    for (auto& [num_row, label] : vec_size)
+    {
+        std::string selective_name = "scan.selective." + label;
+        std::string full_name = "scan.full." + label;
+        if (num_row > option_.max_row || (!isWanted(selective_name) && !isWanted(full_name))) continue;
+
+        // loaded once per size, a scan does not change the table
+        SqlDatabase_t db;
+        auto p_table = createTable(db);
+        loadTable(*p_table, num_row);
+        SqlTransactionManager_t txn_manager;
+        auto snapshot = txn_manager.getSnapshot();
+
+        // the values are uniform, so zone maps prune nothing and the predicate sees every row
+        measure(selective_name, "ms", false, [&]()
+        {
+            uint64_t begin_ns = getSteadyNs();
+            p_table->selectData(snapshot, {{"id"}, {"v"}}, ConditionDescriptor_t{"v", EnumConditionActionType::EQ, SqlValue_t{std::string("7")}}, {}, {});
+            return getElapsedSec(begin_ns) * 1e3;
+        });
+        measure(full_name, "ms", false, [&]()
+        {
+            uint64_t begin_ns = getSteadyNs();
+            p_table->selectGroupData(snapshot, {{"*", EnumAggregateType::COUNT}, {"v", EnumAggregateType::SUM}}, ConditionDescriptor_t{}, "");
+            return getElapsedSec(begin_ns) * 1e3;
+        });
+    }
+}
+
+void SqlBench_t::runDelete()
+{
+    if (!isWanted("delete.heavy") && !isWanted("delete.scan_after")) return;
+    uint32_t num_row = std::min<uint32_t>(BENCH_DELETE_ROW, option_.max_row);
+
+    // both come out of the same run, the scan after the deletes pays for the dead versions left behind
+    std::vector<double> vec_rate, vec_scan_ms;
+    for (uint32_t repeat = 0; repeat < std::max<uint32_t>(option_.num_repeat, 1); repeat ++)
+    {
+        SqlDatabase_t db;
+        auto p_table = createTable(db);
+        loadTable(*p_table, num_row);
+        SqlTransactionManager_t txn_manager;
+
+        uint64_t num_deleted = 0;
+        uint64_t begin_ns = getSteadyNs();
+        for (uint32_t round = 0; round < BENCH_DELETE_ROUND; round ++)
+        {
+            auto txn = txn_manager.begin();
+            uint32_t num_round_deleted = 0;
+            ConditionDescriptor_t condition{"v", EnumConditionActionType::EQ, SqlValue_t{std::to_string(round)}};
+            if (p_table->deleteRow(txn, condition, num_round_deleted)) txn_manager.commit(txn);
+            else txn_manager.rollback(txn);
+            num_deleted += num_round_deleted;
+        }
+        vec_rate.emplace_back(num_deleted / getElapsedSec(begin_ns));
+
+        begin_ns = getSteadyNs();
+        p_table->selectGroupData(txn_manager.getSnapshot(), {{"*", EnumAggregateType::COUNT}}, ConditionDescriptor_t{}, "");
+        vec_scan_ms.emplace_back(getElapsedSec(begin_ns) * 1e3);
+    }
+    addResult("delete.heavy", "rows/s", true, vec_rate);
+    addResult("delete.scan_after", "ms", false, vec_scan_ms);
+}
+
+} // namespace sql::bench
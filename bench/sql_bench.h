@@ -0,0 +1,53 @@
+#pragma once
+
+#include "string"
+#include "vector"
+#include "functional"
+#include "stdint.h"
+#include "stdio.h"
+
+#include "bench/bench_result.h"
+
+#define BENCH_SEED               20240601   // every generator starts here, two runs see the same data
+#define BENCH_DEFAULT_REPEAT     3
+#define BENCH_DEFAULT_MAX_ROW    10000000
+
+namespace sql::bench
+{
+
+struct BenchOption_t
+{
+    uint32_t     num_repeat = BENCH_DEFAULT_REPEAT;
+    uint32_t     max_row = BENCH_DEFAULT_MAX_ROW;      // scan sizes above it are skipped
+    std::string  name_prefix;                          // only cases whose name starts with it run
+    std::string  json_path;                            // stdout when empty
+    std::string  baseline_path;                        // compare against it when set
+    double       threshold_percent = BENCH_DEFAULT_THRESHOLD;
+};
+
+class SqlBench_t
+{
+public:
+    explicit SqlBench_t(const BenchOption_t& option) : option_(option) {}
+
+    void run();
+    inline const std::vector<BenchResult_t>& getResult() const { return vec_result_; }
+
+private:
+    using BenchBody_t = std::function<double()>;   // runs the case once, returns the measured value
+
+    bool isWanted(const std::string& name) const;
+    void measure(const std::string& name, const std::string& unit, bool is_higher_better, const BenchBody_t& body);
+    void addResult(const std::string& name, const std::string& unit, bool is_higher_better, std::vector<double>& vec_value);
+
+    void runParser();
+    void runQueue();
+    void runInsert();
+    void runScan();
+    void runDelete();
+
+    BenchOption_t               option_;
+    std::vector<BenchResult_t>  vec_result_;
+};
+
+} // namespace sql::bench
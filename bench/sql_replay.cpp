@@ -0,0 +1,135 @@
+#include "algorithm"
+#include "thread"
+
+#include "bench/sql_replay.h"
+
+namespace sql::bench
+{
+
+using namespace sql::exec;
+
+static uint64_t getDispatchedNum()
+{
+    auto& registry = SqlMetricsRegistry_t::getInstance();
+    uint64_t num_dispatched = 0;
+    for (size_t slot = 0; slot < EXEC_METRICS_SHARD_TASK; slot ++)
+    {
+        PacketSnapshot_t snapshot;
+        registry.getPacketSnapshot(slot, snapshot);
+        num_dispatched += snapshot.num_packet;
+    }
+    return num_dispatched;
+}
+
+// slot names are phrases, result names are dotted words
+static std::string getResultName(size_t slot)
+{
+    std::string name = SqlMetricsRegistry_t::getSlotName(slot);
+    for (auto& _char : name)
+    {
+        if (_char == ' ') _char = '_';
+    }
+    return name;
+}
+
+bool SqlReplay_t::open()
+{
+    return reader_.open(option_.trace_path);
+}
+
+bool SqlReplay_t::run()
+{
+    auto sp_lfq = std::make_shared<LockFreeQueue<PacketEnvelope_t>>(LFQ_MAX_SIZE);
+    SqlExecutorDispatcher dispatcher;
+    if (!dispatcher.init(sp_lfq, option_.executor))
+    {
+        printf("Fail to start the executor\n");
+        return false;
+    }
+
+    PacketEnvelope_t envelope;
+    uint64_t trace_begin_ns = 0;
+    uint64_t replay_begin_ns = getSteadyNs();
+    while (reader_.read(envelope))
+    {
+        if (num_packet_ == 0) trace_begin_ns = envelope.enqueue_ns;
+
+        // paced, a packet waits for its captured offset from the first one
+        if (option_.is_paced)
+        {
+            uint64_t due_ns = replay_begin_ns + (envelope.enqueue_ns - trace_begin_ns);
+            uint64_t now_ns = getSteadyNs();
+            if (due_ns > now_ns) std::this_thread::sleep_for(std::chrono::nanoseconds(due_ns - now_ns));
+        }
+
+        // restamped, the wait the executor reports is the one of this run
+        envelope.enqueue_ns = getSteadyNs();
+        while (!sp_lfq->pushSwap(envelope)) std::this_thread::yield();
+        num_packet_ ++;
+    }
+    is_trace_broken_ = reader_.isBroken();
+
+    // the dispatcher counts a packet once it has run, wait for the last one
+    while (getDispatchedNum() < num_packet_) std::this_thread::sleep_for(std::chrono::microseconds(100));
+    elapsed_ns_ = getSteadyNs() - replay_begin_ns;
+    dispatcher.stop();
+
+    collectResult();
+    return true;
+}
+
+void SqlReplay_t::collectResult()
+{
+    auto& registry = SqlMetricsRegistry_t::getInstance();
+    PacketSnapshot_t total;
+    for (size_t slot = 0; slot < arr_packet_.size(); slot ++)
+    {
+        auto& packet = arr_packet_[slot];
+        registry.getPacketSnapshot(slot, packet);
+        if (packet.num_packet == 0) continue;
+
+        total.num_packet += packet.num_packet;
+        total.num_failed += packet.num_failed;
+        total.num_row += packet.num_row;
+        for (uint32_t bucket = 0; bucket < EXEC_METRICS_BUCKET_NUM; bucket ++)
+        {
+            total.wait_ns.arr_bucket[bucket] += packet.wait_ns.arr_bucket[bucket];
+            total.exec_ns.arr_bucket[bucket] += packet.exec_ns.arr_bucket[bucket];
+        }
+        total.wait_ns.count += packet.wait_ns.count;
+        total.exec_ns.count += packet.exec_ns.count;
+        total.wait_ns.max_value = std::max(total.wait_ns.max_value, packet.wait_ns.max_value);
+        total.exec_ns.max_value = std::max(total.exec_ns.max_value, packet.exec_ns.max_value);
+
+        std::string name = "replay." + getResultName(slot);
+        vec_result_.emplace_back(BenchResult_t{name + ".exec_p50", "us", packet.exec_ns.getPercentile(0.5) / 1e3, false});
+        vec_result_.emplace_back(BenchResult_t{name + ".exec_p99", "us", packet.exec_ns.getPercentile(0.99) / 1e3, false});
+    }
+
+    double elapsed_sec = elapsed_ns_ / 1e9;
+    vec_result_.emplace_back(BenchResult_t{"replay.throughput", "stmt/s", (elapsed_sec > 0) ? num_packet_ / elapsed_sec : 0, true});
+    vec_result_.emplace_back(BenchResult_t{"replay.all.exec_p50", "us", total.exec_ns.getPercentile(0.5) / 1e3, false});
+    vec_result_.emplace_back(BenchResult_t{"replay.all.exec_p99", "us", total.exec_ns.getPercentile(0.99) / 1e3, false});
+    vec_result_.emplace_back(BenchResult_t{"replay.all.exec_p999", "us", total.exec_ns.getPercentile(0.999) / 1e3, false});
+    vec_result_.emplace_back(BenchResult_t{"replay.all.wait_p99", "us", total.wait_ns.getPercentile(0.99) / 1e3, false});
+}
+
+void SqlReplay_t::printReport(FILE* p_file) const
+{
+    double elapsed_sec = elapsed_ns_ / 1e9;
+    fprintf(p_file, "Replayed %lu packet(s) from \"%s\" %s in %.3f s, %.1f stmt/s\n", num_packet_, option_.trace_path.c_str(),
+            option_.is_paced ? "at the captured pace" : "as fast as possible", elapsed_sec, (elapsed_sec > 0) ? num_packet_ / elapsed_sec : 0);
+    if (is_trace_broken_) fprintf(p_file, "  the trace ends in a damaged record, the packets before it were replayed\n");
+    for (size_t slot = 0; slot < arr_packet_.size(); slot ++)
+    {
+        auto& packet = arr_packet_[slot];
+        if (packet.num_packet == 0) continue;
+
+        fprintf(p_file, "  %-16s count %lu, failed %lu, rows %lu, exec us p50 %.1f p99 %.1f p99.9 %.1f max %.1f, wait us p50 %.1f p99 %.1f\n",
+                SqlMetricsRegistry_t::getSlotName(slot), packet.num_packet, packet.num_failed, packet.num_row,
+                packet.exec_ns.getPercentile(0.5) / 1e3, packet.exec_ns.getPercentile(0.99) / 1e3, packet.exec_ns.getPercentile(0.999) / 1e3,
+                packet.exec_ns.max_value / 1e3, packet.wait_ns.getPercentile(0.5) / 1e3, packet.wait_ns.getPercentile(0.99) / 1e3);
+    }
+}
+
+} // namespace sql::bench
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "array"
+#include "string"
+#include "vector"
+#include "stdint.h"
+#include "stdio.h"
+
+#include "bench/bench_result.h"
+#include "executor/executor_dispatcher.h"
+#include "trace/sql_trace.h"
+
+namespace sql::bench
+{
+
+struct ReplayOption_t
+{
+    std::string             trace_path;
+    bool                    is_paced = false;     // keep the gaps between the captured packets, as fast as possible otherwise
+    exec::ExecutorOption_t  executor;
+    std::string             span_trace_path;      // no timeline when empty
+    std::string             json_path;            // no JSON when empty
+    std::string             baseline_path;        // compare against it when set
+    double                  threshold_percent = BENCH_DEFAULT_THRESHOLD;
+};
+
+// feeds a captured trace straight into a fresh dispatcher, bypassing the parser
+class SqlReplay_t
+{
+public:
+    explicit SqlReplay_t(const ReplayOption_t& option) : option_(option) {}
+
+    bool open();
+    bool run();
+    void printReport(FILE* p_file) const;
+    inline const std::vector<BenchResult_t>& getResult() const { return vec_result_; }
+
+private:
+    void collectResult();
+
+    ReplayOption_t                                                  option_;
+    trace::SqlTraceReader_t                                         reader_;
+    bool                                                            is_trace_broken_ = false;
+    uint64_t                                                        num_packet_ = 0;
+    uint64_t                                                        elapsed_ns_ = 0;
+    std::array<exec::PacketSnapshot_t, EXEC_METRICS_SHARD_TASK>     arr_packet_;   // the dispatcher slots
+    std::vector<BenchResult_t>                                      vec_result_;
+};
+
+} // namespace sql::bench
@@ -1,9 +1,12 @@
-#pragma once 
+#pragma once
 
 #include "stdint.h"
+#include "atomic"
+#include "utility"
 
 #define LFQ_MAX_SIZE 16
 
+// single producer single consumer ring, the producer owns head_ and the consumer owns tail_
 template <typename T>
 class LockFreeQueue
 {
@@ -15,33 +18,63 @@ public:
         buffer_ = nullptr;
     }
 
-    inline bool isEmpty() const { return head_ == tail_; }
-    inline bool isFull()  const { return head_ == (tail_ + 1) % size_; }
+    inline bool isEmpty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+    inline bool isFull()  const { return tail_.load(std::memory_order_acquire) == (head_.load(std::memory_order_acquire) + 1) % size_; }
 
-    bool push(const T& value)
+    bool push(const T& value) { return pushWith([&](T& slot) { slot = value; }); }
+    // a value that does not fit is left as it is, so a full ring can be retried with the same one
+    bool push(T&& value) { return pushWith([&](T& slot) { slot = std::move(value); }); }
+    bool pop(T& value) { return popWith([&](T& slot) { value = std::move(slot); }); }
+
+    // the slots double as a pool: the consumer leaves its spent value in the slot it takes from,
+    // and the producer gets that value back for the one it puts in, so their buffers go round instead of being freed
+    bool pushSwap(T& value) { return pushWith([&](T& slot) { std::swap(slot, value); }); }
+    bool popSwap(T& value) { return popWith([&](T& slot) { std::swap(slot, value); }); }
+
+    inline uint32_t getSize() const { return size_; }
+    inline uint32_t getHead() const { return head_.load(std::memory_order_acquire); }
+    inline uint32_t getTail() const { return tail_.load(std::memory_order_acquire); }
+    inline uint32_t getOccupancy() const { return (getHead() + size_ - getTail()) % size_; }
+    inline uint32_t getHighWaterMark() const { return high_water_mark_.load(std::memory_order_relaxed); }
+    inline uint64_t getFullCount() const { return num_full_.load(std::memory_order_relaxed); }
+
+private:
+    template <typename Store>
+    bool pushWith(Store&& store)
     {
-        if (isFull()) return false;
-        buffer_[head_] = value;
-        head_ = (head_ + 1) % size_;
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        uint32_t tail = tail_.load(std::memory_order_acquire);
+        if (tail == (head + 1) % size_)
+        {
+            num_full_.store(num_full_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        store(buffer_[head]);
+        head_.store((head + 1) % size_, std::memory_order_release);
+
+        // only the producer writes these, a plain load and store is enough
+        uint32_t occupancy = (head + 1 + size_ - tail) % size_;
+        if (occupancy > high_water_mark_.load(std::memory_order_relaxed)) high_water_mark_.store(occupancy, std::memory_order_relaxed);
         return true;
     }
 
-    bool pop(T& value)
+    template <typename Take>
+    bool popWith(Take&& take)
     {
-        if (isEmpty()) return false;
-        value = buffer_[tail_];
-        tail_ = (tail_ + 1) % size_;
+        uint32_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return false;
+        take(buffer_[tail]);
+        tail_.store((tail + 1) % size_, std::memory_order_release);
         return true;
     }
 
-    inline uint32_t getSize() const { return size_; }
-    inline uint32_t getHead() const { return head_; }
-    inline uint32_t getTail() const { return tail_; }
+    uint32_t                           size_;
+    T*                                 buffer_;
+    alignas(64) std::atomic<uint32_t>  head_ = 0;   // own cache lines, producer and consumer do not bounce one line
+    alignas(64) std::atomic<uint32_t>  tail_ = 0;
 
-private:
-    uint32_t size_;
-    uint32_t head_ = 0;
-    uint32_t tail_ = 0;
-    T*       buffer_;
+    // written by the producer only, on a line of their own so reading them never stalls the consumer
+    alignas(64) std::atomic<uint32_t>  high_water_mark_ = 0;
+    std::atomic<uint64_t>              num_full_ = 0;
 
-};
\ No newline at end of file
+};
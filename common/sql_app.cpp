@@ -2,14 +2,15 @@
 
 #include "common/sql_app.h"
 #include "common/sql_app_util.h"
+#include "trace/sql_span.h"
 #include "3rd/cpp-linenoise/linenoise.hpp"
 
 namespace sql
 {
 
-bool SqlApp::init()
+bool SqlApp::init(const exec::ExecutorOption_t& option, const std::string& capture_path)
 {
-    sp_lfq_ = std::make_shared<LockFreeQueue<PacketCollection_t>>(LFQ_MAX_SIZE);
+    sp_lfq_ = std::make_shared<LockFreeQueue<PacketEnvelope_t>>(LFQ_MAX_SIZE);
     sp_is_running_ = std::make_shared<bool>(true);
 
     if (!parser_.init(sp_lfq_, sp_is_running_))
@@ -18,7 +19,13 @@ bool SqlApp::init()
         return false;
     }
 
-    if (!executor_.init(sp_lfq_))
+    if (!capture_path.empty() && !parser_.startCapture(capture_path))
+    {
+        printf("Capture initialization failed\n");
+        return false;
+    }
+
+    if (!executor_.init(sp_lfq_, option))
     {
         printf("Executor initialization failed\n");
         return false;
@@ -33,6 +40,7 @@ void SqlApp::runApp()
 {
     if (*sp_is_running_)
     {
+        trace::SqlSpanTracer_t::getInstance().nameThread("shell");
         const auto history_path = "linenoiseHistory.txt";
         linenoise::LoadHistory(history_path);
 
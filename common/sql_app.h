@@ -15,7 +15,7 @@ class SqlApp
 {
 public:
 
-    bool init();
+    bool init(const exec::ExecutorOption_t& option, const std::string& capture_path);
     void runApp();
 
 private:
@@ -27,7 +27,7 @@ private:
     // components
     fsm::FsmParser               parser_;
     exec::SqlExecutorDispatcher  executor_;
-    std::shared_ptr<LockFreeQueue<PacketCollection_t>>  sp_lfq_;
+    std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>  sp_lfq_;
 };
 
 } // namespace sql
@@ -1,10 +1,13 @@
 #include "common/sql_app_util.h"
+#include "trace/sql_span.h"
 
 namespace sql
 {
 
 size_t splitArgument(std::string& line, std::vector<std::string>& params)
 {
+    trace::SpanGuard_t span("tokenize", "shell");
+
     std::string word;
     size_t index = 0;
     for (; index < line.size(); index ++)
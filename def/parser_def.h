@@ -29,6 +29,10 @@ enum class EnumParserState
     CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_END,
     CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_PRIMARY,
     CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_PRIMARY_END,
+    CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM,
+    CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM_END,
+    CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX,
+    CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX_END,
 
     DROP,
     DROP_DATABASE,
@@ -51,19 +55,65 @@ enum class EnumParserState
     SELECT_COLUMNNAME_FROM_TBNAME_WHERE,
     SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND,
     SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_END,
+    SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_LIKE,
+    SELECT_ORDER,
+    SELECT_ORDER_BY,
+    SELECT_ORDER_BY_COLUMNNAME,
+    SELECT_ORDER_BY_COLUMNNAME_END,
+    SELECT_ORDER_BY_COLUMNNAME_DIRECTION,
+    SELECT_ORDER_BY_COLUMNNAME_DIRECTION_END,
+    SELECT_LIMIT,
+    SELECT_LIMIT_NUM,
+    SELECT_LIMIT_NUM_END,
+    SELECT_LIMIT_NUM_OFFSET,
+    SELECT_LIMIT_NUM_OFFSET_NUM,
+    SELECT_LIMIT_NUM_OFFSET_NUM_END,
+    SELECT_GROUP,
+    SELECT_GROUP_BY,
+    SELECT_GROUP_BY_COLUMNNAME,
+    SELECT_GROUP_BY_COLUMNNAME_END,
+    SELECT_JOIN,
+    SELECT_JOIN_TBNAME,
+    SELECT_JOIN_TBNAME_ON,
+    SELECT_JOIN_TBNAME_ON_COND,
+    SELECT_JOIN_TBNAME_ON_COND_END,
+    SELECT_JOIN_TBNAME_ON_COND_WHERE,
+    SELECT_JOIN_TBNAME_ON_COND_WHERE_COND,
+    SELECT_JOIN_TBNAME_ON_COND_WHERE_COND_END,
+    SELECT_JOIN_TBNAME_ON_COND_WHERE_COND_LIKE,
     
     DELETE,
     DELETE_TBNAME,
     DELETE_TBNAME_WHERE,
     DELETE_TBNAME_WHERE_COND,
     DELETE_TBNAME_WHERE_COND_END,
+    DELETE_TBNAME_WHERE_COND_LIKE,
     
+    UPDATE,
+    UPDATE_TBNAME,
+    UPDATE_TBNAME_SET,
+    UPDATE_TBNAME_SET_ASSIGN,
+    UPDATE_TBNAME_SET_ASSIGN_WHERE,
+    UPDATE_TBNAME_SET_ASSIGN_WHERE_COND,
+    UPDATE_TBNAME_SET_ASSIGN_WHERE_COND_END,
+    UPDATE_TBNAME_SET_ASSIGN_WHERE_COND_LIKE,
+
     INSERT,
     INSERT_TBNAME,
     INSERT_TBNAME_VALUES,
     INSERT_TBNAME_VALUES_VALUENAME,
     INSERT_TBNAME_VALUES_VALUENAME_END,
 
+    TRANSACTION,
+    TRANSACTION_END,
+
+    EXPLAIN,
+    EXPLAIN_ANALYZE,
+
+    SHOW,
+    SHOW_TARGET,
+    SHOW_TARGET_END,
+
     LOCAL_EXIT,
     LOCAL_EXIT_END,
 };
@@ -79,13 +129,31 @@ enum class EnumParserParamType
     KW_USE,
     KW_TABLE,
     KW_PRIMARY,
+    KW_BLOOM,
+    KW_INDEX,
     KW_SELECT,
     KW_FROM,
     KW_WHERE,
+    KW_LIKE,
     KW_DELETE,
     KW_INSERT,
+    KW_UPDATE,
+    KW_SET,
     KW_VALUES,
     KW_VALTYPE,
+    KW_ORDER,
+    KW_BY,
+    KW_DIRECTION,
+    KW_LIMIT,
+    KW_OFFSET,
+    KW_GROUP,
+    KW_JOIN,
+    KW_ON,
+    KW_TRANSACTION,
+    KW_EXPLAIN,
+    KW_ANALYZE,
+    KW_SHOW,
+    KW_SHOW_TARGET,
 
     LOCAL_EXIT,
 
@@ -100,6 +168,9 @@ enum class EnumParserErrorIndication
     DUPLICATE_CARRIER,
     INCOMPLETE_COMMAND,
     INVALID_CONDITION,
+    INVALID_NUMBER,
+    INVALID_PROJECTION,
+    INVALID_ASSIGNMENT,
 };
 
 struct TransitionKey_t
@@ -5,17 +5,23 @@
 #include "stdint.h"
 #include "variant"
 #include "optional"
+#include "chrono"
 
 namespace sql
 {
 
-using SqlValue_t = std::variant<std::monostate, int32_t, std::string>;
+// new alternatives go at the end, traces store the alternative index
+// BIGINT and TIMESTAMP (microseconds since the epoch, UTC) both hold int64_t
+using SqlValue_t = std::variant<std::monostate, int32_t, std::string, int64_t, double>;
 
 enum class EnumValueType
 {
     VALUE_TYPE_IDLE      = 0,
     VALUE_TYPE_INT,
     VALUE_TYPE_STRING,
+    VALUE_TYPE_BIGINT,
+    VALUE_TYPE_DOUBLE,
+    VALUE_TYPE_TIMESTAMP,
 };
 
 struct TableColumnProperty_t
@@ -23,6 +29,8 @@ struct TableColumnProperty_t
     std::string    column_name;
     EnumValueType  value_type;
     bool           is_primary = false;
+    bool           is_bloom = false;     // keep per-block bloom filters for equality probes
+    bool           is_indexed = false;   // keep a radix tree index of a STRING column for equality and prefix lookups
 };
 
 struct PacketCreateDatabase_t
@@ -59,6 +67,7 @@ enum class EnumConditionActionType
     EQ,
     GTEQ,
     GT,
+    LIKE,      // the value starts with the anchor
 };
 
 struct ConditionDescriptor_t
@@ -68,17 +77,87 @@ struct ConditionDescriptor_t
     SqlValue_t                  anchor_val;
 };
 
-struct PacketSelect_t
+enum class EnumOrderDirection
+{
+    IDLE      = 0,
+    ASC,
+    DESC,
+};
+
+struct OrderDescriptor_t
 {
-    std::string                 table_name;
     std::string                 column_name;
-    ConditionDescriptor_t       condition;
+    EnumOrderDirection          direction = EnumOrderDirection::IDLE;
+};
+
+struct LimitDescriptor_t
+{
+    bool                        is_limited = false;
+    uint32_t                    count      = 0;
+    uint32_t                    offset     = 0;
+};
+
+struct JoinDescriptor_t
+{
+    std::string                 table_name;
+    std::string                 lhs_column_name;    // either side of "ON a.x = b.y", may be qualified by table name
+    std::string                 rhs_column_name;
+};
+
+enum class EnumAggregateType
+{
+    IDLE      = 0,
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+    AVG,
+};
+
+struct ProjectionDescriptor_t
+{
+    std::string                 column_name;        // "*" stands for every column, or for every row in COUNT(*)
+    EnumAggregateType           aggregate = EnumAggregateType::IDLE;
+};
+
+enum class EnumExplainType
+{
+    IDLE      = 0,
+    PLAN,                   // EXPLAIN, print the plan without running it
+    ANALYZE,                // EXPLAIN ANALYZE, run it and print what every stage did
+};
+
+struct PacketSelect_t
+{
+    std::string                         table_name;
+    std::vector<ProjectionDescriptor_t> vec_projection;
+    JoinDescriptor_t                    join;
+    ConditionDescriptor_t               condition;
+    std::string                         group_column_name;
+    OrderDescriptor_t                   order;
+    LimitDescriptor_t                   limit;
+    EnumExplainType                     explain = EnumExplainType::IDLE;
 };
 
 struct PacketDelect_t
 {
     std::string                 table_name;
     ConditionDescriptor_t       condition;
+    EnumExplainType             explain = EnumExplainType::IDLE;
+};
+
+struct AssignmentDescriptor_t
+{
+    std::string                 column_name;
+    std::string                 value;              // raw text, cast to the column type by the executor
+};
+
+struct PacketUpdate_t
+{
+    std::string                          table_name;
+    std::vector<AssignmentDescriptor_t>  vec_assignment;
+    ConditionDescriptor_t                condition;
+    EnumExplainType                      explain = EnumExplainType::IDLE;
 };
 
 struct PacketInsert_t
@@ -87,6 +166,31 @@ struct PacketInsert_t
     std::vector<std::string>      vec_value;
 };
 
+enum class EnumTransactionActionType
+{
+    IDLE      = 0,
+    BEGIN,
+    COMMIT,
+    ROLLBACK,
+};
+
+struct PacketTransaction_t
+{
+    EnumTransactionActionType  action;
+};
+
+enum class EnumShowTargetType
+{
+    IDLE      = 0,
+    STATS,
+    MEMORY,
+};
+
+struct PacketShow_t
+{
+    EnumShowTargetType  target;
+};
+
 using PacketCollection_t = std::variant<std::monostate,
                                         PacketCreateDatabase_t, 
                                         PacketDropDatabase_t, 
@@ -95,7 +199,22 @@ using PacketCollection_t = std::variant<std::monostate,
                                         PacketDropTable_t, 
                                         PacketSelect_t, 
                                         PacketDelect_t, 
-                                        PacketInsert_t>;
+                                        PacketInsert_t, 
+                                        PacketTransaction_t,
+                                        PacketShow_t,
+                                        PacketUpdate_t>;
+
+inline uint64_t getSteadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// what the parser hands to the executor, stamped when it is queued so the executor can tell how long it waited
+struct PacketEnvelope_t
+{
+    PacketCollection_t          packet;
+    uint64_t                    enqueue_ns = 0;
+};
 
 
 } // namespace sql
@@ -0,0 +1,195 @@
+#include "executor/executor_aggregate.h"
+#include "executor/executor_hash.h"
+#include "executor/executor_sql.h"
+
+#include "thread"
+#include "algorithm"
+
+namespace sql::exec
+{
+
+SqlGroupTable_t::SqlGroupTable_t(size_t num_aggregate)
+    : num_aggregate_(num_aggregate), vec_slot_(EXEC_AGGREGATE_INIT_SLOT, 0), slot_mask_(EXEC_AGGREGATE_INIT_SLOT - 1)
+{
+}
+
+uint32_t SqlGroupTable_t::findOrInsert(const SqlValue_t& key, uint64_t hash)
+{
+    for (uint64_t slot = hash & slot_mask_; ; slot = (slot + 1) & slot_mask_)
+    {
+        auto group = vec_slot_[slot];
+        if (group == 0)
+        {
+            group = static_cast<uint32_t>(vec_key_.size());
+            vec_slot_[slot] = group + 1;
+            vec_key_.emplace_back(key);
+            vec_hash_.emplace_back(hash);
+            vec_state_.resize(vec_state_.size() + num_aggregate_);
+
+            // keep the load factor at or below one half
+            if (vec_key_.size() * 2 > vec_slot_.size()) grow();
+            return group;
+        }
+
+        if (vec_hash_[group - 1] == hash && vec_key_[group - 1] == key) return group - 1;
+    }
+}
+
+void SqlGroupTable_t::grow()
+{
+    vec_slot_.assign(vec_slot_.size() * 2, 0);
+    slot_mask_ = vec_slot_.size() - 1;
+    for (uint32_t group = 0; group < vec_hash_.size(); group ++)
+    {
+        auto slot = vec_hash_[group] & slot_mask_;
+        while (vec_slot_[slot] != 0) slot = (slot + 1) & slot_mask_;
+        vec_slot_[slot] = group + 1;
+    }
+}
+
+SqlHashAggregate_t::SqlHashAggregate_t(const SqlColumn_t* p_group_column, const std::vector<AggregateColumn_t>& vec_aggregate_column)
+    : p_group_column_(p_group_column), vec_aggregate_column_(vec_aggregate_column)
+{
+}
+
+void SqlHashAggregate_t::aggregate(uint32_t num_row, const RowFilter_t& row_filter, uint32_t max_worker)
+{
+    auto num_hardware = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+    num_worker_ = std::clamp<uint32_t>(num_row / EXEC_AGGREGATE_ROW_PER_WORKER, 1, std::max<uint32_t>(std::min<uint32_t>({num_hardware, max_worker, EXEC_AGGREGATE_MAX_WORKER}), 1));
+    vec_result_.clear();
+
+    if (num_worker_ == 1)
+    {
+        vec_result_.emplace_back(vec_aggregate_column_.size());
+        aggregateRange(vec_result_[0], 0, num_row, row_filter);
+        return;
+    }
+
+    // phase 1: thread-local pre-aggregation over contiguous row ranges
+    std::vector<SqlGroupTable_t> vec_local(num_worker_, SqlGroupTable_t{vec_aggregate_column_.size()});
+    std::vector<std::thread> vec_worker;
+    uint32_t row_per_worker = (num_row + num_worker_ - 1) / num_worker_;
+    for (uint32_t worker = 0; worker < num_worker_; worker ++)
+    {
+        uint32_t row_begin = std::min<uint32_t>(worker * row_per_worker, num_row);
+        uint32_t row_end = std::min<uint32_t>(row_begin + row_per_worker, num_row);
+        vec_worker.emplace_back([this, &vec_local, worker, row_begin, row_end, &row_filter]()
+        {
+            aggregateRange(vec_local[worker], row_begin, row_end, row_filter);
+        });
+    }
+    for (auto& th_worker : vec_worker) th_worker.join();
+    vec_worker.clear();
+
+    // phase 2: every worker owns the groups of one hash partition and merges them from all local tables
+    vec_result_.assign(num_worker_, SqlGroupTable_t{vec_aggregate_column_.size()});
+    for (uint32_t partition = 0; partition < num_worker_; partition ++)
+    {
+        vec_worker.emplace_back([this, &vec_local, partition]()
+        {
+            auto& result = vec_result_[partition];
+            for (auto& local : vec_local)
+            {
+                for (uint32_t group = 0; group < local.getGroupNum(); group ++)
+                {
+                    if ((local.getHash(group) >> 32) % num_worker_ != partition) continue;
+
+                    auto merged_group = result.findOrInsert(local.getKey(group), local.getHash(group));
+                    mergeAggregateState(vec_aggregate_column_, result.getState(merged_group), local.getState(group));
+                }
+            }
+        });
+    }
+    for (auto& th_worker : vec_worker) th_worker.join();
+}
+
+void SqlHashAggregate_t::aggregateRange(SqlGroupTable_t& group_table, uint32_t row_begin, uint32_t row_end, const RowFilter_t& row_filter)
+{
+    static const SqlValue_t no_group_key = SqlValue_t{};
+    SqlValue_t decoded_key, decoded_value;
+    std::vector<std::vector<int64_t>> vec_batch_sum(vec_aggregate_column_.size());
+    std::vector<std::vector<double>> vec_batch_real(vec_aggregate_column_.size());
+
+    std::vector<uint32_t> vec_selection;
+    vec_selection.reserve(EXEC_SCAN_BATCH_SIZE);
+    for (uint32_t batch_begin = row_begin; batch_begin < row_end; batch_begin += EXEC_SCAN_BATCH_SIZE)
+    {
+        vec_selection.clear();
+        row_filter(batch_begin, std::min<uint32_t>(row_end, batch_begin + EXEC_SCAN_BATCH_SIZE), vec_selection);
+
+        // the inputs of SUM and AVG are decoded a batch at a time
+        for (size_t index = 0; index < vec_aggregate_column_.size(); index ++)
+        {
+            auto& aggregate_column = vec_aggregate_column_[index];
+            bool is_sum = (aggregate_column.aggregate == EnumAggregateType::SUM || aggregate_column.aggregate == EnumAggregateType::AVG);
+            if (!is_sum || aggregate_column.p_column == nullptr) continue;
+            if (aggregate_column.is_real) aggregate_column.p_column->getRealBatch(vec_selection, vec_batch_real[index]);
+            else aggregate_column.p_column->getIntBatch(vec_selection, vec_batch_sum[index]);
+        }
+
+        for (size_t position = 0; position < vec_selection.size(); position ++)
+        {
+            auto row_index = vec_selection[position];
+            auto& key = (p_group_column_ == nullptr) ? no_group_key : p_group_column_->getValue(row_index, decoded_key);
+            auto p_state = group_table.getState(group_table.findOrInsert(key, hashValue(key)));
+
+            for (size_t index = 0; index < vec_aggregate_column_.size(); index ++)
+            {
+                auto& aggregate_column = vec_aggregate_column_[index];
+                auto& state = p_state[index];
+                state.count ++;
+                if (aggregate_column.p_column == nullptr) continue;
+
+                switch (aggregate_column.aggregate)
+                {
+                    case EnumAggregateType::SUM:
+                    case EnumAggregateType::AVG:
+                        if (aggregate_column.is_real) state.sum_real += vec_batch_real[index][position];
+                        else state.sum += vec_batch_sum[index][position];
+                        break;
+                    case EnumAggregateType::MIN:
+                    {
+                        auto& value = aggregate_column.p_column->getValue(row_index, decoded_value);
+                        if (state.count == 1 || value < state.extreme) state.extreme = value;
+                        break;
+                    }
+                    case EnumAggregateType::MAX:
+                    {
+                        auto& value = aggregate_column.p_column->getValue(row_index, decoded_value);
+                        if (state.count == 1 || state.extreme < value) state.extreme = value;
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+    }
+}
+
+void mergeAggregateState(const std::vector<AggregateColumn_t>& vec_aggregate_column, AggregateState_t* p_state, const AggregateState_t* p_other_state)
+{
+    for (size_t index = 0; index < vec_aggregate_column.size(); index ++)
+    {
+        auto& state = p_state[index];
+        auto& other_state = p_other_state[index];
+        if (other_state.count == 0) continue;
+
+        switch (vec_aggregate_column[index].aggregate)
+        {
+            case EnumAggregateType::MIN:
+                if (state.count == 0 || other_state.extreme < state.extreme) state.extreme = other_state.extreme;
+                break;
+            case EnumAggregateType::MAX:
+                if (state.count == 0 || state.extreme < other_state.extreme) state.extreme = other_state.extreme;
+                break;
+            default:
+                break;
+        }
+        state.count += other_state.count;
+        state.sum += other_state.sum;
+        state.sum_real += other_state.sum_real;
+    }
+}
+
+} // namespace sql::exec
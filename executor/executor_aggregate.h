@@ -0,0 +1,82 @@
+#pragma once
+
+#include "vector"
+#include "functional"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_block.h"
+
+#define EXEC_AGGREGATE_MAX_WORKER       8
+#define EXEC_AGGREGATE_ROW_PER_WORKER   (64 * 1024)   // smaller inputs are not worth a thread
+#define EXEC_AGGREGATE_INIT_SLOT        64
+
+namespace sql::exec
+{
+
+struct AggregateState_t
+{
+    int64_t     count   = 0;
+    int64_t     sum     = 0;
+    double      sum_real = 0;     // SUM/AVG of a DOUBLE column
+    SqlValue_t  extreme;          // running MIN/MAX, monostate until the first value
+};
+
+struct AggregateColumn_t
+{
+    EnumAggregateType   aggregate;
+    const SqlColumn_t*  p_column;    // nullptr for COUNT(*)
+    bool                is_real = false;   // a DOUBLE input, SUM and AVG add into sum_real
+};
+
+// folds the states of one group into another, both laid out like vec_aggregate_column
+void mergeAggregateState(const std::vector<AggregateColumn_t>& vec_aggregate_column, AggregateState_t* p_state, const AggregateState_t* p_other_state);
+
+// open addressing table of groups, keys and states are kept dense so small group counts stay in L1/L2
+class SqlGroupTable_t
+{
+public:
+    explicit SqlGroupTable_t(size_t num_aggregate);
+
+    uint32_t findOrInsert(const SqlValue_t& key, uint64_t hash);
+
+    inline size_t getGroupNum() const { return vec_key_.size(); }
+    inline const SqlValue_t& getKey(uint32_t group) const { return vec_key_[group]; }
+    inline uint64_t getHash(uint32_t group) const { return vec_hash_[group]; }
+    inline AggregateState_t* getState(uint32_t group) { return &vec_state_[group * num_aggregate_]; }
+    inline const AggregateState_t* getState(uint32_t group) const { return &vec_state_[group * num_aggregate_]; }
+
+private:
+    void grow();
+
+    size_t                         num_aggregate_;
+    std::vector<uint32_t>          vec_slot_;      // group index + 1, 0 marks an empty slot
+    uint64_t                       slot_mask_;
+    std::vector<SqlValue_t>        vec_key_;
+    std::vector<uint64_t>          vec_hash_;
+    std::vector<AggregateState_t>  vec_state_;
+};
+
+// parallel hash aggregation: workers pre-aggregate a row range each, then merge one hash partition each
+class SqlHashAggregate_t
+{
+public:
+    using RowFilter_t = std::function<void(uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)>;
+
+    SqlHashAggregate_t(const SqlColumn_t* p_group_column, const std::vector<AggregateColumn_t>& vec_aggregate_column);
+
+    void aggregate(uint32_t num_row, const RowFilter_t& row_filter, uint32_t max_worker = EXEC_AGGREGATE_MAX_WORKER);
+
+    inline const std::vector<SqlGroupTable_t>& getResult() const { return vec_result_; }
+    inline std::vector<SqlGroupTable_t> releaseResult() { return std::move(vec_result_); }
+    inline uint32_t getWorkerNum() const { return num_worker_; }
+
+private:
+    void aggregateRange(SqlGroupTable_t& group_table, uint32_t row_begin, uint32_t row_end, const RowFilter_t& row_filter);
+
+    const SqlColumn_t*              p_group_column_;
+    std::vector<AggregateColumn_t>  vec_aggregate_column_;
+    uint32_t                        num_worker_ = 1;
+    std::vector<SqlGroupTable_t>    vec_result_;   // one table per partition, partitions hold disjoint groups
+};
+
+} // namespace sql::exec
@@ -0,0 +1,437 @@
+#include "executor/executor_art.h"
+
+#include "algorithm"
+
+namespace sql::exec
+{
+
+// length of the common start of two byte strings
+static inline size_t getCommonLength(std::string_view lhs, std::string_view rhs)
+{
+    return std::mismatch(lhs.begin(), lhs.begin() + std::min(lhs.size(), rhs.size()), rhs.begin()).first - lhs.begin();
+}
+
+SqlArtIndex_t::Range_t SqlArtIndex_t::addBytes(std::string_view bytes)
+{
+    Range_t range{static_cast<uint32_t>(vec_arena_.size()), static_cast<uint32_t>(bytes.size())};
+    vec_arena_.insert(vec_arena_.end(), bytes.begin(), bytes.end());
+    return range;
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::newLeaf(std::string_view suffix, uint32_t row)
+{
+    vec_leaf_.emplace_back(Leaf_t{addBytes(suffix), row});
+    return makeRef(EnumArtNodeKind::LEAF, static_cast<uint32_t>(vec_leaf_.size() - 1));
+}
+
+void SqlArtIndex_t::addRow(NodeRef_t leaf_ref, uint32_t row)
+{
+    auto& leaf = vec_leaf_[getSlot(leaf_ref)];
+    if (leaf.first_row == EXEC_ART_NONE)
+    {
+        leaf.first_row = row;
+        return;
+    }
+
+    if (leaf.more_row == EXEC_ART_NONE)
+    {
+        leaf.more_row = static_cast<uint32_t>(vec_more_row_.size());
+        vec_more_row_.emplace_back();
+    }
+
+    auto& vec_row = vec_more_row_[leaf.more_row];
+    num_more_row_byte_ -= vec_row.capacity() * sizeof(uint32_t);
+    vec_row.emplace_back(row);
+    num_more_row_byte_ += vec_row.capacity() * sizeof(uint32_t);
+}
+
+template <typename Node>
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::allocate(std::vector<Node>& vec_node, EnumArtNodeKind kind)
+{
+    auto& vec_free_slot = arr_free_slot_[static_cast<size_t>(kind)];
+    if (vec_free_slot.empty())
+    {
+        vec_node.emplace_back();
+        return makeRef(kind, static_cast<uint32_t>(vec_node.size() - 1));
+    }
+
+    uint32_t slot = vec_free_slot.back();
+    vec_free_slot.pop_back();
+    vec_node[slot] = Node{};
+    return makeRef(kind, slot);
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::newNode4(Range_t prefix)
+{
+    auto ref = allocate(vec_node4_, EnumArtNodeKind::NODE4);
+    vec_node4_[getSlot(ref)].header.prefix = prefix;
+    return ref;
+}
+
+SqlArtIndex_t::Header_t& SqlArtIndex_t::getHeader(NodeRef_t ref)
+{
+    return const_cast<Header_t&>(static_cast<const SqlArtIndex_t*>(this)->getHeader(ref));
+}
+
+const SqlArtIndex_t::Header_t& SqlArtIndex_t::getHeader(NodeRef_t ref) const
+{
+    switch (getKind(ref))
+    {
+        case EnumArtNodeKind::NODE4:  return vec_node4_[getSlot(ref)].header;
+        case EnumArtNodeKind::NODE16: return vec_node16_[getSlot(ref)].header;
+        case EnumArtNodeKind::NODE48: return vec_node48_[getSlot(ref)].header;
+        default:                      return vec_node256_[getSlot(ref)].header;
+    }
+}
+
+const SqlArtIndex_t::NodeRef_t* SqlArtIndex_t::findChild(NodeRef_t ref, uint8_t key_byte) const
+{
+    switch (getKind(ref))
+    {
+        case EnumArtNodeKind::NODE4:
+        {
+            auto& node = vec_node4_[getSlot(ref)];
+            for (uint16_t index = 0; index < node.header.num_child; index ++)
+            {
+                if (node.arr_key[index] == key_byte) return &node.arr_child[index];
+            }
+            return nullptr;
+        }
+        case EnumArtNodeKind::NODE16:
+        {
+            auto& node = vec_node16_[getSlot(ref)];
+            for (uint16_t index = 0; index < node.header.num_child; index ++)
+            {
+                if (node.arr_key[index] == key_byte) return &node.arr_child[index];
+            }
+            return nullptr;
+        }
+        case EnumArtNodeKind::NODE48:
+        {
+            auto& node = vec_node48_[getSlot(ref)];
+            return (node.arr_slot[key_byte] == 0) ? nullptr : &node.arr_child[node.arr_slot[key_byte] - 1];
+        }
+        case EnumArtNodeKind::NODE256:
+        {
+            auto& node = vec_node256_[getSlot(ref)];
+            return (node.arr_child[key_byte] == EXEC_ART_NONE) ? nullptr : &node.arr_child[key_byte];
+        }
+        default:
+            return nullptr;
+    }
+}
+
+SqlArtIndex_t::NodeRef_t* SqlArtIndex_t::findChild(NodeRef_t ref, uint8_t key_byte)
+{
+    return const_cast<NodeRef_t*>(static_cast<const SqlArtIndex_t*>(this)->findChild(ref, key_byte));
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::addChild(NodeRef_t ref, uint8_t key_byte, NodeRef_t child)
+{
+    switch (getKind(ref))
+    {
+        case EnumArtNodeKind::NODE4:
+        {
+            auto& node = vec_node4_[getSlot(ref)];
+            if (node.header.num_child < 4)
+            {
+                node.arr_key[node.header.num_child] = key_byte;
+                node.arr_child[node.header.num_child ++] = child;
+                return ref;
+            }
+
+            auto grown_ref = allocate(vec_node16_, EnumArtNodeKind::NODE16);
+            auto& old_node = vec_node4_[getSlot(ref)];
+            auto& grown_node = vec_node16_[getSlot(grown_ref)];
+            grown_node.header = old_node.header;
+            std::copy(old_node.arr_key, old_node.arr_key + 4, grown_node.arr_key);
+            std::copy(old_node.arr_child, old_node.arr_child + 4, grown_node.arr_child);
+            arr_free_slot_[static_cast<size_t>(EnumArtNodeKind::NODE4)].emplace_back(getSlot(ref));
+            return addChild(grown_ref, key_byte, child);
+        }
+        case EnumArtNodeKind::NODE16:
+        {
+            auto& node = vec_node16_[getSlot(ref)];
+            if (node.header.num_child < 16)
+            {
+                node.arr_key[node.header.num_child] = key_byte;
+                node.arr_child[node.header.num_child ++] = child;
+                return ref;
+            }
+
+            auto grown_ref = allocate(vec_node48_, EnumArtNodeKind::NODE48);
+            auto& old_node = vec_node16_[getSlot(ref)];
+            auto& grown_node = vec_node48_[getSlot(grown_ref)];
+            grown_node.header = old_node.header;
+            for (uint8_t index = 0; index < 16; index ++)
+            {
+                grown_node.arr_slot[old_node.arr_key[index]] = index + 1;
+                grown_node.arr_child[index] = old_node.arr_child[index];
+            }
+            arr_free_slot_[static_cast<size_t>(EnumArtNodeKind::NODE16)].emplace_back(getSlot(ref));
+            return addChild(grown_ref, key_byte, child);
+        }
+        case EnumArtNodeKind::NODE48:
+        {
+            // keys are never removed, so the used child slots are the first num_child ones
+            auto& node = vec_node48_[getSlot(ref)];
+            if (node.header.num_child < 48)
+            {
+                node.arr_child[node.header.num_child] = child;
+                node.arr_slot[key_byte] = static_cast<uint8_t>(++ node.header.num_child);
+                return ref;
+            }
+
+            auto grown_ref = allocate(vec_node256_, EnumArtNodeKind::NODE256);
+            auto& old_node = vec_node48_[getSlot(ref)];
+            auto& grown_node = vec_node256_[getSlot(grown_ref)];
+            grown_node.header = old_node.header;
+            std::fill(grown_node.arr_child, grown_node.arr_child + 256, EXEC_ART_NONE);
+            for (uint32_t byte = 0; byte < 256; byte ++)
+            {
+                if (old_node.arr_slot[byte] != 0) grown_node.arr_child[byte] = old_node.arr_child[old_node.arr_slot[byte] - 1];
+            }
+            arr_free_slot_[static_cast<size_t>(EnumArtNodeKind::NODE48)].emplace_back(getSlot(ref));
+            return addChild(grown_ref, key_byte, child);
+        }
+        default:
+        {
+            auto& node = vec_node256_[getSlot(ref)];
+            node.arr_child[key_byte] = child;
+            node.header.num_child ++;
+            return ref;
+        }
+    }
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::attachKey(NodeRef_t ref, std::string_view rest, size_t depth, uint32_t row)
+{
+    if (depth == rest.size())
+    {
+        auto leaf_ref = newLeaf(std::string_view(), row);
+        getHeader(ref).leaf = leaf_ref;
+        return ref;
+    }
+
+    auto leaf_ref = newLeaf(rest.substr(depth + 1), row);
+    return addChild(ref, static_cast<uint8_t>(rest[depth]), leaf_ref);
+}
+
+void SqlArtIndex_t::insert(std::string_view key, uint32_t row)
+{
+    root_ = insertAt(root_, key, 0, row);
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::insertAt(NodeRef_t ref, std::string_view key, size_t depth, uint32_t row)
+{
+    auto rest = key.substr(depth);
+    if (ref == EXEC_ART_NONE) return newLeaf(rest, row);
+
+    // a leaf of another key turns into a node branching where the two keys part
+    if (getKind(ref) == EnumArtNodeKind::LEAF)
+    {
+        auto suffix = vec_leaf_[getSlot(ref)].suffix;
+        auto common = getCommonLength(getBytes(suffix), rest);
+        if (common == suffix.length && common == rest.size())
+        {
+            addRow(ref, row);
+            return ref;
+        }
+
+        auto node_ref = newNode4(Range_t{suffix.offset, static_cast<uint32_t>(common)});
+        auto& leaf = vec_leaf_[getSlot(ref)];
+        if (common == suffix.length)
+        {
+            leaf.suffix = Range_t{suffix.offset + suffix.length, 0};
+            getHeader(node_ref).leaf = ref;
+        }
+        else
+        {
+            uint8_t leaf_byte = static_cast<uint8_t>(vec_arena_[suffix.offset + common]);
+            leaf.suffix = Range_t{static_cast<uint32_t>(suffix.offset + common + 1), static_cast<uint32_t>(suffix.length - common - 1)};
+            node_ref = addChild(node_ref, leaf_byte, ref);
+        }
+        return attachKey(node_ref, rest, common, row);
+    }
+
+    // a key leaving the prefix of the node splits it there
+    auto prefix = getHeader(ref).prefix;
+    auto common = getCommonLength(getBytes(prefix), rest);
+    if (common < prefix.length)
+    {
+        auto node_ref = newNode4(Range_t{prefix.offset, static_cast<uint32_t>(common)});
+        uint8_t node_byte = static_cast<uint8_t>(vec_arena_[prefix.offset + common]);
+        getHeader(ref).prefix = Range_t{static_cast<uint32_t>(prefix.offset + common + 1), static_cast<uint32_t>(prefix.length - common - 1)};
+        node_ref = addChild(node_ref, node_byte, ref);
+        return attachKey(node_ref, rest, common, row);
+    }
+
+    depth += prefix.length;
+    if (depth == key.size())
+    {
+        auto leaf_ref = getHeader(ref).leaf;
+        if (leaf_ref == EXEC_ART_NONE) return attachKey(ref, rest, prefix.length, row);
+        addRow(leaf_ref, row);
+        return ref;
+    }
+
+    // the pools may move while the child grows, so its slot is looked up again afterwards
+    uint8_t key_byte = static_cast<uint8_t>(key[depth]);
+    auto p_child = findChild(ref, key_byte);
+    if (p_child == nullptr) return attachKey(ref, rest, prefix.length, row);
+
+    auto child_ref = insertAt(*p_child, key, depth + 1, row);
+    *findChild(ref, key_byte) = child_ref;
+    return ref;
+}
+
+void SqlArtIndex_t::collectLeaf(NodeRef_t leaf_ref, std::vector<uint32_t>& vec_row) const
+{
+    auto& leaf = vec_leaf_[getSlot(leaf_ref)];
+    if (leaf.first_row == EXEC_ART_NONE) return;
+
+    vec_row.emplace_back(leaf.first_row);
+    if (leaf.more_row == EXEC_ART_NONE) return;
+
+    auto& vec_more_row = vec_more_row_[leaf.more_row];
+    vec_row.insert(vec_row.end(), vec_more_row.begin(), vec_more_row.end());
+}
+
+void SqlArtIndex_t::collectRow(NodeRef_t ref, std::vector<uint32_t>& vec_row) const
+{
+    if (getKind(ref) == EnumArtNodeKind::LEAF)
+    {
+        collectLeaf(ref, vec_row);
+        return;
+    }
+
+    auto& header = getHeader(ref);
+    if (header.leaf != EXEC_ART_NONE) collectLeaf(header.leaf, vec_row);
+    switch (getKind(ref))
+    {
+        case EnumArtNodeKind::NODE4:
+        {
+            auto& node = vec_node4_[getSlot(ref)];
+            for (uint16_t index = 0; index < header.num_child; index ++) collectRow(node.arr_child[index], vec_row);
+            break;
+        }
+        case EnumArtNodeKind::NODE16:
+        {
+            auto& node = vec_node16_[getSlot(ref)];
+            for (uint16_t index = 0; index < header.num_child; index ++) collectRow(node.arr_child[index], vec_row);
+            break;
+        }
+        case EnumArtNodeKind::NODE48:
+        {
+            auto& node = vec_node48_[getSlot(ref)];
+            for (uint16_t index = 0; index < header.num_child; index ++) collectRow(node.arr_child[index], vec_row);
+            break;
+        }
+        default:
+        {
+            auto& node = vec_node256_[getSlot(ref)];
+            for (auto child_ref : node.arr_child)
+            {
+                if (child_ref != EXEC_ART_NONE) collectRow(child_ref, vec_row);
+            }
+            break;
+        }
+    }
+}
+
+SqlArtIndex_t::NodeRef_t SqlArtIndex_t::findLeaf(std::string_view key) const
+{
+    size_t depth = 0;
+    for (auto ref = root_; ref != EXEC_ART_NONE; )
+    {
+        auto rest = key.substr(depth);
+        if (getKind(ref) == EnumArtNodeKind::LEAF) return (getBytes(vec_leaf_[getSlot(ref)].suffix) == rest) ? ref : EXEC_ART_NONE;
+
+        auto& header = getHeader(ref);
+        auto prefix = getBytes(header.prefix);
+        if (!rest.starts_with(prefix)) return EXEC_ART_NONE;
+
+        depth += prefix.size();
+        if (depth == key.size()) return header.leaf;
+
+        auto p_child = findChild(ref, static_cast<uint8_t>(key[depth ++]));
+        ref = (p_child == nullptr) ? EXEC_ART_NONE : *p_child;
+    }
+    return EXEC_ART_NONE;
+}
+
+void SqlArtIndex_t::lookup(std::string_view key, std::vector<uint32_t>& vec_row) const
+{
+    auto leaf_ref = findLeaf(key);
+    if (leaf_ref == EXEC_ART_NONE) return;
+
+    // rows rewritten by updates join the list of their key out of order
+    size_t num_row = vec_row.size();
+    collectLeaf(leaf_ref, vec_row);
+    std::sort(vec_row.begin() + num_row, vec_row.end());
+}
+
+void SqlArtIndex_t::erase(std::string_view key, uint32_t row)
+{
+    auto leaf_ref = findLeaf(key);
+    if (leaf_ref == EXEC_ART_NONE) return;
+
+    auto& leaf = vec_leaf_[getSlot(leaf_ref)];
+    auto p_more_row = (leaf.more_row == EXEC_ART_NONE) ? nullptr : &vec_more_row_[leaf.more_row];
+    if (leaf.first_row == row)
+    {
+        leaf.first_row = (p_more_row == nullptr || p_more_row->empty()) ? EXEC_ART_NONE : p_more_row->back();
+        if (leaf.first_row != EXEC_ART_NONE) p_more_row->pop_back();
+        return;
+    }
+    if (p_more_row == nullptr) return;
+
+    auto iter = std::find(p_more_row->begin(), p_more_row->end(), row);
+    if (iter == p_more_row->end()) return;
+    *iter = p_more_row->back();
+    p_more_row->pop_back();
+}
+
+void SqlArtIndex_t::scanPrefix(std::string_view prefix, std::vector<uint32_t>& vec_row) const
+{
+    // walk down until the prefix runs out, everything below that point matches
+    size_t depth = 0, num_row = vec_row.size();
+    for (auto ref = root_; ref != EXEC_ART_NONE; )
+    {
+        auto rest = prefix.substr(depth);
+        if (getKind(ref) == EnumArtNodeKind::LEAF)
+        {
+            if (getBytes(vec_leaf_[getSlot(ref)].suffix).starts_with(rest)) collectLeaf(ref, vec_row);
+            break;
+        }
+
+        auto node_prefix = getBytes(getHeader(ref).prefix);
+        if (rest.size() <= node_prefix.size())
+        {
+            if (node_prefix.starts_with(rest)) collectRow(ref, vec_row);
+            break;
+        }
+        if (!rest.starts_with(node_prefix)) break;
+
+        depth += node_prefix.size();
+        auto p_child = findChild(ref, static_cast<uint8_t>(prefix[depth ++]));
+        ref = (p_child == nullptr) ? EXEC_ART_NONE : *p_child;
+    }
+
+    // rows of different keys interleave
+    std::sort(vec_row.begin() + num_row, vec_row.end());
+}
+
+void SqlArtIndex_t::clear()
+{
+    *this = SqlArtIndex_t{};
+}
+
+uint64_t SqlArtIndex_t::getByte() const
+{
+    return vec_arena_.capacity() + vec_leaf_.capacity() * sizeof(Leaf_t) + vec_more_row_.capacity() * sizeof(std::vector<uint32_t>) + num_more_row_byte_
+         + vec_node4_.capacity() * sizeof(Node4_t) + vec_node16_.capacity() * sizeof(Node16_t)
+         + vec_node48_.capacity() * sizeof(Node48_t) + vec_node256_.capacity() * sizeof(Node256_t);
+}
+
+} // namespace sql::exec
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "vector"
+#include "string_view"
+#include "stdint.h"
+
+#define EXEC_ART_NONE        UINT32_MAX   // an empty child or leaf slot
+#define EXEC_ART_KIND_BITS   29           // a node reference keeps its kind above the pool index
+
+namespace sql::exec
+{
+
+enum class EnumArtNodeKind
+{
+    IDLE      = 0,
+    LEAF,
+    NODE4,
+    NODE16,
+    NODE48,
+    NODE256,
+};
+
+// adaptive radix tree over string keys, each key maps to the rows holding it
+// inner nodes grow from 4 to 16, 48 and 256 children, and a path without branches collapses into the prefix of the node below
+// key bytes live once in an arena, prefixes and leaf suffixes are ranges of it, so keys sharing a prefix share its bytes
+// nodes sit in pools per kind and refer to each other by 32-bit references, the tree copies like a value
+class SqlArtIndex_t
+{
+public:
+    void insert(std::string_view key, uint32_t row);
+    // a key left without rows keeps its leaf, inserting it again fills the leaf
+    void erase(std::string_view key, uint32_t row);
+
+    // appends the rows of the key, or of every key starting with the prefix, in ascending order
+    void lookup(std::string_view key, std::vector<uint32_t>& vec_row) const;
+    void scanPrefix(std::string_view prefix, std::vector<uint32_t>& vec_row) const;
+
+    void clear();
+    uint64_t getByte() const;
+
+private:
+    using NodeRef_t = uint32_t;
+
+    struct Range_t
+    {
+        uint32_t  offset = 0;
+        uint32_t  length = 0;
+    };
+
+    struct Leaf_t
+    {
+        Range_t   suffix;                      // the key bytes below the parent
+        uint32_t  first_row;                   // EXEC_ART_NONE once every row of the key is erased
+        uint32_t  more_row = EXEC_ART_NONE;    // list of further rows in vec_more_row_, keys are mostly unique
+    };
+
+    struct Header_t
+    {
+        Range_t    prefix;                     // bytes every key below shares after the branch byte
+        NodeRef_t  leaf = EXEC_ART_NONE;       // the key ending right after the prefix
+        uint16_t   num_child = 0;
+    };
+
+    struct Node4_t
+    {
+        Header_t   header;
+        uint8_t    arr_key[4];
+        NodeRef_t  arr_child[4];
+    };
+
+    struct Node16_t
+    {
+        Header_t   header;
+        uint8_t    arr_key[16];
+        NodeRef_t  arr_child[16];
+    };
+
+    struct Node48_t
+    {
+        Header_t   header;
+        uint8_t    arr_slot[256] = {};          // child slot + 1 for a key byte, 0 for none
+        NodeRef_t  arr_child[48];
+    };
+
+    struct Node256_t
+    {
+        Header_t   header;
+        NodeRef_t  arr_child[256];
+    };
+
+    inline static EnumArtNodeKind getKind(NodeRef_t ref) { return static_cast<EnumArtNodeKind>(ref >> EXEC_ART_KIND_BITS); }
+    inline static uint32_t getSlot(NodeRef_t ref) { return ref & ((1u << EXEC_ART_KIND_BITS) - 1); }
+    inline static NodeRef_t makeRef(EnumArtNodeKind kind, uint32_t slot) { return (static_cast<uint32_t>(kind) << EXEC_ART_KIND_BITS) | slot; }
+    inline std::string_view getBytes(Range_t range) const { return std::string_view(vec_arena_.data() + range.offset, range.length); }
+
+    Range_t addBytes(std::string_view bytes);
+    NodeRef_t newLeaf(std::string_view suffix, uint32_t row);
+    void addRow(NodeRef_t leaf_ref, uint32_t row);
+    NodeRef_t newNode4(Range_t prefix);
+    template <typename Node>
+    NodeRef_t allocate(std::vector<Node>& vec_node, EnumArtNodeKind kind);
+
+    Header_t& getHeader(NodeRef_t ref);
+    const Header_t& getHeader(NodeRef_t ref) const;
+    const NodeRef_t* findChild(NodeRef_t ref, uint8_t key_byte) const;
+    NodeRef_t* findChild(NodeRef_t ref, uint8_t key_byte);
+    NodeRef_t addChild(NodeRef_t ref, uint8_t key_byte, NodeRef_t child);   // returns the node, grown if it was full
+
+    NodeRef_t findLeaf(std::string_view key) const;
+    NodeRef_t insertAt(NodeRef_t ref, std::string_view key, size_t depth, uint32_t row);
+    NodeRef_t attachKey(NodeRef_t ref, std::string_view rest, size_t depth, uint32_t row);   // the key ending at depth below the node, or branching there
+    void collectRow(NodeRef_t ref, std::vector<uint32_t>& vec_row) const;
+    void collectLeaf(NodeRef_t leaf_ref, std::vector<uint32_t>& vec_row) const;
+
+    NodeRef_t                           root_ = EXEC_ART_NONE;
+    std::vector<char>                   vec_arena_;
+    std::vector<Leaf_t>                 vec_leaf_;
+    std::vector<std::vector<uint32_t>>  vec_more_row_;
+    std::vector<Node4_t>                vec_node4_;
+    std::vector<Node16_t>               vec_node16_;
+    std::vector<Node48_t>               vec_node48_;
+    std::vector<Node256_t>              vec_node256_;
+    std::vector<uint32_t>               arr_free_slot_[static_cast<size_t>(EnumArtNodeKind::NODE256) + 1];   // slots left behind by grown nodes
+    uint64_t                            num_more_row_byte_ = 0;
+};
+
+} // namespace sql::exec
@@ -0,0 +1,321 @@
+#include "executor/executor_block.h"
+#include "executor/executor_hash.h"
+
+#include "algorithm"
+
+namespace sql::exec
+{
+
+bool isZoneMatched(const ZoneMap_t& zone_map, const SqlValue_t& anchor_value, const EnumConditionActionType action)
+{
+    switch (action)
+    {
+        case EnumConditionActionType::LT:   return zone_map.min_value <  anchor_value;
+        case EnumConditionActionType::LTEQ: return zone_map.min_value <= anchor_value;
+        case EnumConditionActionType::EQ:   return zone_map.min_value <= anchor_value && anchor_value <= zone_map.max_value;
+        case EnumConditionActionType::GTEQ: return zone_map.max_value >= anchor_value;
+        case EnumConditionActionType::GT:   return zone_map.max_value >  anchor_value;
+        case EnumConditionActionType::LIKE:
+        {
+            // the values starting with the anchor sort between it and its last extension
+            auto p_min_value = std::get_if<std::string>(&zone_map.min_value);
+            auto p_anchor_value = std::get_if<std::string>(&anchor_value);
+            if (p_min_value == nullptr || p_anchor_value == nullptr) return true;
+            return zone_map.max_value >= anchor_value && p_min_value->compare(0, p_anchor_value->size(), *p_anchor_value) <= 0;
+        }
+        default: return true;
+    }
+}
+
+// salts of the split block bloom filter in the parquet format, one per word of a bucket
+static const uint32_t arr_bloom_salt[8] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+void SqlBloomFilter_t::insert(uint64_t hash)
+{
+    auto& bucket = arr_bucket_[getBucket(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+    for (uint32_t index = 0; index < 8; index ++)
+    {
+        bucket.word[index] |= 1u << ((key * arr_bloom_salt[index]) >> 27);
+    }
+}
+
+bool SqlBloomFilter_t::mayContain(uint64_t hash) const
+{
+    auto& bucket = arr_bucket_[getBucket(hash)];
+    uint32_t key = static_cast<uint32_t>(hash);
+    uint32_t missed = 0;
+    for (uint32_t index = 0; index < 8; index ++)
+    {
+        missed |= ~bucket.word[index] & (1u << ((key * arr_bloom_salt[index]) >> 27));
+    }
+    return missed == 0;
+}
+
+void SqlBloomFilter_t::clear()
+{
+    arr_bucket_.fill(Bucket_t{});
+}
+
+void SqlColumn_t::emplace_back(SqlValue_t&& value)
+{
+    if ((num_row_ & EXEC_BLOCK_MASK) == 0)
+    {
+        vec_block_.emplace_back();
+        vec_block_.back().reserve(EXEC_BLOCK_ROW_NUM);
+        vec_int_block_.emplace_back();
+        vec_double_block_.emplace_back();
+        vec_string_block_.emplace_back();
+        vec_zone_map_.emplace_back(ZoneMap_t{value, value, false});
+        if (is_bloom_) vec_bloom_filter_.emplace_back();
+    }
+
+    auto& zone_map = vec_zone_map_.back();
+    if (value < zone_map.min_value) zone_map.min_value = value;
+    if (zone_map.max_value < value) zone_map.max_value = value;
+    if (is_bloom_) vec_bloom_filter_.back().insert(hashValue(value));
+    if (is_art_) art_index_.insert(std::get<std::string>(value), num_row_);
+
+    num_string_byte_ += getHeapByte(value);
+    vec_block_.back().emplace_back(std::move(value));
+    num_row_ ++;
+
+    if ((num_row_ & EXEC_BLOCK_MASK) == 0) sealBlock(getBlockNum() - 1);
+}
+
+void SqlColumn_t::setValue(uint32_t row, SqlValue_t&& value)
+{
+    uint32_t block = row >> EXEC_BLOCK_BITS;
+    uint32_t slot = row & EXEC_BLOCK_MASK;
+    SqlValue_t old_value = getValue(row);
+
+    // the zone map is widened now and tightened by the next refreshBlockFilter(), the bloom filter forgets the old value there
+    auto& zone_map = vec_zone_map_[block];
+    if (value < zone_map.min_value) zone_map.min_value = value;
+    if (zone_map.max_value < value) zone_map.max_value = value;
+    zone_map.is_dirty = true;
+    if (is_bloom_) vec_bloom_filter_[block].insert(hashValue(value));
+    if (is_art_)
+    {
+        art_index_.erase(std::get<std::string>(old_value), row);
+        art_index_.insert(std::get<std::string>(value), row);
+    }
+
+    if (isEncoded(block) && vec_int_block_[block].getEncoding() != EnumIntEncoding::IDLE)
+    {
+        auto& int_block = vec_int_block_[block];
+        int64_t int_value = std::holds_alternative<int32_t>(value) ? std::get<int32_t>(value) : std::get<int64_t>(value);
+        if (int_block.set(slot, int_value)) return;
+        unsealBlock(block);
+    }
+
+    if (!isEncoded(block))
+    {
+        num_string_byte_ -= getHeapByte(old_value);
+        num_string_byte_ += getHeapByte(value);
+        vec_block_[block][slot] = std::move(value);
+    }
+    else if (vec_string_block_[block].isEncoded())
+    {
+        auto& string_block = vec_string_block_[block];
+        num_string_byte_ -= string_block.getHeapByte();
+        string_block.set(slot, std::get<std::string>(value));
+        num_string_byte_ += string_block.getHeapByte();
+    }
+    else vec_double_block_[block].set(slot, std::get<double>(value));
+}
+
+void SqlColumn_t::getIntBatch(const std::vector<uint32_t>& vec_row, std::vector<int64_t>& vec_value) const
+{
+    vec_value.resize(vec_row.size());
+    size_t index_begin = 0;
+    while (index_begin < vec_row.size())
+    {
+        uint32_t block = vec_row[index_begin] >> EXEC_BLOCK_BITS;
+        size_t index_end = index_begin + 1;
+        while (index_end < vec_row.size() && (vec_row[index_end] >> EXEC_BLOCK_BITS) == block) index_end ++;
+
+        if (isEncoded(block))
+        {
+            vec_int_block_[block].decode(&vec_row[index_begin], index_end - index_begin, &vec_value[index_begin]);
+        }
+        else
+        {
+            auto& block_value = vec_block_[block];
+            for (size_t index = index_begin; index < index_end; index ++)
+            {
+                auto& value = block_value[vec_row[index] & EXEC_BLOCK_MASK];
+                vec_value[index] = std::holds_alternative<int32_t>(value) ? std::get<int32_t>(value) : std::get<int64_t>(value);
+            }
+        }
+        index_begin = index_end;
+    }
+}
+
+void SqlColumn_t::getRealBatch(const std::vector<uint32_t>& vec_row, std::vector<double>& vec_value) const
+{
+    vec_value.resize(vec_row.size());
+    size_t index_begin = 0;
+    while (index_begin < vec_row.size())
+    {
+        uint32_t block = vec_row[index_begin] >> EXEC_BLOCK_BITS;
+        size_t index_end = index_begin + 1;
+        while (index_end < vec_row.size() && (vec_row[index_end] >> EXEC_BLOCK_BITS) == block) index_end ++;
+
+        if (isEncoded(block))
+        {
+            vec_double_block_[block].decode(&vec_row[index_begin], index_end - index_begin, &vec_value[index_begin]);
+        }
+        else
+        {
+            auto& block_value = vec_block_[block];
+            for (size_t index = index_begin; index < index_end; index ++) vec_value[index] = std::get<double>(block_value[vec_row[index] & EXEC_BLOCK_MASK]);
+        }
+        index_begin = index_end;
+    }
+}
+
+void SqlColumn_t::sealBlock(uint32_t block)
+{
+    auto& block_value = vec_block_[block];
+    auto& value = block_value.front();
+    if (std::holds_alternative<int32_t>(value) || std::holds_alternative<int64_t>(value))
+    {
+        auto& int_block = vec_int_block_[block];
+        int_block.encode(block_value);
+        num_encoded_byte_ += int_block.getByte();
+    }
+    else if (std::holds_alternative<double>(value))
+    {
+        auto& double_block = vec_double_block_[block];
+        double_block.encode(block_value);
+        num_encoded_byte_ += double_block.getByte();
+    }
+    else if (std::holds_alternative<std::string>(value))
+    {
+        // the string buffers are given back, the long strings now live in the heap of the block
+        auto& string_block = vec_string_block_[block];
+        string_block.encode(block_value);
+        num_encoded_byte_ += string_block.getByte();
+        for (auto& str_value : block_value) num_string_byte_ -= getHeapByte(str_value);
+        num_string_byte_ += string_block.getHeapByte();
+    }
+    else return;
+
+    num_encoded_block_ ++;
+    std::vector<SqlValue_t>().swap(block_value);
+}
+
+void SqlColumn_t::unsealBlock(uint32_t block)
+{
+    auto& int_block = vec_int_block_[block];
+    auto& block_value = vec_block_[block];
+    block_value.reserve(EXEC_BLOCK_ROW_NUM);
+    SqlValue_t decoded_value;
+    for (uint32_t slot = 0; slot < EXEC_BLOCK_ROW_NUM; slot ++)
+    {
+        int_block.getValue(slot, decoded_value);
+        block_value.emplace_back(decoded_value);
+    }
+
+    num_encoded_block_ --;
+    num_encoded_byte_ -= int_block.getByte();
+    int_block = SqlIntBlock_t{};
+}
+
+void SqlColumn_t::compact(const std::vector<uint32_t>& vec_dead_row)
+{
+    SqlColumn_t column;
+    column.is_bloom_ = is_bloom_;
+    bool is_art = is_art_;
+
+    // the rows are appended again, zone maps, bloom filters and encodings come out exact, the radix tree is built after them
+    size_t cursor = 0;
+    for (uint32_t row = 0; row < num_row_; row ++)
+    {
+        if (cursor < vec_dead_row.size() && vec_dead_row[cursor] == row)
+        {
+            cursor ++;
+            continue;
+        }
+
+        auto& block_value = vec_block_[row >> EXEC_BLOCK_BITS];
+        if (block_value.empty()) column.emplace_back(getValue(row));
+        else column.emplace_back(std::move(block_value[row & EXEC_BLOCK_MASK]));
+    }
+    *this = std::move(column);
+    if (is_art) enableArtIndex();
+}
+
+void SqlColumn_t::markDirty(uint32_t row_begin)
+{
+    for (uint32_t block = row_begin >> EXEC_BLOCK_BITS; block < vec_zone_map_.size(); block ++)
+    {
+        vec_zone_map_[block].is_dirty = true;
+    }
+}
+
+void SqlColumn_t::addMemoryUsage(MemoryUsage_t& usage) const
+{
+    uint64_t num_plain_block = vec_block_.size() - num_encoded_block_;
+    usage[EnumMemoryCategory::ROW] += vec_block_.capacity() * (sizeof(std::vector<SqlValue_t>) + sizeof(SqlIntBlock_t) + sizeof(SqlDoubleBlock_t) + sizeof(SqlStringBlock_t))
+                                    + num_plain_block * EXEC_BLOCK_ROW_NUM * sizeof(SqlValue_t) + num_encoded_byte_;
+    usage[EnumMemoryCategory::STRING] += num_string_byte_;
+    usage[EnumMemoryCategory::CACHE] += vec_zone_map_.capacity() * sizeof(ZoneMap_t) + vec_bloom_filter_.capacity() * sizeof(SqlBloomFilter_t);
+    if (is_art_) usage[EnumMemoryCategory::INDEX] += art_index_.getByte();
+}
+
+void SqlColumn_t::enableBloomFilter()
+{
+    if (is_bloom_) return;
+
+    is_bloom_ = true;
+    vec_bloom_filter_.resize(vec_block_.size());
+    markDirty(0);
+}
+
+void SqlColumn_t::enableArtIndex()
+{
+    if (is_art_) return;
+
+    is_art_ = true;
+    std::vector<std::pair<std::string_view, uint32_t>> vec_key(num_row_);
+    for (uint32_t row = 0; row < num_row_; row ++) vec_key[row] = {getString(row), row};
+
+    // keys in order descend the tree along the path the previous one took, and the rows of a key stay ascending
+    std::stable_sort(vec_key.begin(), vec_key.end(), [](const auto& left, const auto& right) { return left.first < right.first; });
+    for (auto& [key, row] : vec_key) art_index_.insert(key, row);
+}
+
+void SqlColumn_t::refreshBlockFilter()
+{
+    for (uint32_t block = 0; block < vec_zone_map_.size(); block ++)
+    {
+        auto& zone_map = vec_zone_map_[block];
+        if (!zone_map.is_dirty) continue;
+
+        uint32_t row_begin = block << EXEC_BLOCK_BITS;
+        uint32_t row_end = std::min<uint32_t>(num_row_, row_begin + EXEC_BLOCK_ROW_NUM);
+        SqlValue_t decoded_value;
+        zone_map.min_value = getValue(row_begin, decoded_value);
+        zone_map.max_value = zone_map.min_value;
+        for (uint32_t row = row_begin; row < row_end; row ++)
+        {
+            auto& value = getValue(row, decoded_value);
+            if (value < zone_map.min_value) zone_map.min_value = value;
+            if (zone_map.max_value < value) zone_map.max_value = value;
+        }
+        zone_map.is_dirty = false;
+
+        // a bloom filter cannot forget values, rebuild it from the rows that are left
+        if (!is_bloom_) continue;
+        auto& bloom_filter = vec_bloom_filter_[block];
+        bloom_filter.clear();
+        for (uint32_t row = row_begin; row < row_end; row ++) bloom_filter.insert(hashValue(getValue(row, decoded_value)));
+    }
+}
+
+} // namespace sql::exec
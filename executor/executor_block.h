@@ -0,0 +1,136 @@
+#pragma once
+
+#include "vector"
+#include "array"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_memory.h"
+#include "executor/executor_compress.h"
+#include "executor/executor_art.h"
+
+#define EXEC_BLOCK_BITS       12
+#define EXEC_BLOCK_ROW_NUM    (1u << EXEC_BLOCK_BITS)
+#define EXEC_BLOCK_MASK       (EXEC_BLOCK_ROW_NUM - 1)
+#define EXEC_BLOOM_BUCKET_NUM 128   // 256-bit buckets per block, about 8 bits per row
+
+static_assert((EXEC_BLOOM_BUCKET_NUM & (EXEC_BLOOM_BUCKET_NUM - 1)) == 0, "bloom bucket number must be a power of two");
+
+namespace sql::exec
+{
+
+// min/max of one column within one block, may be loose while dirty but never too tight
+struct ZoneMap_t
+{
+    SqlValue_t  min_value;
+    SqlValue_t  max_value;
+    bool        is_dirty = false;
+};
+
+bool isZoneMatched(const ZoneMap_t& zone_map, const SqlValue_t& anchor_value, const EnumConditionActionType action);
+
+// split block bloom filter, a key sets one bit in each 32-bit word of a single 256-bit bucket so a probe touches one cache line
+class SqlBloomFilter_t
+{
+public:
+    void insert(uint64_t hash);
+    bool mayContain(uint64_t hash) const;
+    void clear();
+
+private:
+    struct alignas(32) Bucket_t
+    {
+        uint32_t  word[8];
+    };
+
+    inline static uint32_t getBucket(uint64_t hash) { return static_cast<uint32_t>(hash >> 32) & (EXEC_BLOOM_BUCKET_NUM - 1); }
+
+    std::array<Bucket_t, EXEC_BLOOM_BUCKET_NUM>  arr_bucket_{};
+};
+
+// a column stored in fixed-size blocks, row r lives in block r >> EXEC_BLOCK_BITS at slot r & EXEC_BLOCK_MASK
+// a full INT, BIGINT or TIMESTAMP block is sealed into an encoded SqlIntBlock_t, a full DOUBLE block into a contiguous SqlDoubleBlock_t
+// and a full STRING block into the inline cells of a SqlStringBlock_t, only the block being filled and an INT block an update
+// could not encode stay plain
+class SqlColumn_t
+{
+public:
+    // a plain value is handed out in place, an encoded one is decoded into the slot of the caller
+    inline const SqlValue_t& getValue(uint32_t row, SqlValue_t& decoded_value) const
+    {
+        auto& block_value = vec_block_[row >> EXEC_BLOCK_BITS];
+        if (!block_value.empty()) return block_value[row & EXEC_BLOCK_MASK];
+
+        uint32_t block = row >> EXEC_BLOCK_BITS;
+        if (vec_int_block_[block].getEncoding() != EnumIntEncoding::IDLE) vec_int_block_[block].getValue(row & EXEC_BLOCK_MASK, decoded_value);
+        else if (vec_string_block_[block].isEncoded()) vec_string_block_[block].getValue(row & EXEC_BLOCK_MASK, decoded_value);
+        else vec_double_block_[block].getValue(row & EXEC_BLOCK_MASK, decoded_value);
+        return decoded_value;
+    }
+    inline SqlValue_t getValue(uint32_t row) const { SqlValue_t decoded_value; return getValue(row, decoded_value); }
+    // the bytes of a STRING value where they are stored, valid until the column changes
+    inline std::string_view getString(uint32_t row) const
+    {
+        auto& block_value = vec_block_[row >> EXEC_BLOCK_BITS];
+        if (!block_value.empty()) return std::get<std::string>(block_value[row & EXEC_BLOCK_MASK]);
+        return vec_string_block_[row >> EXEC_BLOCK_BITS].get(row & EXEC_BLOCK_MASK);
+    }
+    // the values of an INT, BIGINT or TIMESTAMP column at rows in ascending order, an encoded block is decoded once per batch
+    void getIntBatch(const std::vector<uint32_t>& vec_row, std::vector<int64_t>& vec_value) const;
+    // the same for a DOUBLE column
+    void getRealBatch(const std::vector<uint32_t>& vec_row, std::vector<double>& vec_value) const;
+    inline uint32_t size() const { return num_row_; }
+
+    void emplace_back(SqlValue_t&& value);
+    // rewrites one row in place, a sealed block keeps its encoding when the value fits it and is decoded back to plain otherwise
+    void setValue(uint32_t row, SqlValue_t&& value);
+
+    // drops the rows, which are in ascending order, and encodes the blocks again
+    void compact(const std::vector<uint32_t>& vec_dead_row);
+
+    inline uint32_t getBlockNum() const { return static_cast<uint32_t>(vec_block_.size()); }
+    inline bool isEncoded(uint32_t block) const { return vec_block_[block].empty(); }
+    inline const std::vector<SqlValue_t>& getBlock(uint32_t block) const { return vec_block_[block]; }
+    inline const SqlIntBlock_t& getIntBlock(uint32_t block) const { return vec_int_block_[block]; }
+    inline const SqlDoubleBlock_t& getDoubleBlock(uint32_t block) const { return vec_double_block_[block]; }
+    inline const SqlStringBlock_t& getStringBlock(uint32_t block) const { return vec_string_block_[block]; }
+    inline const ZoneMap_t& getZoneMap(uint32_t block) const { return vec_zone_map_[block]; }
+
+    // bloom filters are optional, a column without them keeps vec_bloom_filter_ empty
+    void enableBloomFilter();
+    inline bool hasBloomFilter() const { return is_bloom_; }
+    inline const SqlBloomFilter_t& getBloomFilter(uint32_t block) const { return vec_bloom_filter_[block]; }
+
+    // the radix tree index of a STRING column maps every value to its rows, it is kept up to date by emplace_back() and rebuilt by compact()
+    // enabled on a filled column it is built in one pass over the sorted values
+    void enableArtIndex();
+    inline bool hasArtIndex() const { return is_art_; }
+    inline const SqlArtIndex_t& getArtIndex() const { return art_index_; }
+
+    // rows from row_begin on were rewritten in place, their zone maps and bloom filters are rebuilt by the next refreshBlockFilter()
+    void markDirty(uint32_t row_begin);
+    void refreshBlockFilter();
+
+    // adds the row, string and cache bytes of the column, plain blocks are always reserved to full size
+    void addMemoryUsage(MemoryUsage_t& usage) const;
+    inline uint64_t getStringByte() const { return num_string_byte_; }
+
+private:
+    void sealBlock(uint32_t block);
+    void unsealBlock(uint32_t block);
+
+    std::vector<std::vector<SqlValue_t>>  vec_block_;       // empty once the block is encoded
+    std::vector<SqlIntBlock_t>            vec_int_block_;   // IDLE while the block is plain
+    std::vector<SqlDoubleBlock_t>         vec_double_block_;
+    std::vector<SqlStringBlock_t>         vec_string_block_;
+    std::vector<ZoneMap_t>                vec_zone_map_;
+    std::vector<SqlBloomFilter_t>         vec_bloom_filter_;
+    bool                                  is_bloom_ = false;
+    SqlArtIndex_t                         art_index_;
+    bool                                  is_art_ = false;
+    uint32_t                              num_row_ = 0;
+    uint64_t                              num_string_byte_ = 0;    // heap bytes of the plain string values and of the string blocks
+    uint32_t                              num_encoded_block_ = 0;
+    uint64_t                              num_encoded_byte_ = 0;
+};
+
+} // namespace sql::exec
@@ -0,0 +1,708 @@
+#include "atomic"
+#include "thread"
+#include "algorithm"
+
+#include "errno.h"
+#include "fcntl.h"
+#include "limits.h"
+#include "stdio.h"
+#include "string.h"
+#include "dirent.h"
+#include "unistd.h"
+#include "sys/stat.h"
+
+#include "executor/executor_checkpoint.h"
+#include "executor/executor_hash.h"
+#include "executor/executor_wal.h"
+
+namespace sql::exec
+{
+
+#define EXEC_SEGMENT_BLOCK_HEADER   16           // row count, byte count and checksum
+#define EXEC_CATALOG_TAG            UINT64_MAX   // the write of the catalog, a segment write is tagged with the index of the segment
+
+void runParallel(uint32_t num_task, const std::function<void(uint32_t)>& task)
+{
+    std::atomic<uint32_t> next_task = 0;
+    auto work = [&]()
+    {
+        for (uint32_t task_index = next_task.fetch_add(1); task_index < num_task; task_index = next_task.fetch_add(1)) task(task_index);
+    };
+
+    auto num_worker = std::min<uint32_t>(std::max<uint32_t>(std::thread::hardware_concurrency(), 1), num_task);
+    if (num_worker <= 1)
+    {
+        work();
+        return;
+    }
+
+    std::vector<std::thread> vec_worker;
+    for (uint32_t worker = 0; worker < num_worker; worker ++) vec_worker.emplace_back(work);
+    for (auto& th_worker : vec_worker) th_worker.join();
+}
+
+// lengths are stored in host order like those of the log
+static void putFixed32(std::string& buffer, uint32_t value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void putFixed64(std::string& buffer, uint64_t value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void putString(std::string& buffer, const std::string& value)
+{
+    putFixed32(buffer, static_cast<uint32_t>(value.size()));
+    buffer.append(value);
+}
+
+// the catalog read front to back, a read past its end fails
+struct CatalogCursor_t
+{
+    const char*  p_begin;
+    const char*  p_end;
+
+    template <typename Fixed>
+    bool getFixed(Fixed& value)
+    {
+        if (p_end - p_begin < static_cast<ptrdiff_t>(sizeof(value))) return false;
+        memcpy(&value, p_begin, sizeof(value));
+        p_begin += sizeof(value);
+        return true;
+    }
+
+    bool getString(std::string& value)
+    {
+        uint32_t length;
+        if (!getFixed(length) || p_end - p_begin < static_cast<ptrdiff_t>(length)) return false;
+        value.assign(p_begin, length);
+        p_begin += length;
+        return true;
+    }
+};
+
+// a segment read in pieces of EXEC_CHECKPOINT_IO_BYTE on a ring of its own, the next piece is read while the last one is parsed
+// a block that spans two pieces is moved to the front first
+class SegmentReader_t
+{
+public:
+    SegmentReader_t(int fd, bool is_sync_io) : fd_(fd), vec_buffer_(EXEC_CHECKPOINT_IO_BYTE), vec_ahead_(EXEC_CHECKPOINT_IO_BYTE)
+    {
+        io_ring_.open(1, {}, is_sync_io);
+        readAhead();
+    }
+
+    // the next size bytes, false at the end of the file or on a read error (errno is then set)
+    bool take(size_t size, const char*& p_byte)
+    {
+        if (end_ - begin_ < size && !fill(size)) return false;
+        p_byte = vec_buffer_.data() + begin_;
+        begin_ += size;
+        return true;
+    }
+    inline uint64_t getByte() const { return num_byte_; }
+
+private:
+    void readAhead()
+    {
+        is_reading_ = io_ring_.submitRead(fd_, vec_ahead_.data(), static_cast<uint32_t>(vec_ahead_.size()), num_byte_, 0);
+        if (!is_reading_) error_ = EIO;
+    }
+
+    bool fill(size_t size)
+    {
+        memmove(vec_buffer_.data(), vec_buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+        if (vec_buffer_.size() < size) vec_buffer_.resize(size);
+
+        while (end_ < size && is_reading_)
+        {
+            vec_completion_.clear();
+            io_ring_.reap(vec_completion_, true);
+            if (vec_completion_.empty()) continue;
+
+            // a read that failed or found the end is not followed by another one
+            is_reading_ = false;
+            auto result = vec_completion_.front().result;
+            if (result < 0) error_ = static_cast<int>(-result);
+            if (result <= 0) break;
+
+            auto num_read = static_cast<size_t>(result);
+            if (vec_buffer_.size() < end_ + num_read) vec_buffer_.resize(end_ + num_read);
+            memcpy(vec_buffer_.data() + end_, vec_ahead_.data(), num_read);
+            end_ += num_read;
+            num_byte_ += num_read;
+            readAhead();
+        }
+        errno = error_;
+        return end_ >= size;
+    }
+
+    int                          fd_;
+    std::vector<char>            vec_buffer_;
+    std::vector<char>            vec_ahead_;   // the read in flight lands here
+    size_t                       begin_ = 0;
+    size_t                       end_ = 0;
+    uint64_t                     num_byte_ = 0;
+    bool                         is_reading_ = false;
+    int                          error_ = 0;
+    SqlIoRing_t                  io_ring_;     // after the buffers, so it is closed and done with them first
+    std::vector<IoCompletion_t>  vec_completion_;
+};
+
+// a new or renamed file is only durable once the directory entry naming it is
+static bool syncDirectory(const std::string& dir_path)
+{
+    int fd = open(dir_path.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return false;
+    bool is_synced = (fsync(fd) == 0);
+    close(fd);
+    return is_synced;
+}
+
+static std::string getSegmentFilePath(const std::string& segment_dir_path, uint32_t table_index, uint32_t partition_index, uint32_t column_index)
+{
+    char file_path[PATH_MAX];
+    snprintf(file_path, sizeof(file_path), EXEC_SEGMENT_FILE_FORMAT, segment_dir_path.c_str(), table_index, partition_index, column_index);
+    return file_path;
+}
+
+static std::string getSegmentHeader(const EnumValueType value_type)
+{
+    std::string header(EXEC_SEGMENT_MAGIC);
+    header.push_back(static_cast<char>(EXEC_CHECKPOINT_VERSION));
+    header.push_back(static_cast<char>(value_type));
+    return header;
+}
+
+static void encodeSegment(const SqlColumn_t& column, const EnumValueType value_type, const std::vector<uint32_t>& vec_row, std::string& buffer)
+{
+    buffer = getSegmentHeader(value_type);
+    std::vector<uint32_t> vec_block_row;
+    std::vector<int64_t> vec_int;
+    std::vector<int32_t> vec_int32;
+    std::vector<double> vec_real;
+    for (size_t row_begin = 0; ; )
+    {
+        size_t row_end = std::min<size_t>(row_begin + EXEC_BLOCK_ROW_NUM, vec_row.size());
+        vec_block_row.assign(vec_row.begin() + row_begin, vec_row.begin() + row_end);
+        size_t header_offset = buffer.size();
+        buffer.append(EXEC_SEGMENT_BLOCK_HEADER, '\0');
+
+        switch (value_type)
+        {
+            case EnumValueType::VALUE_TYPE_INT:
+                column.getIntBatch(vec_block_row, vec_int);
+                vec_int32.assign(vec_int.begin(), vec_int.end());
+                buffer.append(reinterpret_cast<const char*>(vec_int32.data()), vec_int32.size() * sizeof(int32_t));
+                break;
+            case EnumValueType::VALUE_TYPE_BIGINT:
+            case EnumValueType::VALUE_TYPE_TIMESTAMP:
+                column.getIntBatch(vec_block_row, vec_int);
+                buffer.append(reinterpret_cast<const char*>(vec_int.data()), vec_int.size() * sizeof(int64_t));
+                break;
+            case EnumValueType::VALUE_TYPE_DOUBLE:
+                column.getRealBatch(vec_block_row, vec_real);
+                buffer.append(reinterpret_cast<const char*>(vec_real.data()), vec_real.size() * sizeof(double));
+                break;
+            case EnumValueType::VALUE_TYPE_STRING:
+                for (auto row : vec_block_row) putFixed32(buffer, static_cast<uint32_t>(column.getString(row).size()));
+                for (auto row : vec_block_row) buffer.append(column.getString(row));
+                break;
+            default:
+                break;
+        }
+
+        uint32_t num_block_row = static_cast<uint32_t>(row_end - row_begin);
+        uint32_t body_byte = static_cast<uint32_t>(buffer.size() - header_offset - EXEC_SEGMENT_BLOCK_HEADER);
+        uint64_t checksum = getChecksum(buffer.data() + header_offset + EXEC_SEGMENT_BLOCK_HEADER, body_byte);
+        memcpy(buffer.data() + header_offset, &num_block_row, sizeof(num_block_row));
+        memcpy(buffer.data() + header_offset + sizeof(num_block_row), &body_byte, sizeof(body_byte));
+        memcpy(buffer.data() + header_offset + sizeof(num_block_row) + sizeof(body_byte), &checksum, sizeof(checksum));
+
+        // the block without rows ends the segment, a file cut short is then told apart from a complete one
+        if (num_block_row == 0) break;
+        row_begin = row_end;
+    }
+}
+
+template <typename Fixed>
+static void loadFixed(const char* p_byte, uint32_t num_row, SqlColumn_t& column)
+{
+    for (uint32_t index = 0; index < num_row; index ++, p_byte += sizeof(Fixed))
+    {
+        Fixed value;
+        memcpy(&value, p_byte, sizeof(value));
+        column.emplace_back(SqlValue_t(value));
+    }
+}
+
+static bool loadSegment(const std::string& file_path, SqlColumn_t& column, const EnumValueType value_type, bool is_sync_io, uint64_t& num_byte)
+{
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        printf("Fail to load checkpoint segment \"%s\": %s\n", file_path.c_str(), strerror(errno));
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    SegmentReader_t reader(fd, is_sync_io);
+    auto header = getSegmentHeader(value_type);
+    const char* p_byte;
+    const char* p_fail = nullptr;
+    if (!reader.take(header.size(), p_byte) || memcmp(p_byte, header.data(), header.size()) != 0) p_fail = "not a segment of this version and column type";
+
+    while (p_fail == nullptr)
+    {
+        uint32_t num_block_row, body_byte;
+        uint64_t checksum;
+        if (!reader.take(EXEC_SEGMENT_BLOCK_HEADER, p_byte))
+        {
+            p_fail = (errno != 0) ? strerror(errno) : "file is cut short";
+            break;
+        }
+        memcpy(&num_block_row, p_byte, sizeof(num_block_row));
+        memcpy(&body_byte, p_byte + sizeof(num_block_row), sizeof(body_byte));
+        memcpy(&checksum, p_byte + sizeof(num_block_row) + sizeof(body_byte), sizeof(checksum));
+        if (num_block_row == 0) break;
+        if (num_block_row > EXEC_BLOCK_ROW_NUM || !reader.take(body_byte, p_byte) || getChecksum(p_byte, body_byte) != checksum)
+        {
+            p_fail = "block fails its checksum";
+            break;
+        }
+
+        const char* p_end = p_byte + body_byte;
+        switch (value_type)
+        {
+            case EnumValueType::VALUE_TYPE_INT:
+            case EnumValueType::VALUE_TYPE_BIGINT:
+            case EnumValueType::VALUE_TYPE_TIMESTAMP:
+            case EnumValueType::VALUE_TYPE_DOUBLE:
+            {
+                size_t value_byte = (value_type == EnumValueType::VALUE_TYPE_INT) ? sizeof(int32_t) : sizeof(int64_t);
+                if (body_byte != num_block_row * value_byte)
+                {
+                    p_fail = "block size does not match its rows";
+                    break;
+                }
+                if (value_type == EnumValueType::VALUE_TYPE_INT) loadFixed<int32_t>(p_byte, num_block_row, column);
+                else if (value_type == EnumValueType::VALUE_TYPE_DOUBLE) loadFixed<double>(p_byte, num_block_row, column);
+                else loadFixed<int64_t>(p_byte, num_block_row, column);
+                break;
+            }
+            case EnumValueType::VALUE_TYPE_STRING:
+            {
+                const char* p_length = p_byte;
+                const char* p_value = p_byte + num_block_row * sizeof(uint32_t);
+                for (uint32_t index = 0; index < num_block_row && p_fail == nullptr; index ++, p_length += sizeof(uint32_t))
+                {
+                    uint32_t length;
+                    memcpy(&length, p_length, sizeof(length));
+                    if (p_value > p_end || static_cast<size_t>(p_end - p_value) < length)
+                    {
+                        p_fail = "block size does not match its rows";
+                        break;
+                    }
+                    column.emplace_back(SqlValue_t(std::string(p_value, length)));
+                    p_value += length;
+                }
+                break;
+            }
+            default:
+                p_fail = "invalid column type";
+                break;
+        }
+    }
+
+    num_byte = reader.getByte();
+    close(fd);
+    if (p_fail == nullptr) return true;
+
+    printf("Fail to load checkpoint segment \"%s\": %s\n", file_path.c_str(), p_fail);
+    return false;
+}
+
+std::string SqlCheckpoint_t::getSegmentDirPath(uint64_t generation) const
+{
+    char dir_path[PATH_MAX];
+    snprintf(dir_path, sizeof(dir_path), EXEC_CHECKPOINT_DIR_FORMAT, dir_path_.c_str(), static_cast<unsigned long long>(generation));
+    return dir_path;
+}
+
+bool SqlCheckpoint_t::readCatalog(const std::string& dir_path, CheckpointCatalog_t& catalog)
+{
+    dir_path_ = dir_path;
+    generation_ = 0;
+    catalog = CheckpointCatalog_t{};
+
+    auto file_path = dir_path_ + "/" + EXEC_CHECKPOINT_FILE_NAME;
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0 && errno == ENOENT) return true;
+
+    struct stat file_stat;
+    std::string content;
+    bool is_read = (fd >= 0 && fstat(fd, &file_stat) == 0);
+    if (is_read)
+    {
+        content.resize(static_cast<size_t>(file_stat.st_size));
+        is_read = (pread(fd, content.data(), content.size(), 0) == static_cast<ssize_t>(content.size()));
+    }
+    if (fd >= 0) close(fd);
+    if (!is_read)
+    {
+        printf("Fail to read checkpoint \"%s\": %s\n", file_path.c_str(), strerror(errno));
+        return false;
+    }
+
+    // the checksum of everything before it closes the file
+    std::string header(EXEC_CHECKPOINT_MAGIC);
+    header.push_back(static_cast<char>(EXEC_CHECKPOINT_VERSION));
+    uint64_t checksum = 0;
+    bool is_valid = content.size() >= header.size() + sizeof(checksum) && content.compare(0, header.size(), header) == 0;
+    if (is_valid)
+    {
+        memcpy(&checksum, content.data() + content.size() - sizeof(checksum), sizeof(checksum));
+        is_valid = (getChecksum(content.data(), content.size() - sizeof(checksum)) == checksum);
+    }
+
+    CatalogCursor_t cursor{content.data() + header.size(), content.data() + content.size() - sizeof(checksum)};
+    uint32_t num_db = 0, num_table = 0;
+    is_valid = is_valid && cursor.getFixed(generation_) && cursor.getFixed(catalog.num_partition) && cursor.getFixed(num_db);
+    for (uint32_t db_index = 0; is_valid && db_index < num_db; db_index ++)
+    {
+        is_valid = cursor.getString(catalog.vec_db_name.emplace_back());
+    }
+    is_valid = is_valid && cursor.getFixed(num_table);
+    for (uint32_t table_index = 0; is_valid && table_index < num_table; table_index ++)
+    {
+        auto& table = catalog.vec_table.emplace_back();
+        uint32_t num_column = 0;
+        is_valid = cursor.getString(table.db_name) && cursor.getString(table.tb_name) && cursor.getFixed(table.log_group_num) && cursor.getFixed(num_column);
+        for (uint32_t column_index = 0; is_valid && column_index < num_column; column_index ++)
+        {
+            auto& property = table.vec_property.emplace_back();
+            uint8_t value_type = 0, flag = 0;
+            is_valid = cursor.getString(property.column_name) && cursor.getFixed(value_type) && cursor.getFixed(flag);
+            property.value_type = static_cast<EnumValueType>(value_type);
+            property.is_primary = (flag & 1) != 0;
+            property.is_bloom = (flag & 2) != 0;
+            property.is_indexed = (flag & 4) != 0;
+        }
+    }
+    if (is_valid && cursor.p_begin == cursor.p_end) return true;
+
+    printf("Fail to read checkpoint \"%s\": not a checkpoint of this version or damaged\n", file_path.c_str());
+    return false;
+}
+
+bool SqlCheckpoint_t::load(const CheckpointCatalog_t& catalog, bool is_sync_io, uint64_t& num_byte, uint64_t& num_row)
+{
+    // one task per column of every partition, a wide table spreads over as many cores as a long one
+    struct ColumnTask_t
+    {
+        uint32_t  table_index;
+        uint32_t  partition_index;
+        uint32_t  column_index;
+    };
+    std::vector<ColumnTask_t> vec_task;
+    std::vector<SqlTable_t*> vec_partition;
+    for (uint32_t table_index = 0; table_index < catalog.vec_table.size(); table_index ++)
+    {
+        auto& table = catalog.vec_table[table_index];
+        for (uint32_t partition_index = 0; partition_index < table.vec_partition.size(); partition_index ++)
+        {
+            table.vec_partition[partition_index]->beginBulkLoad();
+            vec_partition.emplace_back(table.vec_partition[partition_index]);
+            for (uint32_t column_index = 0; column_index < table.vec_property.size(); column_index ++)
+            {
+                vec_task.emplace_back(ColumnTask_t{table_index, partition_index, column_index});
+            }
+        }
+    }
+
+    auto segment_dir_path = getSegmentDirPath(generation_);
+    std::atomic<bool> is_failed = false;
+    std::atomic<uint64_t> num_byte_loaded = 0;
+    runParallel(static_cast<uint32_t>(vec_task.size()), [&](uint32_t task_index)
+    {
+        auto& task = vec_task[task_index];
+        auto& table = catalog.vec_table[task.table_index];
+        auto file_path = getSegmentFilePath(segment_dir_path, task.table_index, task.partition_index, task.column_index);
+        uint64_t num_segment_byte = 0;
+        auto& column = table.vec_partition[task.partition_index]->getLoadColumn(task.column_index);
+        if (!loadSegment(file_path, column, table.vec_property[task.column_index].value_type, is_sync_io, num_segment_byte)) is_failed = true;
+        num_byte_loaded += num_segment_byte;
+    });
+    num_byte = num_byte_loaded;
+    if (is_failed) return false;
+
+    // every index is built in one pass over its loaded column, the primary key index and the radix trees of a table side by side
+    std::vector<ColumnTask_t> vec_index_task;
+    for (auto& task : vec_task)
+    {
+        if (catalog.vec_table[task.table_index].vec_partition[task.partition_index]->hasLoadIndex(task.column_index)) vec_index_task.emplace_back(task);
+    }
+    runParallel(static_cast<uint32_t>(vec_index_task.size()), [&](uint32_t task_index)
+    {
+        auto& task = vec_index_task[task_index];
+        catalog.vec_table[task.table_index].vec_partition[task.partition_index]->buildLoadIndex(task.column_index);
+    });
+    for (auto p_partition : vec_partition)
+    {
+        if (!p_partition->finishBulkLoad()) is_failed = true;
+    }
+    if (is_failed)
+    {
+        printf("Fail to load checkpoint %llu: the columns of a table hold different row counts\n", static_cast<unsigned long long>(generation_));
+        return false;
+    }
+
+    num_row = 0;
+    for (auto p_partition : vec_partition) num_row += p_partition->getColumn(0).size();
+    return true;
+}
+
+bool SqlCheckpoint_t::begin(CheckpointCatalog_t&& catalog, uint64_t generation, bool is_sync_io)
+{
+    auto segment_dir_path = getSegmentDirPath(generation);
+    if (mkdir(segment_dir_path.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        printf("Fail to create checkpoint directory \"%s\": %s\n", segment_dir_path.c_str(), strerror(errno));
+        return false;
+    }
+
+    // without io_uring every piece is written at its submit, on the thread that polls or copies
+    catalog_ = std::move(catalog);
+    write_generation_ = generation;
+    next_table_ = 0;
+    deq_segment_.clear();
+    next_segment_ = 0;
+    num_segment_done_ = 0;
+    num_request_ = 0;
+    is_write_failed_ = false;
+    num_write_byte_ = 0;
+    num_write_row_ = 0;
+    num_write_table_ = catalog_.vec_table.size();
+    io_ring_.open(EXEC_IO_QUEUE_DEPTH, {}, is_sync_io);
+    state_ = EnumCheckpointState::WRITING;
+    return true;
+}
+
+void SqlCheckpoint_t::copyTable(uint64_t log_group_num)
+{
+    uint32_t table_index = next_table_ ++;
+    auto& table = catalog_.vec_table[table_index];
+    table.log_group_num = log_group_num;
+
+    std::vector<std::vector<uint32_t>> vec_live_row(table.vec_partition.size());
+    runParallel(static_cast<uint32_t>(table.vec_partition.size()), [&](uint32_t partition_index)
+    {
+        table.vec_partition[partition_index]->getLiveRow(vec_live_row[partition_index]);
+    });
+
+    auto segment_dir_path = getSegmentDirPath(write_generation_);
+    uint32_t first_segment = static_cast<uint32_t>(deq_segment_.size());
+    uint32_t num_column = static_cast<uint32_t>(table.vec_property.size());
+    for (uint32_t partition_index = 0; partition_index < table.vec_partition.size(); partition_index ++)
+    {
+        num_write_row_ += vec_live_row[partition_index].size();
+        for (uint32_t column_index = 0; column_index < num_column; column_index ++)
+        {
+            deq_segment_.emplace_back().file_path = getSegmentFilePath(segment_dir_path, table_index, partition_index, column_index);
+        }
+    }
+
+    // the copy, the only part the table has to hold still for
+    runParallel(static_cast<uint32_t>(deq_segment_.size()) - first_segment, [&](uint32_t task_index)
+    {
+        uint32_t partition_index = task_index / num_column, column_index = task_index % num_column;
+        auto& column = table.vec_partition[partition_index]->getColumn(column_index);
+        encodeSegment(column, table.vec_property[column_index].value_type, vec_live_row[partition_index], deq_segment_[first_segment + task_index].buffer);
+    });
+    for (uint32_t segment_index = first_segment; segment_index < deq_segment_.size(); segment_index ++) num_write_byte_ += deq_segment_[segment_index].buffer.size();
+    submitNextSegment();
+}
+
+bool SqlCheckpoint_t::submitCatalog()
+{
+    catalog_content_.assign(EXEC_CHECKPOINT_MAGIC);
+    catalog_content_.push_back(static_cast<char>(EXEC_CHECKPOINT_VERSION));
+    putFixed64(catalog_content_, write_generation_);
+    putFixed32(catalog_content_, catalog_.num_partition);
+    putFixed32(catalog_content_, static_cast<uint32_t>(catalog_.vec_db_name.size()));
+    for (auto& db_name : catalog_.vec_db_name) putString(catalog_content_, db_name);
+    putFixed32(catalog_content_, static_cast<uint32_t>(catalog_.vec_table.size()));
+    for (auto& table : catalog_.vec_table)
+    {
+        putString(catalog_content_, table.db_name);
+        putString(catalog_content_, table.tb_name);
+        putFixed64(catalog_content_, table.log_group_num);
+        putFixed32(catalog_content_, static_cast<uint32_t>(table.vec_property.size()));
+        for (auto& property : table.vec_property)
+        {
+            putString(catalog_content_, property.column_name);
+            catalog_content_.push_back(static_cast<char>(property.value_type));
+            catalog_content_.push_back(static_cast<char>((property.is_primary ? 1 : 0) | (property.is_bloom ? 2 : 0) | (property.is_indexed ? 4 : 0)));
+        }
+    }
+    putFixed64(catalog_content_, getChecksum(catalog_content_.data(), catalog_content_.size()));
+
+    // the segments are durable before the catalog names them
+    auto temp_file_path = dir_path_ + "/" + EXEC_CHECKPOINT_FILE_NAME + ".tmp";
+    catalog_fd_ = syncDirectory(getSegmentDirPath(write_generation_)) ? open(temp_file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if (catalog_fd_ < 0 || !io_ring_.submitWrite(catalog_fd_, EXEC_IO_BUFFER_NONE, catalog_content_.data(), static_cast<uint32_t>(catalog_content_.size()), 0, true, EXEC_CATALOG_TAG))
+    {
+        printf("Fail to write checkpoint \"%s\": %s\n", temp_file_path.c_str(), strerror(errno));
+        return false;
+    }
+    num_request_ ++;
+    num_write_byte_ += catalog_content_.size();
+    return true;
+}
+
+void SqlCheckpoint_t::submitNextSegment()
+{
+    while (next_segment_ < deq_segment_.size() && num_request_ < EXEC_IO_QUEUE_DEPTH && !is_write_failed_) submitSegment(next_segment_ ++);
+}
+
+void SqlCheckpoint_t::submitSegment(uint32_t segment_index)
+{
+    // one piece of a segment at a time, the last one is linked to the fdatasync of the file
+    auto& segment = deq_segment_[segment_index];
+    if (segment.fd < 0) segment.fd = open(segment.file_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(EXEC_CHECKPOINT_IO_BYTE, segment.buffer.size() - segment.offset));
+    bool is_last = (segment.offset + size == segment.buffer.size());
+    if (segment.fd < 0 || !io_ring_.submitWrite(segment.fd, EXEC_IO_BUFFER_NONE, segment.buffer.data() + segment.offset, size, segment.offset, is_last, segment_index))
+    {
+        printf("Fail to write checkpoint segment \"%s\": %s\n", segment.file_path.c_str(), strerror(errno));
+        is_write_failed_ = true;
+        return;
+    }
+    num_request_ ++;
+}
+
+EnumCheckpointState SqlCheckpoint_t::poll(bool is_wait)
+{
+    while (state_ == EnumCheckpointState::WRITING)
+    {
+        vec_completion_.clear();
+        io_ring_.reap(vec_completion_, is_wait);
+        for (auto& completion : vec_completion_)
+        {
+            num_request_ --;
+            if (completion.result < 0 && !is_write_failed_)
+            {
+                if (completion.tag == EXEC_CATALOG_TAG) printf("Fail to write checkpoint \"%s/%s.tmp\": %s\n", dir_path_.c_str(), EXEC_CHECKPOINT_FILE_NAME, strerror(static_cast<int>(-completion.result)));
+                else printf("Fail to write checkpoint segment \"%s\": %s\n", deq_segment_[completion.tag].file_path.c_str(), strerror(static_cast<int>(-completion.result)));
+                is_write_failed_ = true;
+            }
+            if (is_write_failed_) continue;
+
+            if (completion.tag == EXEC_CATALOG_TAG)
+            {
+                if (!switchGeneration()) is_write_failed_ = true;
+                continue;
+            }
+
+            // a finished segment gives its part of the copy back right away
+            auto& segment = deq_segment_[completion.tag];
+            segment.offset += static_cast<uint64_t>(completion.result);
+            if (segment.offset < segment.buffer.size())
+            {
+                submitSegment(static_cast<uint32_t>(completion.tag));
+                continue;
+            }
+            close(segment.fd);
+            segment.fd = -1;
+            std::string().swap(segment.buffer);
+            num_segment_done_ ++;
+        }
+        submitNextSegment();
+        if (!is_write_failed_ && catalog_fd_ < 0 && generation_ != write_generation_ && next_table_ == catalog_.vec_table.size() && num_segment_done_ == deq_segment_.size())
+        {
+            if (!submitCatalog()) is_write_failed_ = true;
+        }
+
+        // a failed write is only given up once the kernel is done with every buffer
+        if (num_request_ == 0 && (is_write_failed_ || generation_ == write_generation_)) finishWrite();
+        if (!is_wait) break;
+    }
+
+    if (state_ == EnumCheckpointState::WRITING) return state_;
+    auto state = state_;
+    state_ = EnumCheckpointState::IDLE;
+    return state;
+}
+
+bool SqlCheckpoint_t::switchGeneration()
+{
+    // the rename switches to the new generation in one step
+    auto file_path = dir_path_ + "/" + EXEC_CHECKPOINT_FILE_NAME;
+    auto temp_file_path = file_path + ".tmp";
+    close(catalog_fd_);
+    catalog_fd_ = -1;
+    if (rename(temp_file_path.c_str(), file_path.c_str()) != 0 || !syncDirectory(dir_path_))
+    {
+        printf("Fail to write checkpoint \"%s\": %s\n", file_path.c_str(), strerror(errno));
+        return false;
+    }
+
+    generation_ = write_generation_;
+    return true;
+}
+
+void SqlCheckpoint_t::finishWrite()
+{
+    for (auto& segment : deq_segment_)
+    {
+        if (segment.fd >= 0) close(segment.fd);
+    }
+    if (catalog_fd_ >= 0) close(catalog_fd_);
+    catalog_fd_ = -1;
+    deq_segment_.clear();
+    catalog_ = CheckpointCatalog_t{};
+    catalog_content_.clear();
+    io_ring_.close();
+    state_ = is_write_failed_ ? EnumCheckpointState::FAILED : EnumCheckpointState::WRITTEN;
+}
+
+void SqlCheckpoint_t::removeStale()
+{
+    auto p_dir = opendir(dir_path_.c_str());
+    if (p_dir == nullptr) return;
+
+    std::vector<std::string> vec_stale_dir, vec_stale_file;
+    while (auto p_entry = readdir(p_dir))
+    {
+        unsigned long long generation = 0;
+        int length = 0;
+        if (sscanf(p_entry->d_name, "ckpt.%llu%n", &generation, &length) == 1 && p_entry->d_name[length] == '\0' && generation != generation_)
+        {
+            vec_stale_dir.emplace_back(getSegmentDirPath(generation));
+        }
+        else if (sscanf(p_entry->d_name, "sql.%llu.wal%n", &generation, &length) == 1 && length > 0 && p_entry->d_name[length] == '\0' && generation < generation_)
+        {
+            vec_stale_file.emplace_back(SqlWriteAheadLog_t::getFilePath(dir_path_, generation));
+        }
+    }
+    closedir(p_dir);
+
+    for (auto& segment_dir_path : vec_stale_dir)
+    {
+        p_dir = opendir(segment_dir_path.c_str());
+        if (p_dir == nullptr) continue;
+        while (auto p_entry = readdir(p_dir))
+        {
+            if (strcmp(p_entry->d_name, ".") != 0 && strcmp(p_entry->d_name, "..") != 0) vec_stale_file.emplace_back(segment_dir_path + "/" + p_entry->d_name);
+        }
+        closedir(p_dir);
+    }
+    for (auto& file_path : vec_stale_file) unlink(file_path.c_str());
+    for (auto& segment_dir_path : vec_stale_dir) rmdir(segment_dir_path.c_str());
+}
+
+} // namespace sql::exec
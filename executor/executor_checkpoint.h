@@ -0,0 +1,129 @@
+#pragma once
+
+#include "string"
+#include "vector"
+#include "deque"
+#include "functional"
+#include "stdint.h"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_sql.h"
+#include "executor/executor_io.h"
+
+#define EXEC_CHECKPOINT_FILE_NAME   "sql.ckpt"
+#define EXEC_CHECKPOINT_DIR_FORMAT  "%s/ckpt.%llu"             // data directory and generation
+#define EXEC_SEGMENT_FILE_FORMAT    "%s/%u.%u.%u.seg"          // checkpoint directory, table, partition and column
+#define EXEC_CHECKPOINT_MAGIC       "SQLCKP"
+#define EXEC_SEGMENT_MAGIC          "SQLSEG"
+#define EXEC_CHECKPOINT_VERSION     2
+#define EXEC_CHECKPOINT_IO_BYTE     (4u << 20)   // segments are written and read in pieces of this size
+#define EXEC_CHECKPOINT_LOG_MB      64           // log size that triggers a checkpoint by default
+
+namespace sql::exec
+{
+
+// a table of the catalog and the partitions holding its rows, a table that is not sharded is its only partition
+struct CheckpointTable_t
+{
+    std::string                         db_name;
+    std::string                         tb_name;
+    std::vector<TableColumnProperty_t>  vec_property;
+    std::vector<SqlTable_t*>            vec_partition;
+    uint64_t                            log_group_num = 0;   // the groups at the front of the log of the generation that are already in the copy
+};
+
+struct CheckpointCatalog_t
+{
+    uint32_t                        num_partition = 1;
+    std::vector<std::string>        vec_db_name;   // a database without tables comes back as well
+    std::vector<CheckpointTable_t>  vec_table;
+};
+
+enum class EnumCheckpointState
+{
+    IDLE = 0,
+    WRITING,   // the tables are copied and the copy is on its way to the disk
+    WRITTEN,   // switched to the new generation
+    FAILED,    // the last generation stays, its logs are still replayed
+};
+
+// a copy of every table, the log starts over in the generation of the copy when it begins
+// each table is copied in a step of its own between two transactions and written on io_uring while statements run, so a statement
+// waits for the copy of one table at most; the catalog keeps how many groups of the new log went before the copy of each table,
+// and their writes to that table are skipped at replay
+// a restart before the switch replays the logs of the last generation and of every later one
+// <data dir>/sql.ckpt names the generation and holds the catalog, the rows of each column of each partition are in a segment of
+// <data dir>/ckpt.<generation>, so every column is encoded and loaded on a core of its own
+// segment file: the magic, the version byte, the value type byte, then blocks of at most EXEC_BLOCK_ROW_NUM values, each after its
+// row count (4 bytes), byte count (4 bytes) and FNV-1a checksum (8 bytes), a block with no rows ends the file
+// a block holds 4-byte INT, 8-byte BIGINT and TIMESTAMP and DOUBLE values, or the lengths (4 bytes each) and then the bytes of STRING values
+class SqlCheckpoint_t
+{
+public:
+    // the catalog of the last checkpoint, generation 0 and an empty catalog when none was taken yet
+    bool readCatalog(const std::string& dir_path, CheckpointCatalog_t& catalog);
+    // fills the partitions of the catalog, which must be empty, from the segments of the current generation
+    bool load(const CheckpointCatalog_t& catalog, bool is_sync_io, uint64_t& num_byte, uint64_t& num_row);
+    // starts the given generation of the tables of the catalog, nothing is copied yet
+    bool begin(CheckpointCatalog_t&& catalog, uint64_t generation, bool is_sync_io);
+    // the table copied next, its partitions are filled in right before, while the shards wait
+    inline CheckpointTable_t& getNextTable() { return catalog_.vec_table[next_table_]; }
+    // copies the next table as it is after the given number of groups of the new log, its partitions may change again as soon as it returns
+    // every table is copied before the schema changes
+    void copyTable(uint64_t log_group_num);
+    // reaps finished writes and starts the next ones, the catalog switches to the new generation once every segment is durable
+    // WRITING until then, waits for the switch or the failure when is_wait, which needs every table copied
+    EnumCheckpointState poll(bool is_wait);
+    // deletes the segments of every other generation and the logs before this one, left behind by a crash or by the last switch
+    void removeStale();
+
+    inline uint64_t getGeneration() const { return generation_; }
+    inline bool isWriting() const { return state_ == EnumCheckpointState::WRITING; }
+    inline bool isCopying() const { return isWriting() && !is_write_failed_ && next_table_ < catalog_.vec_table.size(); }
+    inline uint64_t getWriteByte() const { return num_write_byte_; }
+    inline uint64_t getWriteRow() const { return num_write_row_; }
+    inline size_t getWriteTableNum() const { return num_write_table_; }
+
+private:
+    // a segment and where its next piece goes, the buffer is the copy and stays until the last write on it is reaped
+    struct SegmentWrite_t
+    {
+        std::string  file_path;
+        std::string  buffer;
+        int          fd = -1;
+        uint64_t     offset = 0;
+    };
+
+    std::string getSegmentDirPath(uint64_t generation) const;
+    void submitSegment(uint32_t segment_index);
+    void submitNextSegment();
+    bool submitCatalog();
+    bool switchGeneration();
+    void finishWrite();
+
+    std::string  dir_path_;
+    uint64_t     generation_ = 0;
+
+    // the generation being written
+    EnumCheckpointState          state_ = EnumCheckpointState::IDLE;
+    uint64_t                     write_generation_ = 0;
+    CheckpointCatalog_t          catalog_;
+    uint32_t                     next_table_ = 0;      // the first one not copied yet
+    std::deque<SegmentWrite_t>   deq_segment_;         // grows by a table at a time under the writes in flight
+    uint32_t                     next_segment_ = 0;    // the first one not opened yet
+    uint32_t                     num_segment_done_ = 0;
+    std::string                  catalog_content_;
+    int                          catalog_fd_ = -1;
+    uint32_t                     num_request_ = 0;     // submitted and not reaped yet
+    bool                         is_write_failed_ = false;
+    uint64_t                     num_write_byte_ = 0;
+    uint64_t                     num_write_row_ = 0;
+    size_t                       num_write_table_ = 0;
+    SqlIoRing_t                  io_ring_;             // after the buffers, so it is closed and done with them first
+    std::vector<IoCompletion_t>  vec_completion_;
+};
+
+// runs task(0) ... task(num_task - 1) on one worker thread per core
+void runParallel(uint32_t num_task, const std::function<void(uint32_t)>& task);
+
+} // namespace sql::exec
@@ -0,0 +1,443 @@
+#include "bit"
+#include "algorithm"
+
+#include "executor/executor_compress.h"
+#include "executor/executor_block.h"
+
+namespace sql::exec
+{
+
+// packed codes plus the spare word
+static inline uint64_t getPackedByte(uint32_t num_value, uint32_t bit_width)
+{
+    return ((static_cast<uint64_t>(num_value) * bit_width + 63) / 64 + 1) * sizeof(uint64_t);
+}
+
+// calls the visitor with "value action anchor" as a predicate, a kernel gets one tight loop per comparison
+template <typename ValueType, typename Visitor>
+static void visitPredicate(const EnumConditionActionType action, ValueType anchor, const Visitor& visitor)
+{
+    switch (action)
+    {
+        case EnumConditionActionType::LT:   visitor([anchor](ValueType value) { return value <  anchor; }); break;
+        case EnumConditionActionType::LTEQ: visitor([anchor](ValueType value) { return value <= anchor; }); break;
+        case EnumConditionActionType::EQ:   visitor([anchor](ValueType value) { return value == anchor; }); break;
+        case EnumConditionActionType::GTEQ: visitor([anchor](ValueType value) { return value >= anchor; }); break;
+        case EnumConditionActionType::GT:   visitor([anchor](ValueType value) { return value >  anchor; }); break;
+        default: break;
+    }
+}
+
+static inline void selectAll(uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection)
+{
+    for (uint32_t slot = slot_begin; slot < slot_end; slot ++) vec_selection.emplace_back(row_base + slot);
+}
+
+void SqlIntBlock_t::encode(const std::vector<SqlValue_t>& vec_value)
+{
+    num_value_ = static_cast<uint32_t>(vec_value.size());
+    if (num_value_ == 0) return;
+
+    is_wide_ = std::holds_alternative<int64_t>(vec_value[0]);
+    std::vector<int64_t> vec_int(num_value_);
+    for (uint32_t slot = 0; slot < num_value_; slot ++)
+    {
+        vec_int[slot] = is_wide_ ? std::get<int64_t>(vec_value[slot]) : std::get<int32_t>(vec_value[slot]);
+    }
+
+    // a difference of two BIGINT values may not fit 64 bits, such a block is never delta encoded
+    int64_t min_value = vec_int[0], max_value = vec_int[0];
+    int64_t min_diff = 0, max_diff = 0;
+    bool is_delta_possible = true;
+    uint32_t num_run = 1;
+    for (uint32_t slot = 1; slot < num_value_; slot ++)
+    {
+        int64_t diff;
+        is_delta_possible &= !__builtin_sub_overflow(vec_int[slot], vec_int[slot - 1], &diff);
+        min_value = std::min(min_value, vec_int[slot]);
+        max_value = std::max(max_value, vec_int[slot]);
+        min_diff = (slot == 1) ? diff : std::min(min_diff, diff);
+        max_diff = (slot == 1) ? diff : std::max(max_diff, diff);
+        num_run += (vec_int[slot] != vec_int[slot - 1]);
+    }
+
+    // the smallest encoding wins, ties go to the frame for its cheap random access
+    uint32_t frame_width = std::bit_width(static_cast<uint64_t>(max_value) - static_cast<uint64_t>(min_value));
+    uint32_t delta_width = std::bit_width(static_cast<uint64_t>(max_diff) - static_cast<uint64_t>(min_diff));
+    uint64_t frame_byte = getPackedByte(num_value_, frame_width);
+    uint64_t delta_byte = is_delta_possible ? getPackedByte(num_value_, delta_width) + (num_value_ + EXEC_DELTA_STRIDE - 1) / EXEC_DELTA_STRIDE * sizeof(int64_t) : UINT64_MAX;
+    uint64_t run_byte = num_run * (sizeof(int64_t) + sizeof(uint32_t));
+
+    std::vector<uint64_t> vec_code(num_value_);
+    if (frame_byte <= delta_byte && frame_byte <= run_byte)
+    {
+        encoding_ = EnumIntEncoding::FRAME;
+        base_ = min_value;
+        for (uint32_t slot = 0; slot < num_value_; slot ++) vec_code[slot] = static_cast<uint64_t>(vec_int[slot]) - static_cast<uint64_t>(min_value);
+        packCode(vec_code, frame_width);
+    }
+    else if (run_byte <= delta_byte)
+    {
+        encoding_ = EnumIntEncoding::RLE;
+        for (uint32_t slot = 0; slot < num_value_; slot ++)
+        {
+            if (slot > 0 && vec_int[slot] == vec_run_value_.back())
+            {
+                vec_run_end_.back() = slot + 1;
+                continue;
+            }
+            vec_run_value_.emplace_back(vec_int[slot]);
+            vec_run_end_.emplace_back(slot + 1);
+        }
+    }
+    else
+    {
+        encoding_ = EnumIntEncoding::DELTA;
+        base_ = min_diff;
+        is_sorted_ = (min_diff >= 0);
+        for (uint32_t slot = 0; slot < num_value_; slot ++)
+        {
+            if (slot % EXEC_DELTA_STRIDE == 0) vec_checkpoint_.emplace_back(vec_int[slot]);
+            vec_code[slot] = (slot == 0) ? 0 : static_cast<uint64_t>(vec_int[slot] - vec_int[slot - 1]) - static_cast<uint64_t>(min_diff);
+        }
+        packCode(vec_code, delta_width);
+    }
+}
+
+void SqlIntBlock_t::packCode(const std::vector<uint64_t>& vec_code, uint32_t bit_width)
+{
+    bit_width_ = bit_width;
+    code_mask_ = (bit_width >= 64) ? UINT64_MAX : (1ull << bit_width) - 1;
+    vec_word_.assign(getPackedByte(static_cast<uint32_t>(vec_code.size()), bit_width) / sizeof(uint64_t), 0);
+    if (bit_width == 0) return;
+
+    for (size_t slot = 0; slot < vec_code.size(); slot ++)
+    {
+        uint64_t bit = slot * bit_width;
+        auto p_word = vec_word_.data() + (bit >> 6);
+        uint32_t shift = bit & 63;
+        p_word[0] |= vec_code[slot] << shift;
+        if (shift + bit_width > 64) p_word[1] |= vec_code[slot] >> (64 - shift);
+    }
+}
+
+int64_t SqlIntBlock_t::get(uint32_t slot) const
+{
+    switch (encoding_)
+    {
+        case EnumIntEncoding::FRAME:
+            return addCode(base_, getCode(slot));
+        case EnumIntEncoding::DELTA:
+        {
+            uint32_t checkpoint_slot = slot - slot % EXEC_DELTA_STRIDE;
+            int64_t value = vec_checkpoint_[slot / EXEC_DELTA_STRIDE];
+            if (bit_width_ == 0) return addCode(value, (slot - checkpoint_slot) * static_cast<uint64_t>(base_));
+            for (uint32_t index = checkpoint_slot + 1; index <= slot; index ++) value = addCode(value, static_cast<uint64_t>(base_) + getCode(index));
+            return value;
+        }
+        case EnumIntEncoding::RLE:
+            return vec_run_value_[std::upper_bound(vec_run_end_.begin(), vec_run_end_.end(), slot) - vec_run_end_.begin()];
+        default:
+            return 0;
+    }
+}
+
+void SqlIntBlock_t::decode(const uint32_t* p_row, size_t num_row, int64_t* p_value) const
+{
+    switch (encoding_)
+    {
+        case EnumIntEncoding::FRAME:
+        {
+            for (size_t index = 0; index < num_row; index ++) p_value[index] = addCode(base_, getCode(p_row[index] & EXEC_BLOCK_MASK));
+            return;
+        }
+        case EnumIntEncoding::DELTA:
+        {
+            // walk forward from checkpoint to checkpoint, every difference is added once
+            uint32_t cursor = UINT32_MAX;
+            int64_t value = 0;
+            for (size_t index = 0; index < num_row; index ++)
+            {
+                uint32_t slot = p_row[index] & EXEC_BLOCK_MASK;
+                uint32_t checkpoint_slot = slot - slot % EXEC_DELTA_STRIDE;
+                if (cursor == UINT32_MAX || cursor < checkpoint_slot)
+                {
+                    cursor = checkpoint_slot;
+                    value = vec_checkpoint_[slot / EXEC_DELTA_STRIDE];
+                }
+                for (; cursor < slot; cursor ++) value = addCode(value, static_cast<uint64_t>(base_) + getCode(cursor + 1));
+                p_value[index] = value;
+            }
+            return;
+        }
+        case EnumIntEncoding::RLE:
+        {
+            size_t run = 0;
+            for (size_t index = 0; index < num_row; index ++)
+            {
+                uint32_t slot = p_row[index] & EXEC_BLOCK_MASK;
+                while (vec_run_end_[run] <= slot) run ++;
+                p_value[index] = vec_run_value_[run];
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+bool SqlIntBlock_t::set(uint32_t slot, int64_t value)
+{
+    if (encoding_ != EnumIntEncoding::FRAME || value < base_) return false;
+
+    uint64_t code = static_cast<uint64_t>(value) - static_cast<uint64_t>(base_);
+    if (code > code_mask_) return false;
+    if (bit_width_ == 0) return true;
+
+    uint64_t bit = static_cast<uint64_t>(slot) * bit_width_;
+    auto p_word = vec_word_.data() + (bit >> 6);
+    uint32_t shift = bit & 63;
+    p_word[0] = (p_word[0] & ~(code_mask_ << shift)) | (code << shift);
+    if (shift + bit_width_ > 64) p_word[1] = (p_word[1] & ~(code_mask_ >> (64 - shift))) | (code >> (64 - shift));
+    return true;
+}
+
+uint64_t SqlIntBlock_t::getByte() const
+{
+    return sizeof(SqlIntBlock_t) + vec_word_.capacity() * sizeof(uint64_t) + vec_checkpoint_.capacity() * sizeof(int64_t)
+         + vec_run_value_.capacity() * sizeof(int64_t) + vec_run_end_.capacity() * sizeof(uint32_t);
+}
+
+uint32_t SqlIntBlock_t::getFirstSlot(int64_t value, bool is_equal_included) const
+{
+    uint32_t slot_low = 0, slot_high = num_value_;
+    while (slot_low < slot_high)
+    {
+        uint32_t slot_mid = (slot_low + slot_high) / 2;
+        int64_t mid_value = get(slot_mid);
+        if (mid_value > value || (is_equal_included && mid_value == value)) slot_high = slot_mid;
+        else slot_low = slot_mid + 1;
+    }
+    return slot_low;
+}
+
+template <typename Predicate>
+void SqlIntBlock_t::filterFrame(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    if (bit_width_ == 0)
+    {
+        if (predicate(0)) selectAll(slot_begin, slot_end, row_base, vec_selection);
+        return;
+    }
+
+    for (uint32_t slot = slot_begin; slot < slot_end; slot ++)
+    {
+        if (predicate(getCode(slot))) vec_selection.emplace_back(row_base + slot);
+    }
+}
+
+template <typename Predicate>
+void SqlIntBlock_t::filterDelta(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    // decode forward from the checkpoint before the range, one addition per value
+    int64_t value = 0;
+    for (uint32_t slot = slot_begin - slot_begin % EXEC_DELTA_STRIDE; slot < slot_end; slot ++)
+    {
+        if (slot % EXEC_DELTA_STRIDE == 0) value = vec_checkpoint_[slot / EXEC_DELTA_STRIDE];
+        else value = addCode(value, static_cast<uint64_t>(base_) + getCode(slot));
+        if (slot >= slot_begin && predicate(value)) vec_selection.emplace_back(row_base + slot);
+    }
+}
+
+template <typename Predicate>
+void SqlIntBlock_t::filterRun(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    // one comparison per run, a matching run is taken whole
+    size_t run = std::upper_bound(vec_run_end_.begin(), vec_run_end_.end(), slot_begin) - vec_run_end_.begin();
+    for (uint32_t run_begin = slot_begin; run < vec_run_end_.size() && run_begin < slot_end; run ++)
+    {
+        uint32_t run_end = std::min(vec_run_end_[run], slot_end);
+        if (predicate(vec_run_value_[run])) selectAll(run_begin, run_end, row_base, vec_selection);
+        run_begin = run_end;
+    }
+}
+
+void SqlIntBlock_t::filter(const EnumConditionActionType action, int64_t anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    switch (encoding_)
+    {
+        case EnumIntEncoding::FRAME:
+        {
+            // every value of the frame lies above an anchor below its base
+            if (anchor < base_)
+            {
+                if (action == EnumConditionActionType::GT || action == EnumConditionActionType::GTEQ) selectAll(slot_begin, slot_end, row_base, vec_selection);
+                return;
+            }
+
+            // otherwise compare the unsigned codes against the anchor moved into the frame, no value is rebuilt
+            visitPredicate<uint64_t>(action, static_cast<uint64_t>(anchor) - static_cast<uint64_t>(base_), [&](const auto& predicate)
+            {
+                filterFrame(predicate, slot_begin, slot_end, row_base, vec_selection);
+            });
+            return;
+        }
+        case EnumIntEncoding::DELTA:
+        {
+            if (!is_sorted_)
+            {
+                visitPredicate<int64_t>(action, anchor, [&](const auto& predicate)
+                {
+                    filterDelta(predicate, slot_begin, slot_end, row_base, vec_selection);
+                });
+                return;
+            }
+
+            // a sorted block matches a single range of slots, two binary searches find it
+            uint32_t match_begin = 0, match_end = num_value_;
+            switch (action)
+            {
+                case EnumConditionActionType::LT:   match_end = getFirstSlot(anchor, true); break;
+                case EnumConditionActionType::LTEQ: match_end = getFirstSlot(anchor, false); break;
+                case EnumConditionActionType::EQ:   match_begin = getFirstSlot(anchor, true); match_end = getFirstSlot(anchor, false); break;
+                case EnumConditionActionType::GTEQ: match_begin = getFirstSlot(anchor, true); break;
+                case EnumConditionActionType::GT:   match_begin = getFirstSlot(anchor, false); break;
+                default: return;
+            }
+            selectAll(std::max(slot_begin, match_begin), std::min(slot_end, match_end), row_base, vec_selection);
+            return;
+        }
+        case EnumIntEncoding::RLE:
+        {
+            visitPredicate<int64_t>(action, anchor, [&](const auto& predicate)
+            {
+                filterRun(predicate, slot_begin, slot_end, row_base, vec_selection);
+            });
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+void SqlDoubleBlock_t::encode(const std::vector<SqlValue_t>& vec_value)
+{
+    vec_value_.resize(vec_value.size());
+    for (size_t slot = 0; slot < vec_value.size(); slot ++) vec_value_[slot] = std::get<double>(vec_value[slot]);
+}
+
+void SqlDoubleBlock_t::decode(const uint32_t* p_row, size_t num_row, double* p_value) const
+{
+    for (size_t index = 0; index < num_row; index ++) p_value[index] = vec_value_[p_row[index] & EXEC_BLOCK_MASK];
+}
+
+void SqlDoubleBlock_t::filter(const EnumConditionActionType action, double anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    // a plain array, the compiler vectorizes the comparison
+    visitPredicate<double>(action, anchor, [&](const auto& predicate)
+    {
+        for (uint32_t slot = slot_begin; slot < slot_end; slot ++)
+        {
+            if (predicate(vec_value_[slot])) vec_selection.emplace_back(row_base + slot);
+        }
+    });
+}
+
+// the first bytes in an unsigned big-endian number, a missing byte counts as 0 so the order of two numbers follows the strings
+static inline uint32_t getPrefixKey(const char* p_byte, size_t length)
+{
+    uint32_t prefix = 0;
+    memcpy(&prefix, p_byte, std::min<size_t>(length, EXEC_STRING_PREFIX));
+    return __builtin_bswap32(prefix);
+}
+
+void SqlStringBlock_t::encode(const std::vector<SqlValue_t>& vec_value)
+{
+    uint64_t num_heap_byte = 0;
+    for (auto& value : vec_value)
+    {
+        auto length = std::get<std::string>(value).size();
+        if (length > EXEC_STRING_INLINE) num_heap_byte += length;
+    }
+
+    vec_cell_.resize(vec_value.size());
+    vec_heap_.reserve(num_heap_byte);
+    for (size_t slot = 0; slot < vec_value.size(); slot ++)
+    {
+        auto& str_value = std::get<std::string>(vec_value[slot]);
+        auto& cell = vec_cell_[slot];
+        cell.length = static_cast<uint32_t>(str_value.size());
+        if (str_value.size() <= EXEC_STRING_INLINE)
+        {
+            memcpy(cell.arr_byte, str_value.data(), str_value.size());
+            continue;
+        }
+
+        uint64_t offset = vec_heap_.size();
+        memcpy(cell.arr_byte, str_value.data(), EXEC_STRING_PREFIX);
+        memcpy(cell.arr_byte + EXEC_STRING_PREFIX, &offset, sizeof(offset));
+        vec_heap_.insert(vec_heap_.end(), str_value.begin(), str_value.end());
+    }
+}
+
+void SqlStringBlock_t::set(uint32_t slot, std::string_view value)
+{
+    auto& cell = vec_cell_[slot];
+    cell = InlineString_t{};
+    cell.length = static_cast<uint32_t>(value.size());
+    if (value.size() <= EXEC_STRING_INLINE)
+    {
+        memcpy(cell.arr_byte, value.data(), value.size());
+        return;
+    }
+
+    uint64_t offset = vec_heap_.size();
+    memcpy(cell.arr_byte, value.data(), EXEC_STRING_PREFIX);
+    memcpy(cell.arr_byte + EXEC_STRING_PREFIX, &offset, sizeof(offset));
+    vec_heap_.insert(vec_heap_.end(), value.begin(), value.end());
+}
+
+void SqlStringBlock_t::filter(const EnumConditionActionType action, const std::string& anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const
+{
+    uint32_t anchor_prefix = getPrefixKey(anchor.data(), anchor.size());
+    std::string_view anchor_view(anchor);
+
+    // equality fails on the length or the prefix for nearly every row, the bytes are compared only when both match
+    if (action == EnumConditionActionType::EQ)
+    {
+        for (uint32_t slot = slot_begin; slot < slot_end; slot ++)
+        {
+            auto& cell = vec_cell_[slot];
+            if (cell.length != anchor_view.size() || getPrefixKey(cell.arr_byte, EXEC_STRING_PREFIX) != anchor_prefix) continue;
+            if (get(slot) == anchor_view) vec_selection.emplace_back(row_base + slot);
+        }
+        return;
+    }
+
+    // a prefix match compares the bytes only past the first EXEC_STRING_PREFIX of them
+    if (action == EnumConditionActionType::LIKE)
+    {
+        uint32_t prefix_mask = (anchor_view.size() >= EXEC_STRING_PREFIX) ? UINT32_MAX : ~(UINT32_MAX >> (anchor_view.size() * 8));
+        for (uint32_t slot = slot_begin; slot < slot_end; slot ++)
+        {
+            auto& cell = vec_cell_[slot];
+            if (cell.length < anchor_view.size() || (getPrefixKey(cell.arr_byte, EXEC_STRING_PREFIX) & prefix_mask) != anchor_prefix) continue;
+            if (anchor_view.size() <= EXEC_STRING_PREFIX || get(slot).starts_with(anchor_view)) vec_selection.emplace_back(row_base + slot);
+        }
+        return;
+    }
+
+    // a range predicate on the three-way order, a differing prefix decides it alone
+    visitPredicate<int>(action, 0, [&](const auto& predicate)
+    {
+        for (uint32_t slot = slot_begin; slot < slot_end; slot ++)
+        {
+            uint32_t prefix = getPrefixKey(vec_cell_[slot].arr_byte, EXEC_STRING_PREFIX);
+            int order = (prefix < anchor_prefix) ? -1 : 1;
+            if (prefix == anchor_prefix) order = get(slot).compare(anchor_view);
+            if (predicate(order)) vec_selection.emplace_back(row_base + slot);
+        }
+    });
+}
+
+} // namespace sql::exec
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "vector"
+#include "string"
+#include "string_view"
+#include "string.h"
+#include "stdint.h"
+
+#include "def/sql_interface_def.h"
+
+#define EXEC_DELTA_STRIDE    64   // a delta block keeps every 64th value whole, a lookup adds at most 63 differences
+#define EXEC_STRING_INLINE   12   // longer strings keep their bytes in the heap of the block
+#define EXEC_STRING_PREFIX   4
+
+namespace sql::exec
+{
+
+enum class EnumIntEncoding
+{
+    IDLE      = 0,   // not encoded, the values are still plain
+    FRAME,           // frame of reference: value minus the block minimum, bit-packed
+    DELTA,           // difference to the previous value minus the smallest difference, bit-packed
+    RLE,             // runs of equal values
+};
+
+// a sealed block of INT or BIGINT values in the smallest of the encodings, predicates run on the packed codes or runs without decoding
+// arithmetic on codes is unsigned and wraps, so the full 64-bit range packs into at most 64 bits
+class SqlIntBlock_t
+{
+public:
+    void encode(const std::vector<SqlValue_t>& vec_value);
+
+    int64_t get(uint32_t slot) const;
+    inline void getValue(uint32_t slot, SqlValue_t& value) const
+    {
+        if (is_wide_) value = get(slot);
+        else value = static_cast<int32_t>(get(slot));
+    }
+    // the values of rows in ascending order, all of them in this block
+    void decode(const uint32_t* p_row, size_t num_row, int64_t* p_value) const;
+    // rewrites the code of a frame block in place, false if the value falls outside the frame or the block is not a frame
+    bool set(uint32_t slot, int64_t value);
+
+    // appends row_base + slot for every slot in [slot_begin, slot_end) whose value satisfies "value action anchor"
+    void filter(const EnumConditionActionType action, int64_t anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+
+    inline EnumIntEncoding getEncoding() const { return encoding_; }
+    uint64_t getByte() const;
+
+private:
+    inline uint64_t getCode(uint32_t slot) const
+    {
+        if (bit_width_ == 0) return 0;
+
+        uint64_t bit = static_cast<uint64_t>(slot) * bit_width_;
+        auto p_word = vec_word_.data() + (bit >> 6);
+        uint32_t shift = bit & 63;
+        uint64_t code = p_word[0] >> shift;
+        if (shift + bit_width_ > 64) code |= p_word[1] << (64 - shift);
+        return code & code_mask_;
+    }
+    inline int64_t addCode(int64_t value, uint64_t code) const { return static_cast<int64_t>(static_cast<uint64_t>(value) + code); }
+
+    void packCode(const std::vector<uint64_t>& vec_code, uint32_t bit_width);
+    uint32_t getFirstSlot(int64_t value, bool is_equal_included) const;   // of a sorted delta block, the first value above (or at) value
+
+    template <typename Predicate>
+    void filterFrame(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+    template <typename Predicate>
+    void filterDelta(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+    template <typename Predicate>
+    void filterRun(const Predicate& predicate, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+
+    EnumIntEncoding        encoding_ = EnumIntEncoding::IDLE;
+    bool                   is_wide_ = false;     // BIGINT values, decoded as int64_t
+    uint32_t               num_value_ = 0;
+    int64_t                base_ = 0;            // the minimum value, or the smallest difference of a delta block
+    uint32_t               bit_width_ = 0;
+    uint64_t               code_mask_ = 0;
+    bool                   is_sorted_ = false;   // a delta block without a negative difference
+    std::vector<uint64_t>  vec_word_;            // bit-packed codes, one spare word so a code never reads past the end
+    std::vector<int64_t>   vec_checkpoint_;      // every EXEC_DELTA_STRIDE-th value of a delta block
+    std::vector<int64_t>   vec_run_value_;
+    std::vector<uint32_t>  vec_run_end_;         // slot after the last one of every run
+};
+
+// a sealed block of DOUBLE values, one contiguous array the filter runs over
+class SqlDoubleBlock_t
+{
+public:
+    void encode(const std::vector<SqlValue_t>& vec_value);
+
+    inline bool isEncoded() const { return !vec_value_.empty(); }
+    inline double get(uint32_t slot) const { return vec_value_[slot]; }
+    inline void getValue(uint32_t slot, SqlValue_t& value) const { value = vec_value_[slot]; }
+    inline void set(uint32_t slot, double value) { vec_value_[slot] = value; }
+    void decode(const uint32_t* p_row, size_t num_row, double* p_value) const;
+
+    void filter(const EnumConditionActionType action, double anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+
+    inline uint64_t getByte() const { return sizeof(SqlDoubleBlock_t) + vec_value_.capacity() * sizeof(double); }
+
+private:
+    std::vector<double>  vec_value_;
+};
+
+// a string cell in 16 bytes, a short string is held whole and a long one as its first bytes plus the offset of all its bytes in the heap
+// both start with the prefix, most comparisons are decided on the length and the prefix without a dereference
+struct InlineString_t
+{
+    uint32_t  length = 0;
+    char      arr_byte[EXEC_STRING_INLINE] = {};
+};
+
+static_assert(sizeof(InlineString_t) == 16, "an inline string must stay 16 bytes");
+
+// a sealed block of STRING values as inline cells and one heap for the long ones
+class SqlStringBlock_t
+{
+public:
+    void encode(const std::vector<SqlValue_t>& vec_value);
+
+    inline bool isEncoded() const { return !vec_cell_.empty(); }
+    inline std::string_view get(uint32_t slot) const
+    {
+        auto& cell = vec_cell_[slot];
+        if (cell.length <= EXEC_STRING_INLINE) return std::string_view(cell.arr_byte, cell.length);
+
+        uint64_t offset;
+        memcpy(&offset, cell.arr_byte + EXEC_STRING_PREFIX, sizeof(offset));
+        return std::string_view(vec_heap_.data() + offset, cell.length);
+    }
+    inline void getValue(uint32_t slot, SqlValue_t& value) const { value = std::string(get(slot)); }
+    // a long value is appended to the heap, the bytes of the old one stay there until the block is encoded again
+    void set(uint32_t slot, std::string_view value);
+
+    void filter(const EnumConditionActionType action, const std::string& anchor, uint32_t slot_begin, uint32_t slot_end, uint32_t row_base, std::vector<uint32_t>& vec_selection) const;
+
+    inline uint64_t getByte() const { return sizeof(SqlStringBlock_t) + vec_cell_.capacity() * sizeof(InlineString_t); }
+    inline uint64_t getHeapByte() const { return vec_heap_.capacity(); }
+
+private:
+    std::vector<InlineString_t>  vec_cell_;
+    std::vector<char>            vec_heap_;
+};
+
+} // namespace sql::exec
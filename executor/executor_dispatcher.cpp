@@ -1,17 +1,55 @@
+#include "map"
+#include "algorithm"
+
 #include "executor/executor_dispatcher.h"
+#include "trace/sql_span.h"
 
 namespace sql::exec
 {
 
-bool SqlExecutorDispatcher::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_lfq)
+static bool isSchemaChange(const PacketCollection_t& packet)
 {
+    return std::holds_alternative<PacketCreateDatabase_t>(packet) || std::holds_alternative<PacketDropDatabase_t>(packet)
+        || std::holds_alternative<PacketCreateTable_t>(packet) || std::holds_alternative<PacketDropTable_t>(packet);
+}
+
+bool SqlExecutorDispatcher::init(std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>& sp_lfq, const ExecutorOption_t& option)
+{
+    if (!coordinator_.init(option.num_shard, option.is_perf_counter, [this](ShardInsert_t& insert) { logShardInsert(insert); })) return false;
+
+    auto& registry = SqlMetricsRegistry_t::getInstance();
+    registry.registerQueue("dispatcher", [sp_lfq]()
+    {
+        return QueueStat_t{sp_lfq->getSize(), sp_lfq->getOccupancy(), sp_lfq->getHighWaterMark(), sp_lfq->getFullCount()};
+    });
+    if (!option.stats_file_path.empty() && !registry.startDump(option.stats_file_path, option.stats_interval_sec)) return false;
+
+    // what was committed comes back whole, the memory limit only turns away what is inserted from now on
+    if (!option.data_dir_path.empty())
+    {
+        is_sync_io_ = option.is_sync_io;
+        checkpoint_log_byte_ = static_cast<uint64_t>(option.checkpoint_log_mb) << 20;
+        next_checkpoint_byte_ = checkpoint_log_byte_;
+        if (!recover(option.data_dir_path)) return false;
+    }
+    SqlMemoryBudget_t::getInstance().setLimit(static_cast<uint64_t>(option.memory_limit_mb) << 20);
+
     sp_lfq_ = sp_lfq;
+    is_perf_counter_ = option.is_perf_counter;
     is_running_ = true;
     th_backend_ = std::thread(&SqlExecutorDispatcher::runBackend, this);
 
     return true;
 }
 
+void SqlExecutorDispatcher::stop()
+{
+    if (!th_backend_.joinable()) return;
+
+    is_running_ = false;
+    th_backend_.join();
+}
+
 bool SqlExecutorDispatcher::dispatch(PacketCollection_t& command)
 {
     if (auto p_monostate = std::get_if<std::monostate>(&command))
@@ -41,16 +79,28 @@ bool SqlExecutorDispatcher::dispatch(PacketCollection_t& command)
     }
     else if (auto p_select = std::get_if<PacketSelect_t>(&command))
     {
-        return handleSelect(*p_select);
+        return runExplained(p_select->explain, [&]() { return handleSelect(*p_select); });
     }
     else if (auto p_delect = std::get_if<PacketDelect_t>(&command))
     {
-        return handleDelete(*p_delect);
+        return runExplained(p_delect->explain, [&]() { return handleDelete(*p_delect); });
+    }
+    else if (auto p_update = std::get_if<PacketUpdate_t>(&command))
+    {
+        return runExplained(p_update->explain, [&]() { return handleUpdate(*p_update); });
     }
     else if (auto p_insert = std::get_if<PacketInsert_t>(&command))
     {
         return handleInsert(*p_insert);
     }
+    else if (auto p_transaction = std::get_if<PacketTransaction_t>(&command))
+    {
+        return handleTransaction(*p_transaction);
+    }
+    else if (auto p_show = std::get_if<PacketShow_t>(&command))
+    {
+        return handleShow(*p_show);
+    }
     else
     {
         printf("Unknown data packet\n");
@@ -60,26 +110,266 @@ bool SqlExecutorDispatcher::dispatch(PacketCollection_t& command)
 
 void SqlExecutorDispatcher::runBackend()
 {
-    PacketCollection_t packet;
+    auto p_metrics = SqlMetricsRegistry_t::getInstance().registerThread("dispatcher");
+    trace::SqlSpanTracer_t::getInstance().nameThread("dispatcher");
+    if (is_perf_counter_) perf_counter_.open();
+    p_metrics_ = p_metrics;
+
+    vec_batch_.resize(EXEC_DISPATCH_BATCH_NUM);
     while (is_running_)
     {
-        if (!sp_lfq_->pop(packet)) continue;
-        dispatch(packet);
+        uint32_t num_packet = 0;
+        // each slot of the batch gives the ring back the packet it ran last time, the parser builds its next packet in it
+        while (num_packet < EXEC_DISPATCH_BATCH_NUM && sp_lfq_->popSwap(vec_batch_[num_packet])) num_packet ++;
+
+        if (num_packet == 0)
+        {
+            pollWrite();
+            if (checkpoint_.isCopying() && !opt_txn_.has_value()) copyCheckpointTable();
+        }
+
+        uint32_t run_end;
+        for (uint32_t run_begin = 0; run_begin < num_packet; run_begin = run_end)
+        {
+            pollWrite();
+
+            // a run ends at the first packet that is not an insert into the same table, a lone insert takes the usual way
+            run_end = run_begin + 1;
+            auto p_insert = std::get_if<PacketInsert_t>(&vec_batch_[run_begin].packet);
+            if (p_insert != nullptr)
+            {
+                for (; run_end < num_packet; run_end ++)
+                {
+                    auto p_next_insert = std::get_if<PacketInsert_t>(&vec_batch_[run_end].packet);
+                    if (p_next_insert == nullptr || p_next_insert->table_name != p_insert->table_name) break;
+                }
+            }
+            if (coordinator_.isEnabled() && p_insert != nullptr) postInsertRun(run_begin, run_end, p_metrics);
+            else if (run_end - run_begin > 1) runInsertRun(run_begin, run_end, p_metrics);
+            else
+            {
+                // any other statement sees the inserts posted before it and is logged after them
+                // and a schema change comes after the copy of every table, the log of the generation replays it in full
+                if (coordinator_.isEnabled()) coordinator_.waitInsert();
+                if (isSchemaChange(vec_batch_[run_begin].packet) && !opt_txn_.has_value())
+                {
+                    while (checkpoint_.isCopying()) copyCheckpointTable();
+                }
+                runStatement(vec_batch_[run_begin], p_metrics);
+            }
+
+            // between transactions every table is consistent, a checkpoint copies one table there and a long log is folded into a new one
+            if (checkpoint_.isCopying() && !opt_txn_.has_value()) copyCheckpointTable();
+            if (next_checkpoint_byte_ > 0 && !opt_txn_.has_value() && !checkpoint_.isWriting() && wal_.isOpen() && wal_.getGroupByte() >= next_checkpoint_byte_)
+            {
+                next_checkpoint_byte_ = beginCheckpoint() ? checkpoint_log_byte_ : wal_.getGroupByte() + checkpoint_log_byte_;
+            }
+        }
+    }
+
+    // a transaction left open was never acknowledged, and a checkpoint at a clean exit leaves no log to replay on the next start
+    if (coordinator_.isEnabled()) coordinator_.waitInsert();
+    if (opt_txn_.has_value())
+    {
+        txn_manager_.rollback(*opt_txn_);
+        opt_txn_.reset();
+        vec_txn_entry_.clear();
+        if (coordinator_.isEnabled()) coordinator_.handleTransaction(EnumTransactionActionType::ROLLBACK);
+    }
+    while (checkpoint_.isCopying()) copyCheckpointTable();
+    if (checkpoint_.isWriting()) finishCheckpoint(true);
+    if (wal_.isOpen() && (wal_.getGroupByte() > 0 || log_generation_ != checkpoint_.getGeneration()) && beginCheckpoint())
+    {
+        while (checkpoint_.isCopying()) copyCheckpointTable();
+        finishCheckpoint(true);
+    }
+    wal_.close();
+    acknowledge(true);
+}
+
+void SqlExecutorDispatcher::pollWrite()
+{
+    // shard inserts, log and checkpoint writes finish while statements run, their acknowledgements go out between two statements
+    if (coordinator_.isEnabled()) coordinator_.pollInsert();
+    if (wal_.isOpen())
+    {
+        wal_.poll(false);
+        acknowledge(false);
+    }
+    if (checkpoint_.isWriting()) finishCheckpoint(false);
+}
+
+void SqlExecutorDispatcher::runStatement(PacketEnvelope_t& envelope, SqlThreadMetrics_t* p_metrics)
+{
+    uint64_t dispatch_ns = getSteadyNs();
+    if (trace::SqlSpanTracer_t::isTracing())
+    {
+        trace::SqlSpanTracer_t::getInstance().record(trace::Span_t{"queue wait", "queue", envelope.enqueue_ns, dispatch_ns,
+                                                                   envelope.enqueue_ns, trace::EnumSpanFlowType::FINISH});
+    }
+
+    auto slot = envelope.packet.index();
+    PerfSample_t perf_begin, perf_end;
+    takeRowTouched();
+    perf_counter_.read(perf_begin);
+    statement_lsn_ = 0;
+    bool is_done;
+    {
+        trace::SpanGuard_t span(SqlMetricsRegistry_t::getSlotName(slot), "executor");
+        is_done = dispatch(envelope.packet);
+        if (is_done) logStatement(envelope.packet);
+    }
+    perf_counter_.read(perf_end);
+    if (perf_counter_.isOpen()) p_metrics->recordPerf(slot, perf_end - perf_begin, 1);
+
+    // a logged write is done once durable, its latency includes the wait for the log
+    auto wait_ns = dispatch_ns - envelope.enqueue_ns;
+    auto num_row = takeRowTouched();
+    if (statement_lsn_ == 0) p_metrics->record(slot, wait_ns, getSteadyNs() - dispatch_ns, num_row, is_done);
+    else deq_pending_ack_.emplace_back(PendingAck_t{statement_lsn_, [=](bool)
+    {
+        p_metrics->record(slot, wait_ns, getSteadyNs() - dispatch_ns, num_row, is_done);
+    }});
+}
+
+void SqlExecutorDispatcher::runInsertRun(uint32_t run_begin, uint32_t run_end, SqlThreadMetrics_t* p_metrics)
+{
+    uint64_t dispatch_ns = getSteadyNs();
+    if (trace::SqlSpanTracer_t::isTracing())
+    {
+        for (uint32_t index = run_begin; index < run_end; index ++)
+        {
+            auto& envelope = vec_batch_[index];
+            trace::SqlSpanTracer_t::getInstance().record(trace::Span_t{"queue wait", "queue", envelope.enqueue_ns, dispatch_ns,
+                                                                       envelope.enqueue_ns, trace::EnumSpanFlowType::FINISH});
+        }
+    }
+
+    auto slot = vec_batch_[run_begin].packet.index();
+    uint32_t num_statement = run_end - run_begin;
+    PerfSample_t perf_begin, perf_end;
+    perf_counter_.read(perf_begin);
+    statement_lsn_ = 0;
+    {
+        trace::SpanGuard_t span(SqlMetricsRegistry_t::getSlotName(slot), "executor");
+        handleInsertRun(run_begin, run_end);
+
+        // the inserted rows commit together, so they are logged as one group as well
+        if (wal_.isOpen())
+        {
+            vec_p_log_packet_.clear();
+            for (uint32_t index = run_begin; index < run_end; index ++)
+            {
+                if (!vec_is_run_inserted_[index - run_begin]) continue;
+
+                if (opt_txn_.has_value()) vec_txn_entry_.emplace_back(LogEntry_t{sql_.getDatabaseNameInUse(), std::move(vec_batch_[index].packet)});
+                else vec_p_log_packet_.emplace_back(&vec_batch_[index].packet);
+            }
+            if (!vec_p_log_packet_.empty()) statement_lsn_ = wal_.append(sql_.getDatabaseNameInUse(), vec_p_log_packet_);
+        }
+    }
+    perf_counter_.read(perf_end);
+    if (perf_counter_.isOpen()) p_metrics->recordPerf(slot, perf_end - perf_begin, num_statement);
+
+    // every statement keeps its own result and wait, the run time is shared out evenly
+    uint64_t run_ns = getSteadyNs() - dispatch_ns;
+    for (uint32_t index = run_begin; index < run_end; index ++)
+    {
+        auto wait_ns = dispatch_ns - vec_batch_[index].enqueue_ns;
+        bool is_done = vec_is_run_inserted_[index - run_begin];
+        if (statement_lsn_ == 0) p_metrics->record(slot, wait_ns, run_ns / num_statement, is_done ? 1 : 0, is_done);
+        else deq_pending_ack_.emplace_back(PendingAck_t{statement_lsn_, [=](bool)
+        {
+            p_metrics->record(slot, wait_ns, getSteadyNs() - dispatch_ns, is_done ? 1 : 0, is_done);
+        }});
+    }
+}
+
+void SqlExecutorDispatcher::postInsertRun(uint32_t run_begin, uint32_t run_end, SqlThreadMetrics_t* p_metrics)
+{
+    uint64_t dispatch_ns = getSteadyNs();
+    if (trace::SqlSpanTracer_t::isTracing())
+    {
+        for (uint32_t index = run_begin; index < run_end; index ++)
+        {
+            auto& envelope = vec_batch_[index];
+            trace::SqlSpanTracer_t::getInstance().record(trace::Span_t{"queue wait", "queue", envelope.enqueue_ns, dispatch_ns,
+                                                                       envelope.enqueue_ns, trace::EnumSpanFlowType::FINISH});
+        }
+    }
+
+    auto slot = vec_batch_[run_begin].packet.index();
+    auto p_table_in_use = getRunTable(run_begin, run_end);
+    if (p_table_in_use == nullptr)
+    {
+        for (uint32_t index = run_begin; index < run_end; index ++)
+        {
+            p_metrics->record(slot, dispatch_ns - vec_batch_[index].enqueue_ns, getSteadyNs() - dispatch_ns, 0, false);
+        }
+        return;
+    }
+
+    // the owner shards run the rows while the next statements are dispatched, logShardInsert() takes it from there
+    trace::SpanGuard_t span(SqlMetricsRegistry_t::getSlotName(slot), "executor");
+    coordinator_.postInsert(p_table_in_use, vec_batch_, run_begin, run_end, dispatch_ns);
+}
+
+void SqlExecutorDispatcher::logShardInsert(ShardInsert_t& insert)
+{
+    // the database in use and the transaction are as they were at the post, a statement changing them waits for the inserts first
+    auto& vec_envelope = insert.vec_envelope;
+    auto slot = vec_envelope.front().packet.index();
+    uint64_t lsn = 0;
+    if (wal_.isOpen())
+    {
+        vec_p_log_packet_.clear();
+        for (size_t index = 0; index < vec_envelope.size(); index ++)
+        {
+            if (!insert.vec_is_inserted[index]) continue;
+
+            if (opt_txn_.has_value()) vec_txn_entry_.emplace_back(LogEntry_t{sql_.getDatabaseNameInUse(), std::move(vec_envelope[index].packet)});
+            else vec_p_log_packet_.emplace_back(&vec_envelope[index].packet);
+        }
+        if (!vec_p_log_packet_.empty()) lsn = wal_.append(sql_.getDatabaseNameInUse(), vec_p_log_packet_);
+    }
+
+    // a row the shard turned away was reported there, it is neither logged nor counted
+    auto dispatch_ns = insert.dispatch_ns;
+    for (size_t index = 0; index < vec_envelope.size(); index ++)
+    {
+        auto wait_ns = dispatch_ns - vec_envelope[index].enqueue_ns;
+        bool is_done = insert.vec_is_inserted[index];
+        if (lsn == 0) p_metrics_->record(slot, wait_ns, getSteadyNs() - dispatch_ns, is_done ? 1 : 0, is_done);
+        else deq_pending_ack_.emplace_back(PendingAck_t{lsn, [=, p_metrics = p_metrics_](bool)
+        {
+            p_metrics->record(slot, wait_ns, getSteadyNs() - dispatch_ns, is_done ? 1 : 0, is_done);
+        }});
     }
 }
 
 bool SqlExecutorDispatcher::handleCreateDatabase(const PacketCreateDatabase_t& packet)
 {
+    if (!verifyNoTransaction()) return false;
     return sql_.createDatabase(packet.db_name);
 }
 
 bool SqlExecutorDispatcher::handleDropDatabase(const PacketDropDatabase_t& packet)
 {
+    if (!verifyNoTransaction()) return false;
+
+    auto p_db = sql_.getDatabaseByName(packet.db_name);
+    if (coordinator_.isEnabled() && p_db != nullptr)
+    {
+        std::vector<SqlTable_t*> vec_table;
+        p_db->getAllTable(vec_table);
+        for (auto p_table : vec_table) coordinator_.dropTable(p_table);
+    }
     return sql_.dropDatabase(packet.db_name);
 }
 
 bool SqlExecutorDispatcher::handleCreateTable(const PacketCreateTable_t& packet)
 {
+    if (!verifyNoTransaction()) return false;
     if (sql_.getDatabaseInUse() == nullptr)
     {
         printf("Failed: no database in use\n");
@@ -96,12 +386,15 @@ bool SqlExecutorDispatcher::handleUseDatabase(const PacketUseDatabase_t& packet)
 
 bool SqlExecutorDispatcher::handleDropTable(const PacketDropTable_t& packet)
 {
+    if (!verifyNoTransaction()) return false;
     if (sql_.getDatabaseInUse() == nullptr)
     {
         printf("Failed: no database in use\n");
         return false;
     }
 
+    auto p_table = sql_.getDatabaseInUse()->getTableByName(packet.table_name);
+    if (coordinator_.isEnabled() && p_table != nullptr) coordinator_.dropTable(p_table);
     return sql_.getDatabaseInUse()->dropTable(packet.table_name);
 }
 
@@ -120,8 +413,42 @@ bool SqlExecutorDispatcher::handleSelect(const PacketSelect_t& packet)
         return false;
     }
 
-    if (packet.condition.action == EnumConditionActionType::IDLE) return p_table_in_use->selectData(packet.column_name);
-    else return p_table_in_use->selectData(packet.column_name, packet.condition);
+    // readers never take locks, they only pick which versions to see
+    auto snapshot = opt_txn_.has_value() ? opt_txn_->snapshot : txn_manager_.getSnapshot();
+    if (!packet.join.table_name.empty())
+    {
+        auto p_join_table = sql_.getDatabaseInUse()->getTableByName(packet.join.table_name);
+        if (p_join_table == nullptr)
+        {
+            printf("Failed: table \"%s\" doesn\'t exist\n", packet.join.table_name.c_str());
+            return false;
+        }
+
+        if (coordinator_.isEnabled())
+        {
+            return coordinator_.selectJoinData(packet.table_name, p_table_in_use, p_join_table, packet.vec_projection, packet.join, packet.condition);
+        }
+        return p_table_in_use->selectJoinData(snapshot, packet.table_name, *p_join_table, packet.vec_projection, packet.join, packet.condition);
+    }
+
+    bool has_aggregate = std::any_of(packet.vec_projection.begin(), packet.vec_projection.end(), [](const ProjectionDescriptor_t& projection)
+    {
+        return projection.aggregate != EnumAggregateType::IDLE;
+    });
+    if (has_aggregate || !packet.group_column_name.empty())
+    {
+        if (coordinator_.isEnabled())
+        {
+            return coordinator_.selectGroupData(p_table_in_use, packet.vec_projection, packet.condition, packet.group_column_name);
+        }
+        return p_table_in_use->selectGroupData(snapshot, packet.vec_projection, packet.condition, packet.group_column_name);
+    }
+
+    if (coordinator_.isEnabled())
+    {
+        return coordinator_.selectData(p_table_in_use, packet.vec_projection, packet.condition, packet.order, packet.limit);
+    }
+    return p_table_in_use->selectData(snapshot, packet.vec_projection, packet.condition, packet.order, packet.limit);
 }
 
 bool SqlExecutorDispatcher::handleDelete(const PacketDelect_t& packet)
@@ -139,7 +466,45 @@ bool SqlExecutorDispatcher::handleDelete(const PacketDelect_t& packet)
         return false;
     }
 
-    return p_table_in_use->deleteRow(packet.condition);
+    uint32_t num_deleted = 0;
+    bool is_deleted = coordinator_.isEnabled() ? coordinator_.deleteRow(p_table_in_use, packet.condition, num_deleted) : runInTransaction([&](SqlTransaction_t& txn)
+    {
+        return p_table_in_use->deleteRow(txn, packet.condition, num_deleted);
+    });
+    if (!is_deleted) return false;
+    if (isPlanOnly()) return true;
+
+    printf("%d row(s) deleted\n", num_deleted);
+    addRowTouched(num_deleted);
+    return true;
+}
+
+bool SqlExecutorDispatcher::handleUpdate(const PacketUpdate_t& packet)
+{
+    if (sql_.getDatabaseInUse() == nullptr)
+    {
+        printf("Failed: no database in use\n");
+        return false;
+    }
+
+    auto p_table_in_use = sql_.getDatabaseInUse()->getTableByName(packet.table_name);
+    if (p_table_in_use == nullptr)
+    {
+        printf("Failed: table \"%s\" doesn\'t exist\n", packet.table_name.c_str());
+        return false;
+    }
+
+    uint32_t num_updated = 0;
+    bool is_updated = coordinator_.isEnabled() ? coordinator_.updateRow(p_table_in_use, packet.vec_assignment, packet.condition, num_updated) : runInTransaction([&](SqlTransaction_t& txn)
+    {
+        return p_table_in_use->updateRow(txn, packet.vec_assignment, packet.condition, num_updated);
+    });
+    if (!is_updated) return false;
+    if (isPlanOnly()) return true;
+
+    printf("%d row(s) updated\n", num_updated);
+    addRowTouched(num_updated);
+    return true;
 }
 
 bool SqlExecutorDispatcher::handleInsert(const PacketInsert_t& packet)
@@ -157,7 +522,521 @@ bool SqlExecutorDispatcher::handleInsert(const PacketInsert_t& packet)
         return false;
     }
 
-    return p_table_in_use->insertRow(packet.vec_value);
+    // a sharded insert never gets here, postInsertRun() sends it to its owner shard
+    bool is_inserted = runInTransaction([&](SqlTransaction_t& txn)
+    {
+        return p_table_in_use->insertRow(txn, packet.vec_value);
+    });
+    if (is_inserted) addRowTouched(1);
+    return is_inserted;
+}
+
+SqlTable_t* SqlExecutorDispatcher::getRunTable(uint32_t run_begin, uint32_t run_end)
+{
+    // the checks of handleInsert() are done once for the run, a failed one fails every statement of it
+    auto& table_name = std::get<PacketInsert_t>(vec_batch_[run_begin].packet).table_name;
+    auto p_db_in_use = sql_.getDatabaseInUse();
+    auto p_table_in_use = (p_db_in_use == nullptr) ? nullptr : p_db_in_use->getTableByName(table_name);
+    if (p_table_in_use != nullptr) return p_table_in_use;
+
+    for (uint32_t index = run_begin; index < run_end; index ++)
+    {
+        if (p_db_in_use == nullptr) printf("Failed: no database in use\n");
+        else printf("Failed: table \"%s\" doesn\'t exist\n", table_name.c_str());
+    }
+    return nullptr;
+}
+
+void SqlExecutorDispatcher::handleInsertRun(uint32_t run_begin, uint32_t run_end)
+{
+    vec_is_run_inserted_.assign(run_end - run_begin, false);
+    auto p_table_in_use = getRunTable(run_begin, run_end);
+    if (p_table_in_use == nullptr) return;
+
+    vec_p_run_value_.clear();
+    for (uint32_t index = run_begin; index < run_end; index ++)
+    {
+        vec_p_run_value_.emplace_back(&std::get<PacketInsert_t>(vec_batch_[index].packet).vec_value);
+    }
+
+    // a rejected row leaves nothing behind, so the others may share one autocommit transaction
+    runInTransaction([&](SqlTransaction_t& txn)
+    {
+        p_table_in_use->insertRows(txn, vec_p_run_value_, vec_is_run_inserted_);
+        return true;
+    });
+}
+
+bool SqlExecutorDispatcher::handleTransaction(const PacketTransaction_t& packet)
+{
+    switch (packet.action)
+    {
+        case EnumTransactionActionType::BEGIN:
+        {
+            if (opt_txn_.has_value())
+            {
+                printf("Fail to begin: a transaction is already in progress\n");
+                return false;
+            }
+            opt_txn_ = txn_manager_.begin();
+            if (coordinator_.isEnabled()) coordinator_.handleTransaction(packet.action);
+            printf("Begin transaction\n");
+            return true;
+        }
+        case EnumTransactionActionType::COMMIT:
+        case EnumTransactionActionType::ROLLBACK:
+        {
+            bool is_commit = (packet.action == EnumTransactionActionType::COMMIT);
+            if (!opt_txn_.has_value())
+            {
+                printf("Fail to %s: no transaction in progress\n", is_commit ? "commit" : "rollback");
+                return false;
+            }
+
+            if (is_commit) txn_manager_.commit(*opt_txn_);
+            else txn_manager_.rollback(*opt_txn_);
+            opt_txn_.reset();
+            if (coordinator_.isEnabled()) coordinator_.handleTransaction(packet.action);
+
+            // the writes of the transaction are logged as one group, the commit is acknowledged once it is durable
+            if (is_commit && wal_.isOpen() && !vec_txn_entry_.empty()) statement_lsn_ = wal_.append(vec_txn_entry_);
+            vec_txn_entry_.clear();
+            if (statement_lsn_ == 0)
+            {
+                printf("%s transaction\n", is_commit ? "Commit" : "Rollback");
+                return true;
+            }
+            deq_pending_ack_.emplace_back(PendingAck_t{statement_lsn_, [](bool is_durable)
+            {
+                if (is_durable) printf("Commit transaction\n");
+                else printf("Commit transaction, but it is not durable\n");
+            }});
+            return true;
+        }
+        default:
+            printf("Unknown transaction action\n");
+            return false;
+    }
+}
+
+void SqlExecutorDispatcher::printMemory()
+{
+    auto& budget = SqlMemoryBudget_t::getInstance();
+    if (budget.getLimit() == EXEC_MEMORY_NO_LIMIT) printf("Memory in use %.2f MB, no limit\n", budget.getUsed() / EXEC_MEMORY_MB);
+    else printf("Memory in use %.2f MB of %.2f MB\n", budget.getUsed() / EXEC_MEMORY_MB, budget.getLimit() / EXEC_MEMORY_MB);
+
+    std::vector<std::string> vec_db_name, vec_tb_name;
+    sql_.getAllDatabaseName(vec_db_name);
+    for (auto& db_name : vec_db_name)
+    {
+        auto p_db = sql_.getDatabaseByName(db_name);
+        MemoryUsage_t db_usage;
+        p_db->getAllTableName(vec_tb_name);
+        for (auto& tb_name : vec_tb_name)
+        {
+            // a sharded table keeps its rows in the partitions, the catalog only holds the schema
+            auto p_table = p_db->getTableByName(tb_name);
+            MemoryUsage_t tb_usage;
+            p_table->getMemoryUsage(tb_usage);
+            if (coordinator_.isEnabled()) coordinator_.getMemoryUsage(p_table, tb_usage);
+            db_usage += tb_usage;
+
+            printf("  Table \"%s\": ", tb_name.c_str());
+            tb_usage.print(stdout);
+        }
+        printf("Database \"%s\": ", db_name.c_str());
+        db_usage.print(stdout);
+    }
+}
+
+bool SqlExecutorDispatcher::handleShow(const PacketShow_t& packet)
+{
+    switch (packet.target)
+    {
+        case EnumShowTargetType::STATS:
+            SqlMetricsRegistry_t::getInstance().print(stdout);
+            return true;
+        case EnumShowTargetType::MEMORY:
+            printMemory();
+            return true;
+        default:
+            printf("Unknown show target\n");
+            return false;
+    }
+}
+
+void SqlExecutorDispatcher::logStatement(PacketCollection_t& packet)
+{
+    if (!wal_.isOpen()) return;
+
+    // only what changed the tables is logged, a plan of a write ran nothing
+    // the packet has run, so it is changed in place and logged where it is, or moved into the open transaction
+    if (auto p_delect = std::get_if<PacketDelect_t>(&packet))
+    {
+        if (p_delect->explain == EnumExplainType::PLAN) return;
+        p_delect->explain = EnumExplainType::IDLE;
+    }
+    else if (auto p_update = std::get_if<PacketUpdate_t>(&packet))
+    {
+        if (p_update->explain == EnumExplainType::PLAN) return;
+        p_update->explain = EnumExplainType::IDLE;
+    }
+    else if (!isSchemaChange(packet) && !std::holds_alternative<PacketInsert_t>(packet))
+    {
+        return;
+    }
+
+    if (opt_txn_.has_value())
+    {
+        vec_txn_entry_.emplace_back(LogEntry_t{sql_.getDatabaseNameInUse(), std::move(packet)});
+        return;
+    }
+    vec_p_log_packet_.assign(1, &packet);
+    statement_lsn_ = wal_.append(sql_.getDatabaseNameInUse(), vec_p_log_packet_);
+}
+
+void SqlExecutorDispatcher::acknowledge(bool is_final)
+{
+    while (!deq_pending_ack_.empty())
+    {
+        auto& ack = deq_pending_ack_.front();
+        bool is_durable = (ack.lsn <= wal_.getDurableLsn());
+        if (!is_durable && !wal_.isBroken() && !is_final) return;
+
+        ack.on_acknowledge(is_durable);
+        deq_pending_ack_.pop_front();
+    }
+}
+
+bool SqlExecutorDispatcher::recover(const std::string& data_dir_path)
+{
+    data_dir_path_ = data_dir_path;
+    uint64_t begin_ns = getSteadyNs();
+    CheckpointCatalog_t catalog;
+    if (!checkpoint_.readCatalog(data_dir_path_, catalog)) return false;
+
+    // partition i of a table holds the keys that hash to shard i, which only holds for the shard number the checkpoint was taken with
+    uint32_t num_partition = coordinator_.isEnabled() ? coordinator_.getShardNum() : 1;
+    if (!catalog.vec_table.empty() && catalog.num_partition != num_partition)
+    {
+        printf("Fail to recover \"%s\": its checkpoint splits every table into %u partition(s), start with as many shards\n", data_dir_path_.c_str(), catalog.num_partition);
+        return false;
+    }
+    for (auto& db_name : catalog.vec_db_name) sql_.restoreDatabase(db_name);
+    std::map<SqlTable_t*, uint64_t> map_copied_group;
+    for (auto& table : catalog.vec_table)
+    {
+        auto p_table = &sql_.restoreDatabase(table.db_name).restoreTable(table.tb_name, table.vec_property);
+        if (coordinator_.isEnabled()) coordinator_.getPartition(p_table, table.vec_partition);
+        else table.vec_partition.assign(1, p_table);
+        map_copied_group[p_table] = table.log_group_num;
+    }
+
+    uint64_t num_byte = 0, num_row = 0;
+    if (!checkpoint_.load(catalog, is_sync_io_, num_byte, num_row)) return false;
+    uint64_t load_ns = getSteadyNs() - begin_ns;
+    if (checkpoint_.getGeneration() > 0)
+    {
+        printf("Load checkpoint %llu: %llu row(s) of %zu table(s), %.1f MB in %.3f s, %.1f MB/s\n", static_cast<unsigned long long>(checkpoint_.getGeneration()),
+               static_cast<unsigned long long>(num_row), catalog.vec_table.size(), num_byte / EXEC_MEMORY_MB, load_ns / 1e9, num_byte / EXEC_MEMORY_MB / std::max(load_ns / 1e9, 1e-9));
+    }
+
+    // a checkpoint that never switched leaves the logs of the generations after it, they replay one after the other
+    std::vector<std::vector<LogEntry_t>> vec_group;
+    size_t num_statement = 0, num_group = 0;
+    uint64_t num_log_byte = 0, replay_ns = 0;
+    for (log_generation_ = checkpoint_.getGeneration(); ; log_generation_ ++)
+    {
+        if (!wal_.open(data_dir_path_, log_generation_, is_sync_io_, vec_group)) return false;
+
+        // only the log of the checkpoint's own generation went on while its tables were copied
+        uint64_t replay_begin_ns = getSteadyNs();
+        if (!replayLog(vec_group, map_copied_group))
+        {
+            printf("Fail to recover \"%s\": a logged statement does not apply again\n", data_dir_path_.c_str());
+            return false;
+        }
+        replay_ns += getSteadyNs() - replay_begin_ns;
+        for (auto& vec_entry : vec_group) num_statement += vec_entry.size();
+        num_group += vec_group.size();
+        num_log_byte += wal_.getGroupByte();
+        map_copied_group.clear();
+        if (!SqlWriteAheadLog_t::isPresent(data_dir_path_, log_generation_ + 1)) break;
+    }
+    printf("Log \"%s\" written with %s\n", SqlWriteAheadLog_t::getFilePath(data_dir_path_, log_generation_).c_str(), wal_.isAsync() ? "io_uring" : "synchronous I/O");
+
+    if (num_group > 0)
+    {
+        printf("Replay log: %zu statement(s) in %zu group(s), %.1f MB in %.3f s, %.0f statement(s)/s\n", num_statement, num_group,
+               num_log_byte / EXEC_MEMORY_MB, replay_ns / 1e9, num_statement / std::max(replay_ns / 1e9, 1e-9));
+    }
+    if (checkpoint_.getGeneration() > 0 || num_group > 0) printf("Recover in %.3f s\n", (getSteadyNs() - begin_ns) / 1e9);
+
+    checkpoint_.removeStale();
+    return true;
+}
+
+bool SqlExecutorDispatcher::replayLog(const std::vector<std::vector<LogEntry_t>>& vec_group, const std::map<SqlTable_t*, uint64_t>& map_copied_group)
+{
+    // a write touches one table, so the writes of every table replay in log order on a core of their own
+    // and a schema change waits until the writes logged before it are in
+    struct ReplayWrite_t
+    {
+        uint32_t                   group_index;
+        const PacketCollection_t*  p_packet;
+    };
+    std::map<SqlTable_t*, std::vector<ReplayWrite_t>> map_table_write;
+    auto replayTableWrite = [&]()
+    {
+        std::vector<std::pair<SqlTable_t* const, std::vector<ReplayWrite_t>>*> vec_table_write;
+        for (auto& table_write : map_table_write) vec_table_write.emplace_back(&table_write);
+        std::vector<Timestamp_t> vec_commit_ts(vec_table_write.size(), 0);
+        std::atomic<bool> is_failed = false;
+        runParallel(static_cast<uint32_t>(vec_table_write.size()), [&](uint32_t table_index)
+        {
+            // a logged group commits as one transaction again, its versions become visible to the snapshots of the dispatcher below
+            auto& [p_table, vec_write] = *vec_table_write[table_index];
+            SqlTransactionManager_t txn_manager;
+            txn_manager.raiseCommitTs(txn_manager_.getLastCommitTs());
+            std::optional<SqlTransaction_t> opt_txn;
+            uint32_t group_index = 0;
+            for (auto& write : vec_write)
+            {
+                if (opt_txn.has_value() && write.group_index != group_index)
+                {
+                    txn_manager.commit(*opt_txn);
+                    opt_txn.reset();
+                }
+                if (!opt_txn.has_value())
+                {
+                    opt_txn = txn_manager.begin();
+                    group_index = write.group_index;
+                }
+                if (replayWrite(p_table, &*opt_txn, *write.p_packet)) continue;
+
+                is_failed = true;
+                break;
+            }
+            if (opt_txn.has_value()) txn_manager.commit(*opt_txn);
+            vec_commit_ts[table_index] = txn_manager.getLastCommitTs();
+        });
+
+        for (auto commit_ts : vec_commit_ts) txn_manager_.raiseCommitTs(commit_ts);
+        map_table_write.clear();
+        return !is_failed;
+    };
+
+    for (uint32_t group_index = 0; group_index < vec_group.size(); group_index ++)
+    {
+        for (auto& entry : vec_group[group_index])
+        {
+            const std::string* p_table_name = nullptr;
+            if (auto p_insert = std::get_if<PacketInsert_t>(&entry.packet)) p_table_name = &p_insert->table_name;
+            else if (auto p_delect = std::get_if<PacketDelect_t>(&entry.packet)) p_table_name = &p_delect->table_name;
+            else if (auto p_update = std::get_if<PacketUpdate_t>(&entry.packet)) p_table_name = &p_update->table_name;
+            if (p_table_name == nullptr)
+            {
+                if (!replayTableWrite() || !replaySchema(entry)) return false;
+                continue;
+            }
+
+            auto p_db = sql_.getDatabaseByName(entry.db_name);
+            auto p_table = (p_db == nullptr) ? nullptr : p_db->getTableByName(*p_table_name);
+            if (p_table == nullptr)
+            {
+                printf("Fail to replay log: table \"%s\" of database \"%s\" doesn\'t exist\n", p_table_name->c_str(), entry.db_name.c_str());
+                return false;
+            }
+
+            // the checkpoint copied the table after this group, the write is in it already
+            auto it_copied = map_copied_group.find(p_table);
+            if (it_copied != map_copied_group.end() && group_index < it_copied->second) continue;
+
+            // the shards already run every table in parallel, their writes go out in log order
+            if (coordinator_.isEnabled())
+            {
+                if (!replayWrite(p_table, nullptr, entry.packet)) return false;
+                continue;
+            }
+            map_table_write[p_table].emplace_back(ReplayWrite_t{group_index, &entry.packet});
+        }
+    }
+    return replayTableWrite();
+}
+
+bool SqlExecutorDispatcher::replaySchema(const LogEntry_t& entry)
+{
+    if (auto p_create_db = std::get_if<PacketCreateDatabase_t>(&entry.packet))
+    {
+        sql_.restoreDatabase(p_create_db->db_name);
+        return true;
+    }
+    if (auto p_drop_db = std::get_if<PacketDropDatabase_t>(&entry.packet))
+    {
+        auto p_db = sql_.getDatabaseByName(p_drop_db->db_name);
+        if (coordinator_.isEnabled() && p_db != nullptr)
+        {
+            std::vector<SqlTable_t*> vec_table;
+            p_db->getAllTable(vec_table);
+            for (auto p_table : vec_table) coordinator_.dropTable(p_table);
+        }
+        sql_.removeDatabase(p_drop_db->db_name);
+        return true;
+    }
+
+    auto p_db = sql_.getDatabaseByName(entry.db_name);
+    if (p_db == nullptr)
+    {
+        printf("Fail to replay log: database \"%s\" doesn\'t exist\n", entry.db_name.c_str());
+        return false;
+    }
+    if (auto p_create_tb = std::get_if<PacketCreateTable_t>(&entry.packet))
+    {
+        p_db->restoreTable(p_create_tb->table_name, p_create_tb->vec_column_property);
+        return true;
+    }
+    if (auto p_drop_tb = std::get_if<PacketDropTable_t>(&entry.packet))
+    {
+        auto p_table = p_db->getTableByName(p_drop_tb->table_name);
+        if (coordinator_.isEnabled() && p_table != nullptr) coordinator_.dropTable(p_table);
+        p_db->removeTable(p_drop_tb->table_name);
+        return true;
+    }
+
+    printf("Fail to replay log: unexpected statement\n");
+    return false;
+}
+
+bool SqlExecutorDispatcher::replayWrite(SqlTable_t* p_table, SqlTransaction_t* p_txn, const PacketCollection_t& packet)
+{
+    // without shards the statement joins the transaction of its group, with them every statement commits on its own shards
+    uint32_t num_row = 0;
+    if (auto p_insert = std::get_if<PacketInsert_t>(&packet))
+    {
+        if (p_txn != nullptr) return p_table->insertRow(*p_txn, p_insert->vec_value);
+        return coordinator_.insertRow(p_table, p_insert->vec_value);
+    }
+    if (auto p_delect = std::get_if<PacketDelect_t>(&packet))
+    {
+        if (p_txn != nullptr) return p_table->deleteRow(*p_txn, p_delect->condition, num_row);
+        return coordinator_.deleteRow(p_table, p_delect->condition, num_row);
+    }
+    if (auto p_update = std::get_if<PacketUpdate_t>(&packet))
+    {
+        if (p_txn != nullptr) return p_table->updateRow(*p_txn, p_update->vec_assignment, p_update->condition, num_row);
+        return coordinator_.updateRow(p_table, p_update->vec_assignment, p_update->condition, num_row);
+    }
+    return false;
+}
+
+void SqlExecutorDispatcher::getCatalog(CheckpointCatalog_t& catalog)
+{
+    catalog = CheckpointCatalog_t{};
+    catalog.num_partition = coordinator_.isEnabled() ? coordinator_.getShardNum() : 1;
+    sql_.getAllDatabaseName(catalog.vec_db_name);
+
+    std::vector<std::string> vec_tb_name;
+    for (auto& db_name : catalog.vec_db_name)
+    {
+        auto p_db = sql_.getDatabaseByName(db_name);
+        p_db->getAllTableName(vec_tb_name);
+        for (auto& tb_name : vec_tb_name)
+        {
+            catalog.vec_table.emplace_back(CheckpointTable_t{db_name, tb_name, p_db->getTableByName(tb_name)->getProperty(), {}});
+        }
+    }
+}
+
+bool SqlExecutorDispatcher::beginCheckpoint()
+{
+    // no insert is on its way, so every group logged so far is in the old log
+    checkpoint_begin_ns_ = getSteadyNs();
+    if (coordinator_.isEnabled()) coordinator_.waitInsert();
+
+    // the log starts over in the generation of the copy, what the old one holds is durable either way and every statement waiting on it is acknowledged
+    uint64_t generation = log_generation_ + 1;
+    std::vector<std::vector<LogEntry_t>> vec_group;
+    wal_.close();
+    acknowledge(true);
+    if (!wal_.open(data_dir_path_, generation, is_sync_io_, vec_group))
+    {
+        if (!wal_.open(data_dir_path_, log_generation_, is_sync_io_, vec_group)) printf("Fail to reopen log, later commits are not durable\n");
+        return false;
+    }
+    log_generation_ = generation;
+
+    CheckpointCatalog_t catalog;
+    getCatalog(catalog);
+    checkpoint_copy_ns_ = 0;
+    return checkpoint_.begin(std::move(catalog), generation, is_sync_io_);
+}
+
+void SqlExecutorDispatcher::copyCheckpointTable()
+{
+    // the copy of a table holds what every group logged before it wrote, none of the inserts posted to the shards is left out
+    // no schema changed since the checkpoint began, so the table is still there
+    uint64_t begin_ns = getSteadyNs();
+    if (coordinator_.isEnabled()) coordinator_.waitInsert();
+    auto& table = checkpoint_.getNextTable();
+    auto p_table = sql_.getDatabaseByName(table.db_name)->getTableByName(table.tb_name);
+    if (coordinator_.isEnabled()) coordinator_.getPartition(p_table, table.vec_partition);
+    else table.vec_partition.assign(1, p_table);
+    checkpoint_.copyTable(wal_.getGroupNum());
+    checkpoint_copy_ns_ = std::max(checkpoint_copy_ns_, getSteadyNs() - begin_ns);
+}
+
+void SqlExecutorDispatcher::finishCheckpoint(bool is_wait)
+{
+    // a failed checkpoint leaves its log behind the last generation, the next one covers both
+    if (checkpoint_.poll(is_wait) != EnumCheckpointState::WRITTEN) return;
+
+    checkpoint_.removeStale();
+    uint64_t num_byte = checkpoint_.getWriteByte();
+    uint64_t write_ns = getSteadyNs() - checkpoint_begin_ns_;
+    printf("Checkpoint %llu: %llu row(s) of %zu table(s), %.1f MB in %.3f s, %.1f MB/s, a table held for %.3f s at most\n", static_cast<unsigned long long>(checkpoint_.getGeneration()),
+           static_cast<unsigned long long>(checkpoint_.getWriteRow()), checkpoint_.getWriteTableNum(), num_byte / EXEC_MEMORY_MB, write_ns / 1e9,
+           num_byte / EXEC_MEMORY_MB / std::max(write_ns / 1e9, 1e-9), checkpoint_copy_ns_ / 1e9);
+}
+
+bool SqlExecutorDispatcher::runExplained(const EnumExplainType explain, const std::function<bool()>& statement)
+{
+    if (explain == EnumExplainType::IDLE) return statement();
+
+    SqlQueryProfile_t profile(explain == EnumExplainType::ANALYZE);
+    PerfSample_t perf_begin, perf_end;
+    setActiveProfile(&profile);
+    perf_counter_.read(perf_begin);
+    uint64_t begin_ns = getSteadyNs();
+    bool is_done = statement();
+    uint64_t total_ns = getSteadyNs() - begin_ns;
+    perf_counter_.read(perf_end);
+    setActiveProfile(nullptr);
+
+    if (perf_counter_.isOpen()) profile.setPerfSample(perf_end - perf_begin);
+
+    if (is_done) profile.print(total_ns);
+    return is_done;
+}
+
+bool SqlExecutorDispatcher::verifyNoTransaction()
+{
+    // tables are only dropped or created between transactions, so a write set never points at a dropped table
+    if (!opt_txn_.has_value()) return true;
+
+    printf("Failed: schema changes are not allowed inside a transaction\n");
+    return false;
+}
+
+bool SqlExecutorDispatcher::runInTransaction(const std::function<bool(SqlTransaction_t&)>& statement)
+{
+    if (opt_txn_.has_value()) return statement(*opt_txn_);
+
+    // autocommit, a failed statement leaves nothing behind
+    auto txn = txn_manager_.begin();
+    bool is_done = statement(txn);
+    if (is_done) txn_manager_.commit(txn);
+    else txn_manager_.rollback(txn);
+    return is_done;
 }
 
 } // namespace sql::exec
@@ -1,23 +1,62 @@
 #pragma once
 
+#include "atomic"
+#include "deque"
+#include "map"
 #include "memory"
+#include "optional"
 #include "thread"
 #include "pthread.h"
 
 #include "def/sql_interface_def.h"
 #include "common/lock_free_queue.h"
 #include "executor/executor_sql.h"
+#include "executor/executor_shard.h"
+#include "executor/executor_metrics.h"
+#include "executor/executor_profile.h"
+#include "executor/executor_wal.h"
+#include "executor/executor_checkpoint.h"
+
+#define EXEC_DISPATCH_BATCH_NUM     256   // packets drained from the queue at a time, consecutive inserts among them run as one
 
 namespace sql::exec
 {
+
+struct ExecutorOption_t
+{
+    uint32_t     num_shard = 0;               // 0 keeps every table on the dispatcher thread
+    std::string  stats_file_path;             // empty disables the periodic statistics dump
+    uint32_t     stats_interval_sec = EXEC_METRICS_DUMP_INTERVAL_SEC;
+    bool         is_perf_counter = false;      // read hardware counters around every statement
+    uint32_t     memory_limit_mb = 0;          // 0 never rejects an insert
+    std::string  data_dir_path;               // empty keeps the tables in memory only, otherwise committed writes are logged there
+    bool         is_sync_io = false;          // write the log with blocking calls even where io_uring is available
+    uint32_t     checkpoint_log_mb = EXEC_CHECKPOINT_LOG_MB;   // a checkpoint is taken once the log grows past it, 0 only takes one at shutdown
+};
+
+// what a statement owes its client once its log group is durable
+struct PendingAck_t
+{
+    uint64_t                         lsn;
+    std::function<void(bool)>        on_acknowledge;   // false when the log broke before the group was durable
+};
+
 class SqlExecutorDispatcher
 {
 public:
-    bool init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_lfq);
+    ~SqlExecutorDispatcher() { stop(); }
+
+    bool init(std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>& sp_lfq, const ExecutorOption_t& option);
+    void stop();
 
 private:
     bool dispatch(PacketCollection_t& command);
     void runBackend();
+    void runStatement(PacketEnvelope_t& envelope, SqlThreadMetrics_t* p_metrics);
+    void runInsertRun(uint32_t run_begin, uint32_t run_end, SqlThreadMetrics_t* p_metrics);
+    void pollWrite();   // hands back what shards, log and checkpoint finished meanwhile
+    void postInsertRun(uint32_t run_begin, uint32_t run_end, SqlThreadMetrics_t* p_metrics);
+    void logShardInsert(ShardInsert_t& insert);
 
     bool handleCreateDatabase(const PacketCreateDatabase_t& packet);
     bool handleDropDatabase(const PacketDropDatabase_t& packet);
@@ -26,13 +65,67 @@ private:
     bool handleDropTable(const PacketDropTable_t& packet);
     bool handleSelect(const PacketSelect_t& packet);
     bool handleDelete(const PacketDelect_t& packet);
+    bool handleUpdate(const PacketUpdate_t& packet);
     bool handleInsert(const PacketInsert_t& packet);
+    void handleInsertRun(uint32_t run_begin, uint32_t run_end);
+    SqlTable_t* getRunTable(uint32_t run_begin, uint32_t run_end);
+    bool handleTransaction(const PacketTransaction_t& packet);
+    bool handleShow(const PacketShow_t& packet);
+    void printMemory();
+
+    bool runExplained(const EnumExplainType explain, const std::function<bool()>& statement);
+    bool verifyNoTransaction();
+    bool runInTransaction(const std::function<bool(SqlTransaction_t&)>& statement);
+    void logStatement(PacketCollection_t& packet);   // the packet has run, it may be moved from
+    void acknowledge(bool is_final);
+
+    bool recover(const std::string& data_dir_path);
+    bool replayLog(const std::vector<std::vector<LogEntry_t>>& vec_group, const std::map<SqlTable_t*, uint64_t>& map_copied_group);
+    bool replaySchema(const LogEntry_t& entry);
+    bool replayWrite(SqlTable_t* p_table, SqlTransaction_t* p_txn, const PacketCollection_t& packet);
+    void getCatalog(CheckpointCatalog_t& catalog);
+    bool beginCheckpoint();
+    void copyCheckpointTable();
+    void finishCheckpoint(bool is_wait);
+
+    std::atomic<bool>  is_running_ = false;
+    bool               is_perf_counter_ = false;
+    std::thread        th_backend_;
+    std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>  sp_lfq_;
+    SqlThreadMetrics_t*  p_metrics_ = nullptr;   // of the backend thread
 
-    bool          is_running_;
-    std::thread   th_backend_;
-    std::shared_ptr<LockFreeQueue<PacketCollection_t>>  sp_lfq_;
+    // the batch being run, a run of inserts into one table resolves the table once and commits and logs once
+    std::vector<PacketEnvelope_t>                 vec_batch_;
+    std::vector<const std::vector<std::string>*>  vec_p_run_value_;
+    std::vector<uint8_t>                          vec_is_run_inserted_;
 
     SqlSupreme_t  sql_;
+    SqlPerfCounter_t  perf_counter_;   // opened on the backend thread, it counts that thread only
+
+    // the open BEGIN ... COMMIT block, statements outside of one commit on their own
+    SqlTransactionManager_t          txn_manager_;
+    std::optional<SqlTransaction_t>  opt_txn_;
+
+    // sharded mode, the tables in sql_ then only hold the schema and the rows live on the shards
+    // inserts are posted to their owner shards and logged once handed back, every other statement waits for them first
+    SqlShardCoordinator_t            coordinator_;
+
+    // the log of committed writes, a statement that appended a group is acknowledged once the group is durable
+    SqlWriteAheadLog_t               wal_;
+    std::vector<LogEntry_t>          vec_txn_entry_;    // writes of the open transaction, logged as one group at commit
+    std::vector<const PacketCollection_t*>  vec_p_log_packet_;   // writes logged straight from the batch outside a transaction
+    std::deque<PendingAck_t>         deq_pending_ack_;
+    uint64_t                         statement_lsn_ = 0;
+
+    // a checkpoint copies every table and starts the log over, a restart loads the copy and replays the logs written since
+    SqlCheckpoint_t                  checkpoint_;
+    std::string                      data_dir_path_;
+    bool                             is_sync_io_ = false;
+    uint64_t                         log_generation_ = 0;         // of the log appended to, past the checkpoint until its copy is written
+    uint64_t                         checkpoint_log_byte_ = 0;
+    uint64_t                         next_checkpoint_byte_ = 0;   // a failed checkpoint is tried again once the log has grown by as much again
+    uint64_t                         checkpoint_begin_ns_ = 0;
+    uint64_t                         checkpoint_copy_ns_ = 0;     // the longest a table held still for its copy
 };
 
 } // namespace sql::exec
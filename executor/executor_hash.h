@@ -0,0 +1,35 @@
+#pragma once
+
+#include "bit"
+#include "functional"
+
+#include "def/sql_interface_def.h"
+
+namespace sql::exec
+{
+
+// hash shared by the join and aggregation tables, callers take partitions from the high bits and buckets from the low bits
+inline uint64_t hashValue(const SqlValue_t& value)
+{
+    uint64_t hash = 0;
+    if (auto p_int_value = std::get_if<int32_t>(&value)) hash = static_cast<uint32_t>(*p_int_value);
+    else if (auto p_str_value = std::get_if<std::string>(&value)) hash = std::hash<std::string>{}(*p_str_value);
+    else if (auto p_bigint_value = std::get_if<int64_t>(&value)) hash = static_cast<uint64_t>(*p_bigint_value);
+    else if (auto p_double_value = std::get_if<double>(&value)) hash = std::bit_cast<uint64_t>(*p_double_value + 0.0);   // -0.0 hashes like 0.0
+
+    // splitmix64 finalizer
+    hash += 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+// FNV-1a, the log and the checkpoint check what they read back against it
+inline uint64_t getChecksum(const char* p_byte, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t index = 0; index < size; index ++) hash = (hash ^ static_cast<uint8_t>(p_byte[index])) * 0x100000001b3ull;
+    return hash;
+}
+
+} // namespace sql::exec
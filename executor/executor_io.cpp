@@ -0,0 +1,269 @@
+#include "algorithm"
+
+#include "errno.h"
+#include "stdio.h"
+#include "string.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/syscall.h"
+#include "linux/io_uring.h"
+
+#include "executor/executor_io.h"
+
+namespace sql::exec
+{
+
+// the kernel completion of a request carries its index and whether it is the fdatasync half of a linked pair
+static inline uint64_t getUserData(uint32_t request_index, bool is_sync) { return (static_cast<uint64_t>(request_index) << 1) | (is_sync ? 1 : 0); }
+
+static int64_t writeFully(int fd, const char* p_data, uint32_t size, uint64_t offset)
+{
+    uint32_t num_written = 0;
+    while (num_written < size)
+    {
+        auto result = pwrite(fd, p_data + num_written, size - num_written, static_cast<off_t>(offset + num_written));
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) return (result < 0) ? -errno : -EIO;
+        num_written += static_cast<uint32_t>(result);
+    }
+    return num_written;
+}
+
+bool SqlIoRing_t::open(uint32_t queue_depth, const std::vector<iovec>& vec_buffer, bool is_sync_forced)
+{
+    close();
+    queue_depth_ = queue_depth;
+    if (is_sync_forced) return true;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+    if (fd < 0)
+    {
+        printf("Fail to set up io_uring: %s, file I/O runs synchronously\n", strerror(errno));
+        return true;
+    }
+
+    // one mapping holds both rings when the kernel allows it
+    size_t sq_byte = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    size_t cq_byte = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool is_single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    ring_byte_ = is_single_mmap ? std::max(sq_byte, cq_byte) : sq_byte;
+    p_ring_ = mmap(nullptr, ring_byte_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    sqe_byte_ = params.sq_entries * sizeof(io_uring_sqe);
+    p_sqe_ = mmap(nullptr, sqe_byte_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    void* p_cq_ring = is_single_mmap ? p_ring_ : mmap(nullptr, cq_byte, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (p_ring_ == MAP_FAILED || p_sqe_ == MAP_FAILED || p_cq_ring == MAP_FAILED || !is_single_mmap)
+    {
+        // kernels before 5.4 map the rings apart, they are old enough to run synchronously
+        printf("Fail to map io_uring rings, file I/O runs synchronously\n");
+        if (p_cq_ring != MAP_FAILED && p_cq_ring != p_ring_) munmap(p_cq_ring, cq_byte);
+        if (p_sqe_ != MAP_FAILED) munmap(p_sqe_, sqe_byte_);
+        if (p_ring_ != MAP_FAILED) munmap(p_ring_, ring_byte_);
+        p_ring_ = p_sqe_ = nullptr;
+        ::close(fd);
+        return true;
+    }
+
+    auto p_byte = static_cast<char*>(p_ring_);
+    p_sq_tail_ = reinterpret_cast<uint32_t*>(p_byte + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<uint32_t*>(p_byte + params.sq_off.ring_mask);
+    p_sq_array_ = reinterpret_cast<uint32_t*>(p_byte + params.sq_off.array);
+    p_cq_head_ = reinterpret_cast<uint32_t*>(p_byte + params.cq_off.head);
+    p_cq_tail_ = reinterpret_cast<uint32_t*>(p_byte + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<uint32_t*>(p_byte + params.cq_off.ring_mask);
+    p_cqe_ = p_byte + params.cq_off.cqes;
+    ring_fd_ = fd;
+
+    // pinning counts against RLIMIT_MEMLOCK, without it the requests name plain memory instead
+    if (!vec_buffer.empty())
+    {
+        is_buffer_registered_ = syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS, vec_buffer.data(), vec_buffer.size()) == 0;
+        if (!is_buffer_registered_) printf("Fail to register I/O buffers: %s\n", strerror(errno));
+    }
+    return true;
+}
+
+void SqlIoRing_t::close()
+{
+    if (isAsync())
+    {
+        std::vector<IoCompletion_t> vec_completion;
+        while (num_in_flight_ > 0 && enter(0, true)) reapKernel(vec_completion);
+
+        munmap(p_sqe_, sqe_byte_);
+        munmap(p_ring_, ring_byte_);
+        ::close(ring_fd_);
+    }
+    ring_fd_ = -1;
+    is_buffer_registered_ = false;
+    p_ring_ = p_sqe_ = nullptr;
+    vec_request_.clear();
+    vec_free_request_.clear();
+    vec_sync_completion_.clear();
+    num_in_flight_ = 0;
+}
+
+void SqlIoRing_t::getRequest(uint64_t tag, uint32_t size, uint32_t num_pending, bool is_write, uint32_t& request_index)
+{
+    // the completion ring holds two entries per submission slot, so it never overflows below the queue depth
+    if (num_in_flight_ >= queue_depth_) reap(vec_sync_completion_, true);
+
+    if (vec_free_request_.empty())
+    {
+        vec_free_request_.emplace_back(static_cast<uint32_t>(vec_request_.size()));
+        vec_request_.emplace_back();
+    }
+    request_index = vec_free_request_.back();
+    vec_free_request_.pop_back();
+    vec_request_[request_index] = Request_t{tag, 0, size, num_pending, is_write};
+    num_in_flight_ ++;
+}
+
+void SqlIoRing_t::releaseRequest(uint32_t request_index)
+{
+    vec_free_request_.emplace_back(request_index);
+    num_in_flight_ --;
+}
+
+void* SqlIoRing_t::getSubmission()
+{
+    // every submission enters the kernel right away, so the queue is drained before the next one
+    uint32_t tail = *p_sq_tail_;
+    uint32_t index = tail & sq_mask_;
+    auto p_sqe = static_cast<io_uring_sqe*>(p_sqe_) + index;
+    memset(p_sqe, 0, sizeof(io_uring_sqe));
+    p_sq_array_[index] = index;
+    __atomic_store_n(p_sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    return p_sqe;
+}
+
+bool SqlIoRing_t::enter(uint32_t num_submit, bool is_wait)
+{
+    while (true)
+    {
+        auto result = syscall(__NR_io_uring_enter, ring_fd_, num_submit, is_wait ? 1 : 0, is_wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (result >= 0) return true;
+        if (errno == EINTR) continue;
+
+        printf("Fail to enter io_uring: %s\n", strerror(errno));
+        return false;
+    }
+}
+
+bool SqlIoRing_t::submitWrite(int fd, uint32_t buffer_index, const char* p_data, uint32_t size, uint64_t offset, bool is_synced, uint64_t tag)
+{
+    if (!isAsync())
+    {
+        int64_t result = writeFully(fd, p_data, size, offset);
+        if (result >= 0 && is_synced && fdatasync(fd) != 0) result = -errno;
+        vec_sync_completion_.emplace_back(IoCompletion_t{tag, result});
+        return true;
+    }
+
+    uint32_t request_index;
+    getRequest(tag, size, is_synced ? 2 : 1, true, request_index);
+
+    auto p_write = static_cast<io_uring_sqe*>(getSubmission());
+    p_write->opcode = (is_buffer_registered_ && buffer_index != EXEC_IO_BUFFER_NONE) ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    p_write->fd = fd;
+    p_write->addr = reinterpret_cast<uint64_t>(p_data);
+    p_write->len = size;
+    p_write->off = offset;
+    p_write->buf_index = (p_write->opcode == IORING_OP_WRITE_FIXED) ? static_cast<uint16_t>(buffer_index) : 0;
+    p_write->user_data = getUserData(request_index, false);
+
+    // the link holds the fdatasync back until the write is done, and cancels it when the write fails
+    if (is_synced)
+    {
+        p_write->flags |= IOSQE_IO_LINK;
+        auto p_sync = static_cast<io_uring_sqe*>(getSubmission());
+        p_sync->opcode = IORING_OP_FSYNC;
+        p_sync->fd = fd;
+        p_sync->fsync_flags = IORING_FSYNC_DATASYNC;
+        p_sync->user_data = getUserData(request_index, true);
+    }
+    if (enter(is_synced ? 2 : 1, false)) return true;
+
+    releaseRequest(request_index);
+    return false;
+}
+
+bool SqlIoRing_t::submitRead(int fd, char* p_data, uint32_t size, uint64_t offset, uint64_t tag)
+{
+    if (!isAsync())
+    {
+        uint32_t num_read = 0;
+        int64_t result = 0;
+        while (num_read < size)
+        {
+            auto num_byte = pread(fd, p_data + num_read, size - num_read, static_cast<off_t>(offset + num_read));
+            if (num_byte < 0 && errno == EINTR) continue;
+            if (num_byte < 0) result = -errno;
+            if (num_byte <= 0) break;
+            num_read += static_cast<uint32_t>(num_byte);
+        }
+        vec_sync_completion_.emplace_back(IoCompletion_t{tag, (result < 0) ? result : num_read});
+        return true;
+    }
+
+    uint32_t request_index;
+    getRequest(tag, size, 1, false, request_index);
+
+    auto p_read = static_cast<io_uring_sqe*>(getSubmission());
+    p_read->opcode = IORING_OP_READ;
+    p_read->fd = fd;
+    p_read->addr = reinterpret_cast<uint64_t>(p_data);
+    p_read->len = size;
+    p_read->off = offset;
+    p_read->user_data = getUserData(request_index, false);
+    if (enter(1, false)) return true;
+
+    releaseRequest(request_index);
+    return false;
+}
+
+void SqlIoRing_t::reapKernel(std::vector<IoCompletion_t>& vec_completion)
+{
+    uint32_t head = *p_cq_head_;
+    uint32_t tail = __atomic_load_n(p_cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; head ++)
+    {
+        auto& cqe = static_cast<io_uring_cqe*>(p_cqe_)[head & cq_mask_];
+        uint32_t request_index = static_cast<uint32_t>(cqe.user_data >> 1);
+        bool is_sync = (cqe.user_data & 1) != 0;
+        auto& request = vec_request_[request_index];
+
+        // the first failure sticks, a write that fell short of its size counts as one
+        if (request.result >= 0)
+        {
+            if (cqe.res < 0) request.result = cqe.res;
+            else if (!is_sync) request.result = (request.is_write && static_cast<uint32_t>(cqe.res) < request.size) ? -EIO : cqe.res;
+        }
+        if (--request.num_pending > 0) continue;
+
+        vec_completion.emplace_back(IoCompletion_t{request.tag, request.result});
+        releaseRequest(request_index);
+    }
+    __atomic_store_n(p_cq_head_, head, __ATOMIC_RELEASE);
+}
+
+void SqlIoRing_t::reap(std::vector<IoCompletion_t>& vec_completion, bool is_wait)
+{
+    size_t num_completion = vec_completion.size();
+    if (&vec_completion != &vec_sync_completion_)
+    {
+        vec_completion.insert(vec_completion.end(), vec_sync_completion_.begin(), vec_sync_completion_.end());
+        vec_sync_completion_.clear();
+    }
+    if (!isAsync()) return;
+
+    reapKernel(vec_completion);
+    while (is_wait && vec_completion.size() == num_completion && num_in_flight_ > 0)
+    {
+        if (!enter(0, true)) return;
+        reapKernel(vec_completion);
+    }
+}
+
+} // namespace sql::exec
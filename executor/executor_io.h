@@ -0,0 +1,80 @@
+#pragma once
+
+#include "vector"
+#include "stdint.h"
+#include "sys/uio.h"
+
+#define EXEC_IO_QUEUE_DEPTH     64
+#define EXEC_IO_BUFFER_NONE     UINT32_MAX   // a request on memory that is not registered with the ring
+
+namespace sql::exec
+{
+
+// one finished request, result is the byte count or a negative errno
+struct IoCompletion_t
+{
+    uint64_t  tag;
+    int64_t   result;
+};
+
+// asynchronous file I/O on io_uring through the raw system calls, requests are submitted at once and reaped later on
+// without io_uring (or when asked to) every request runs at submit and only its completion is deferred to the next reap
+class SqlIoRing_t
+{
+public:
+    ~SqlIoRing_t() { close(); }
+
+    // the buffers are pinned and mapped by the kernel once, a request on them names one by index and skips that per call
+    bool open(uint32_t queue_depth, const std::vector<iovec>& vec_buffer, bool is_sync_forced);
+    void close();
+    inline bool isAsync() const { return ring_fd_ >= 0; }
+
+    // a write linked to an fdatasync of the file when is_synced, the request completes once both are done
+    bool submitWrite(int fd, uint32_t buffer_index, const char* p_data, uint32_t size, uint64_t offset, bool is_synced, uint64_t tag);
+    bool submitRead(int fd, char* p_data, uint32_t size, uint64_t offset, uint64_t tag);
+
+    // appends the finished requests, blocks until at least one finishes when is_wait and something is in flight
+    void reap(std::vector<IoCompletion_t>& vec_completion, bool is_wait);
+    inline uint32_t getInFlight() const { return num_in_flight_; }
+
+private:
+    // a submitted request, a linked write and fdatasync post one kernel completion each
+    struct Request_t
+    {
+        uint64_t  tag;
+        int64_t   result;
+        uint32_t  size;
+        uint32_t  num_pending;
+        bool      is_write;
+    };
+
+    void getRequest(uint64_t tag, uint32_t size, uint32_t num_pending, bool is_write, uint32_t& request_index);
+    void releaseRequest(uint32_t request_index);
+    void* getSubmission();
+    bool enter(uint32_t num_submit, bool is_wait);
+    void reapKernel(std::vector<IoCompletion_t>& vec_completion);
+
+    int                          ring_fd_ = -1;
+    bool                         is_buffer_registered_ = false;
+
+    // the shared rings, laid out by the kernel
+    void*                        p_ring_ = nullptr;
+    size_t                       ring_byte_ = 0;
+    void*                        p_sqe_ = nullptr;
+    size_t                       sqe_byte_ = 0;
+    uint32_t*                    p_sq_tail_ = nullptr;
+    uint32_t                     sq_mask_ = 0;
+    uint32_t*                    p_sq_array_ = nullptr;
+    uint32_t*                    p_cq_head_ = nullptr;
+    uint32_t*                    p_cq_tail_ = nullptr;
+    uint32_t                     cq_mask_ = 0;
+    void*                        p_cqe_ = nullptr;
+    uint32_t                     queue_depth_ = 0;
+
+    std::vector<Request_t>       vec_request_;
+    std::vector<uint32_t>        vec_free_request_;
+    std::vector<IoCompletion_t>  vec_sync_completion_;   // requests the synchronous fallback already ran
+    uint32_t                     num_in_flight_ = 0;
+};
+
+} // namespace sql::exec
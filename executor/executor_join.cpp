@@ -0,0 +1,116 @@
+#include "executor/executor_join.h"
+#include "executor/executor_hash.h"
+
+#include "bit"
+#include "algorithm"
+
+#define EXEC_JOIN_NO_ENTRY UINT32_MAX
+
+namespace sql::exec
+{
+
+SqlHashJoin_t::SqlHashJoin_t(const SqlColumn_t& build_column, const SqlColumn_t& probe_column)
+    : build_column_(build_column), probe_column_(probe_column)
+{
+}
+
+void SqlHashJoin_t::join(const std::vector<uint32_t>& vec_build_row, const std::vector<uint32_t>& vec_probe_row, const JoinVisitor_t& join_visitor)
+{
+    if (vec_build_row.empty() || vec_probe_row.empty()) return;
+
+    // split both inputs by the top hash bits until one build partition fits in cache
+    size_t build_bytes = vec_build_row.size() * (sizeof(HashEntry_t) + 2 * sizeof(uint32_t));
+    size_t num_partition = std::bit_ceil((build_bytes + EXEC_JOIN_CACHE_SIZE - 1) / EXEC_JOIN_CACHE_SIZE);
+    radix_bits_ = std::min<uint32_t>(std::countr_zero(num_partition), EXEC_JOIN_MAX_RADIX_BITS);
+
+    std::vector<HashRow_t> vec_build_hash_row;
+    std::vector<HashRow_t> vec_probe_hash_row;
+    std::vector<size_t>    vec_build_offset;
+    std::vector<size_t>    vec_probe_offset;
+    partitionRow(build_column_, vec_build_row, vec_build_hash_row, vec_build_offset);
+    partitionRow(probe_column_, vec_probe_row, vec_probe_hash_row, vec_probe_offset);
+
+    for (uint32_t partition = 0; partition < getPartitionNum(); partition ++)
+    {
+        if (vec_build_offset[partition] == vec_build_offset[partition + 1]) continue;
+        if (vec_probe_offset[partition] == vec_probe_offset[partition + 1]) continue;
+
+        buildTable(vec_build_hash_row.data() + vec_build_offset[partition], vec_build_hash_row.data() + vec_build_offset[partition + 1]);
+        probeTable(vec_probe_hash_row.data() + vec_probe_offset[partition], vec_probe_hash_row.data() + vec_probe_offset[partition + 1], join_visitor);
+    }
+}
+
+void SqlHashJoin_t::partitionRow(const SqlColumn_t& column, const std::vector<uint32_t>& vec_row, std::vector<HashRow_t>& vec_hash_row, std::vector<size_t>& vec_partition_offset)
+{
+    std::vector<uint64_t> vec_hash(vec_row.size());
+    SqlValue_t decoded_value;
+    vec_partition_offset.assign(getPartitionNum() + 1, 0);
+    for (size_t index = 0; index < vec_row.size(); index ++)
+    {
+        vec_hash[index] = hashValue(column.getValue(vec_row[index], decoded_value));
+        vec_partition_offset[getPartition(vec_hash[index]) + 1] ++;
+    }
+
+    for (uint32_t partition = 0; partition < getPartitionNum(); partition ++)
+    {
+        vec_partition_offset[partition + 1] += vec_partition_offset[partition];
+    }
+
+    std::vector<size_t> vec_cursor(vec_partition_offset.begin(), vec_partition_offset.end() - 1);
+    vec_hash_row.resize(vec_row.size());
+    for (size_t index = 0; index < vec_row.size(); index ++)
+    {
+        vec_hash_row[vec_cursor[getPartition(vec_hash[index])] ++] = HashRow_t{vec_hash[index], vec_row[index]};
+    }
+}
+
+void SqlHashJoin_t::buildTable(const HashRow_t* p_begin, const HashRow_t* p_end)
+{
+    size_t num_row = p_end - p_begin;
+    size_t num_bucket = std::bit_ceil(std::max<size_t>(num_row * 2, 16));
+    bucket_mask_ = num_bucket - 1;
+
+    vec_bucket_.assign(num_bucket, EXEC_JOIN_NO_ENTRY);
+    vec_entry_.resize(num_row);
+    for (uint32_t index = 0; index < num_row; index ++)
+    {
+        auto& bucket = vec_bucket_[p_begin[index].hash & bucket_mask_];
+        vec_entry_[index] = HashEntry_t{p_begin[index].hash, p_begin[index].row_index, bucket};
+        bucket = index;
+    }
+}
+
+void SqlHashJoin_t::probeTable(const HashRow_t* p_begin, const HashRow_t* p_end, const JoinVisitor_t& join_visitor)
+{
+    uint32_t arr_entry[EXEC_JOIN_PROBE_BATCH];
+    SqlValue_t build_decoded_value, probe_decoded_value;
+    for (auto p_batch = p_begin; p_batch < p_end; p_batch += EXEC_JOIN_PROBE_BATCH)
+    {
+        size_t num_batch = std::min<size_t>(EXEC_JOIN_PROBE_BATCH, p_end - p_batch);
+
+        // stage the batch so the bucket and first entry loads overlap instead of stalling one by one
+        for (size_t index = 0; index < num_batch; index ++)
+        {
+            __builtin_prefetch(&vec_bucket_[p_batch[index].hash & bucket_mask_]);
+        }
+        for (size_t index = 0; index < num_batch; index ++)
+        {
+            arr_entry[index] = vec_bucket_[p_batch[index].hash & bucket_mask_];
+            if (arr_entry[index] != EXEC_JOIN_NO_ENTRY) __builtin_prefetch(&vec_entry_[arr_entry[index]]);
+        }
+        for (size_t index = 0; index < num_batch; index ++)
+        {
+            auto& probe_row = p_batch[index];
+            for (auto entry = arr_entry[index]; entry != EXEC_JOIN_NO_ENTRY; entry = vec_entry_[entry].next)
+            {
+                auto& hash_entry = vec_entry_[entry];
+                if (hash_entry.hash == probe_row.hash && build_column_.getValue(hash_entry.row_index, build_decoded_value) == probe_column_.getValue(probe_row.row_index, probe_decoded_value))
+                {
+                    join_visitor(hash_entry.row_index, probe_row.row_index);
+                }
+            }
+        }
+    }
+}
+
+} // namespace sql::exec
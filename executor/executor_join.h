@@ -0,0 +1,57 @@
+#pragma once
+
+#include "vector"
+#include "functional"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_block.h"
+
+#define EXEC_JOIN_CACHE_SIZE        (256 * 1024)   // target hash table size of one partition, about an L2
+#define EXEC_JOIN_MAX_RADIX_BITS    10
+#define EXEC_JOIN_PROBE_BATCH       16
+
+namespace sql::exec
+{
+
+using JoinVisitor_t = std::function<void(uint32_t build_row, uint32_t probe_row)>;
+
+// equi hash join of two columns, restricted to the given row selections
+class SqlHashJoin_t
+{
+public:
+    SqlHashJoin_t(const SqlColumn_t& build_column, const SqlColumn_t& probe_column);
+
+    void join(const std::vector<uint32_t>& vec_build_row, const std::vector<uint32_t>& vec_probe_row, const JoinVisitor_t& join_visitor);
+
+    inline uint32_t getPartitionNum() const { return 1u << radix_bits_; }
+
+private:
+    struct HashRow_t
+    {
+        uint64_t  hash;
+        uint32_t  row_index;
+    };
+
+    struct HashEntry_t
+    {
+        uint64_t  hash;
+        uint32_t  row_index;
+        uint32_t  next;
+    };
+
+    inline uint32_t getPartition(uint64_t hash) const { return (radix_bits_ == 0) ? 0 : static_cast<uint32_t>(hash >> (64 - radix_bits_)); }
+
+    void partitionRow(const SqlColumn_t& column, const std::vector<uint32_t>& vec_row, std::vector<HashRow_t>& vec_hash_row, std::vector<size_t>& vec_partition_offset);
+    void buildTable(const HashRow_t* p_begin, const HashRow_t* p_end);
+    void probeTable(const HashRow_t* p_begin, const HashRow_t* p_end, const JoinVisitor_t& join_visitor);
+
+    const SqlColumn_t&              build_column_;
+    const SqlColumn_t&              probe_column_;
+    uint32_t                        radix_bits_ = 0;
+
+    std::vector<uint32_t>           vec_bucket_;   // first entry of every bucket chain
+    std::vector<HashEntry_t>        vec_entry_;
+    uint64_t                        bucket_mask_ = 0;
+};
+
+} // namespace sql::exec
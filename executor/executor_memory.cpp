@@ -0,0 +1,65 @@
+#include "string"
+
+#include "executor/executor_memory.h"
+
+namespace sql::exec
+{
+
+uint64_t MemoryUsage_t::getTotal() const
+{
+    uint64_t total_byte = 0;
+    for (auto num_byte : arr_byte) total_byte += num_byte;
+    return total_byte;
+}
+
+MemoryUsage_t& MemoryUsage_t::operator+= (const MemoryUsage_t& usage)
+{
+    for (size_t index = 0; index < arr_byte.size(); index ++) arr_byte[index] += usage.arr_byte[index];
+    return *this;
+}
+
+void MemoryUsage_t::print(FILE* p_file) const
+{
+    fprintf(p_file, "row %.2f MB, string %.2f MB, index %.2f MB, cache %.2f MB, total %.2f MB\n",
+            (*this)[EnumMemoryCategory::ROW] / EXEC_MEMORY_MB, (*this)[EnumMemoryCategory::STRING] / EXEC_MEMORY_MB,
+            (*this)[EnumMemoryCategory::INDEX] / EXEC_MEMORY_MB, (*this)[EnumMemoryCategory::CACHE] / EXEC_MEMORY_MB,
+            getTotal() / EXEC_MEMORY_MB);
+}
+
+uint64_t getHeapByte(const SqlValue_t& value)
+{
+    auto p_string = std::get_if<std::string>(&value);
+    if (p_string == nullptr) return 0;
+
+    // a short string keeps its characters inside the object itself
+    auto p_data = p_string->data();
+    auto p_object = reinterpret_cast<const char*>(p_string);
+    if (p_data >= p_object && p_data < p_object + sizeof(std::string)) return 0;
+    return p_string->capacity() + 1;
+}
+
+SqlMemoryBudget_t& SqlMemoryBudget_t::getInstance()
+{
+    static SqlMemoryBudget_t budget;
+    return budget;
+}
+
+SqlMemoryCharge_t& SqlMemoryCharge_t::operator= (SqlMemoryCharge_t&& charge) noexcept
+{
+    if (this == &charge) return *this;
+
+    update(0);
+    num_byte_ = charge.num_byte_;
+    charge.num_byte_ = 0;
+    return *this;
+}
+
+void SqlMemoryCharge_t::update(uint64_t num_byte)
+{
+    if (num_byte == num_byte_) return;
+
+    SqlMemoryBudget_t::getInstance().update(static_cast<int64_t>(num_byte) - static_cast<int64_t>(num_byte_));
+    num_byte_ = num_byte;
+}
+
+} // namespace sql::exec
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "array"
+#include "atomic"
+#include "stdint.h"
+#include "stdio.h"
+
+#include "def/sql_interface_def.h"
+
+#define EXEC_MEMORY_NO_LIMIT    0
+#define EXEC_MEMORY_MB          (1024.0 * 1024.0)
+
+namespace sql::exec
+{
+
+enum class EnumMemoryCategory
+{
+    ROW       = 0,   // column blocks and version timestamps
+    STRING,          // heap buffers of string values
+    INDEX,           // primary key and radix tree index nodes and their keys
+    CACHE,           // zone maps and bloom filters
+    COUNT,
+};
+
+// bytes held by one table or a sum of tables, by category
+struct MemoryUsage_t
+{
+    std::array<uint64_t, static_cast<size_t>(EnumMemoryCategory::COUNT)>  arr_byte{};
+
+    inline uint64_t& operator[] (EnumMemoryCategory category) { return arr_byte[static_cast<size_t>(category)]; }
+    inline uint64_t operator[] (EnumMemoryCategory category) const { return arr_byte[static_cast<size_t>(category)]; }
+    uint64_t getTotal() const;
+    MemoryUsage_t& operator+= (const MemoryUsage_t& usage);
+    void print(FILE* p_file) const;
+};
+
+// heap bytes behind a value, 0 for numbers and for strings short enough to live inside the object
+uint64_t getHeapByte(const SqlValue_t& value);
+
+// process-wide bytes held by table storage, shards report concurrently so the total is a shared atomic
+class SqlMemoryBudget_t
+{
+public:
+    static SqlMemoryBudget_t& getInstance();
+
+    inline void setLimit(uint64_t limit_byte) { limit_byte_.store(limit_byte, std::memory_order_relaxed); }
+    inline uint64_t getLimit() const { return limit_byte_.load(std::memory_order_relaxed); }
+    inline uint64_t getUsed() const { return used_byte_.load(std::memory_order_relaxed); }
+    inline void update(int64_t delta_byte) { used_byte_.fetch_add(static_cast<uint64_t>(delta_byte), std::memory_order_relaxed); }
+
+    // checked before an insert grows a table, the limit may be passed by what one insert allocates
+    inline bool isExceeded() const
+    {
+        auto limit_byte = getLimit();
+        return limit_byte != EXEC_MEMORY_NO_LIMIT && getUsed() >= limit_byte;
+    }
+
+private:
+    SqlMemoryBudget_t() = default;
+
+    std::atomic<uint64_t>  limit_byte_ = EXEC_MEMORY_NO_LIMIT;
+    std::atomic<uint64_t>  used_byte_ = 0;
+};
+
+// the share of the budget one table has reported, given back when the table goes away
+// a copy starts from nothing and reports its own storage on its first update
+class SqlMemoryCharge_t
+{
+public:
+    SqlMemoryCharge_t() = default;
+    SqlMemoryCharge_t(const SqlMemoryCharge_t&) {}
+    SqlMemoryCharge_t(SqlMemoryCharge_t&& charge) noexcept : num_byte_(charge.num_byte_) { charge.num_byte_ = 0; }
+    SqlMemoryCharge_t& operator= (const SqlMemoryCharge_t&) { return *this; }
+    SqlMemoryCharge_t& operator= (SqlMemoryCharge_t&& charge) noexcept;
+    ~SqlMemoryCharge_t() { update(0); }
+
+    // reports the difference to the last update
+    void update(uint64_t num_byte);
+
+private:
+    uint64_t  num_byte_ = 0;
+};
+
+} // namespace sql::exec
@@ -0,0 +1,228 @@
+#include "chrono"
+#include "algorithm"
+#include "time.h"
+
+#include "executor/executor_metrics.h"
+
+namespace sql::exec
+{
+
+static const char* arr_slot_name[] = {"empty", "create database", "drop database", "create table", "use database", "drop table",
+                                      "select", "delete", "insert", "transaction", "show", "update", "shard task"};
+static_assert(sizeof(arr_slot_name) / sizeof(arr_slot_name[0]) == EXEC_METRICS_SLOT_NUM, "every packet type needs a name");
+
+static thread_local uint64_t cnt_row_touched = 0;
+
+// the owner thread is the only writer, so a relaxed load and store replaces a locked add
+static inline void bumpCounter(std::atomic<uint64_t>& counter, uint64_t delta)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void addRowTouched(uint64_t num_row)
+{
+    cnt_row_touched += num_row;
+}
+
+uint64_t takeRowTouched()
+{
+    uint64_t num_row = cnt_row_touched;
+    cnt_row_touched = 0;
+    return num_row;
+}
+
+uint64_t HistogramSnapshot_t::getPercentile(double percentile) const
+{
+    if (count == 0) return 0;
+
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(percentile * count + 0.5), 1);
+    uint64_t cnt_seen = 0;
+    for (uint32_t bucket = 0; bucket < EXEC_METRICS_BUCKET_NUM; bucket ++)
+    {
+        cnt_seen += arr_bucket[bucket];
+        if (cnt_seen >= rank) return std::min(SqlHistogram_t::getBucketUpperBound(bucket), max_value);
+    }
+    return max_value;
+}
+
+uint32_t SqlHistogram_t::getBucket(uint64_t value)
+{
+    if (value < EXEC_METRICS_SUB_BUCKET_NUM) return static_cast<uint32_t>(value);
+
+    // the top bit picks the power of two, the next bits pick the linear sub bucket inside it
+    uint32_t msb = 63 - __builtin_clzll(value);
+    if (msb > EXEC_METRICS_MAX_BITS) return EXEC_METRICS_BUCKET_NUM - 1;
+    uint32_t shift = msb - EXEC_METRICS_SUB_BUCKET_BITS;
+    return (shift + 1) * EXEC_METRICS_SUB_BUCKET_NUM + static_cast<uint32_t>((value >> shift) & (EXEC_METRICS_SUB_BUCKET_NUM - 1));
+}
+
+uint64_t SqlHistogram_t::getBucketUpperBound(uint32_t bucket)
+{
+    if (bucket < EXEC_METRICS_SUB_BUCKET_NUM) return bucket;
+
+    uint32_t shift = bucket / EXEC_METRICS_SUB_BUCKET_NUM - 1;
+    uint64_t lower = static_cast<uint64_t>(EXEC_METRICS_SUB_BUCKET_NUM + bucket % EXEC_METRICS_SUB_BUCKET_NUM) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+void SqlHistogram_t::record(uint64_t value)
+{
+    bumpCounter(arr_bucket_[getBucket(value)], 1);
+    bumpCounter(count_, 1);
+    if (value > max_value_.load(std::memory_order_relaxed)) max_value_.store(value, std::memory_order_relaxed);
+}
+
+void SqlHistogram_t::addTo(HistogramSnapshot_t& snapshot) const
+{
+    for (uint32_t bucket = 0; bucket < EXEC_METRICS_BUCKET_NUM; bucket ++)
+    {
+        snapshot.arr_bucket[bucket] += arr_bucket_[bucket].load(std::memory_order_relaxed);
+    }
+    snapshot.count += count_.load(std::memory_order_relaxed);
+    snapshot.max_value = std::max(snapshot.max_value, max_value_.load(std::memory_order_relaxed));
+}
+
+void SqlThreadMetrics_t::record(size_t slot, uint64_t wait_ns, uint64_t exec_ns, uint64_t num_row, bool is_done)
+{
+    auto& packet = arr_packet_[slot];
+    bumpCounter(packet.num_packet, 1);
+    if (!is_done) bumpCounter(packet.num_failed, 1);
+    bumpCounter(packet.num_row, num_row);
+    packet.wait_ns.record(wait_ns);
+    packet.exec_ns.record(exec_ns);
+}
+
+void SqlThreadMetrics_t::recordPerf(size_t slot, const PerfSample_t& perf_delta, uint64_t num_statement)
+{
+    auto& packet = arr_packet_[slot];
+    bumpCounter(packet.num_perf_sample, num_statement);
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++) bumpCounter(packet.arr_perf_sum[index], perf_delta.arr_value[index]);
+}
+
+SqlMetricsRegistry_t& SqlMetricsRegistry_t::getInstance()
+{
+    static SqlMetricsRegistry_t registry;
+    return registry;
+}
+
+SqlMetricsRegistry_t::~SqlMetricsRegistry_t()
+{
+    is_dumping_ = false;
+    if (th_dump_.joinable()) th_dump_.join();
+}
+
+SqlThreadMetrics_t* SqlMetricsRegistry_t::registerThread(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mtx_registry_);
+    vec_thread_metrics_.emplace_back(std::make_unique<SqlThreadMetrics_t>(name));
+    return vec_thread_metrics_.back().get();
+}
+
+void SqlMetricsRegistry_t::registerQueue(const std::string& name, std::function<QueueStat_t()>&& queue_stat)
+{
+    std::lock_guard<std::mutex> lock(mtx_registry_);
+    vec_queue_stat_.emplace_back(name, std::move(queue_stat));
+}
+
+void SqlMetricsRegistry_t::print(FILE* p_file)
+{
+    std::lock_guard<std::mutex> lock(mtx_registry_);
+
+    for (auto& p_thread_metrics : vec_thread_metrics_)
+    {
+        fprintf(p_file, "Thread \"%s\"\n", p_thread_metrics->getName().c_str());
+        for (size_t slot = 0; slot < EXEC_METRICS_SLOT_NUM; slot ++)
+        {
+            auto& packet = p_thread_metrics->getPacketMetrics(slot);
+            uint64_t num_packet = packet.num_packet.load(std::memory_order_relaxed);
+            if (num_packet == 0) continue;
+
+            HistogramSnapshot_t wait_ns, exec_ns;
+            packet.wait_ns.addTo(wait_ns);
+            packet.exec_ns.addTo(exec_ns);
+            fprintf(p_file, "  %-16s count %lu, failed %lu, rows %lu, wait us p50 %.1f p99 %.1f max %.1f, exec us p50 %.1f p99 %.1f max %.1f\n",
+                    arr_slot_name[slot], num_packet, packet.num_failed.load(std::memory_order_relaxed), packet.num_row.load(std::memory_order_relaxed),
+                    wait_ns.getPercentile(0.5) / 1e3, wait_ns.getPercentile(0.99) / 1e3, wait_ns.max_value / 1e3,
+                    exec_ns.getPercentile(0.5) / 1e3, exec_ns.getPercentile(0.99) / 1e3, exec_ns.max_value / 1e3);
+
+            uint64_t num_perf_sample = packet.num_perf_sample.load(std::memory_order_relaxed);
+            if (num_perf_sample == 0) continue;
+            PerfSample_t perf_sum;
+            for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++) perf_sum.arr_value[index] = packet.arr_perf_sum[index].load(std::memory_order_relaxed);
+            fprintf(p_file, "  %-16s per packet: ", "");
+            SqlPerfCounter_t::printSample(p_file, perf_sum, num_perf_sample);
+        }
+    }
+
+    for (auto& [name, queue_stat] : vec_queue_stat_)
+    {
+        auto stat = queue_stat();
+        fprintf(p_file, "Queue \"%s\": capacity %u, occupancy %u, high water %u, full %lu\n",
+                name.c_str(), stat.capacity, stat.occupancy, stat.high_water_mark, stat.num_full);
+    }
+}
+
+void SqlMetricsRegistry_t::getPacketSnapshot(size_t slot, PacketSnapshot_t& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mtx_registry_);
+
+    for (auto& p_thread_metrics : vec_thread_metrics_)
+    {
+        auto& packet = p_thread_metrics->getPacketMetrics(slot);
+        snapshot.num_packet += packet.num_packet.load(std::memory_order_relaxed);
+        snapshot.num_failed += packet.num_failed.load(std::memory_order_relaxed);
+        snapshot.num_row += packet.num_row.load(std::memory_order_relaxed);
+        packet.wait_ns.addTo(snapshot.wait_ns);
+        packet.exec_ns.addTo(snapshot.exec_ns);
+    }
+}
+
+const char* SqlMetricsRegistry_t::getSlotName(size_t slot)
+{
+    return arr_slot_name[slot];
+}
+
+bool SqlMetricsRegistry_t::startDump(const std::string& file_path, uint32_t interval_sec)
+{
+    if (is_dumping_)
+    {
+        printf("Fail to dump statistics: already dumping\n");
+        return false;
+    }
+    if (interval_sec == 0)
+    {
+        printf("Fail to dump statistics: the interval must be at least one second\n");
+        return false;
+    }
+
+    is_dumping_ = true;
+    th_dump_ = std::thread(&SqlMetricsRegistry_t::runDump, this, file_path, interval_sec);
+    return true;
+}
+
+void SqlMetricsRegistry_t::runDump(std::string file_path, uint32_t interval_sec)
+{
+    auto next_dump = std::chrono::steady_clock::now() + std::chrono::seconds(interval_sec);
+    while (is_dumping_)
+    {
+        // short naps so the process exits without waiting out the interval
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() < next_dump) continue;
+        next_dump += std::chrono::seconds(interval_sec);
+
+        // written aside and renamed, a reader never sees half a dump
+        std::string tmp_path = file_path + ".tmp";
+        FILE* p_file = fopen(tmp_path.c_str(), "w");
+        if (p_file == nullptr)
+        {
+            printf("Fail to open statistics file \"%s\"\n", tmp_path.c_str());
+            continue;
+        }
+        fprintf(p_file, "Dumped at %ld\n", static_cast<long>(time(nullptr)));
+        print(p_file);
+        fclose(p_file);
+        rename(tmp_path.c_str(), file_path.c_str());
+    }
+}
+
+} // namespace sql::exec
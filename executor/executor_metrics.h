@@ -0,0 +1,133 @@
+#pragma once
+
+#include "array"
+#include "atomic"
+#include "memory"
+#include "mutex"
+#include "string"
+#include "thread"
+#include "vector"
+#include "functional"
+#include "stdio.h"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_perf.h"
+
+#define EXEC_METRICS_SUB_BUCKET_BITS    3    // 8 sub buckets per power of two, a recorded value is off by at most 12.5%
+#define EXEC_METRICS_SUB_BUCKET_NUM     (1u << EXEC_METRICS_SUB_BUCKET_BITS)
+#define EXEC_METRICS_MAX_BITS           40   // about 18 minutes in nanoseconds, larger values share the last bucket
+#define EXEC_METRICS_BUCKET_NUM         ((EXEC_METRICS_MAX_BITS - EXEC_METRICS_SUB_BUCKET_BITS + 2) * EXEC_METRICS_SUB_BUCKET_NUM)
+#define EXEC_METRICS_DUMP_INTERVAL_SEC   10
+#define EXEC_METRICS_SHARD_TASK         std::variant_size_v<PacketCollection_t>   // slot after the packet types
+#define EXEC_METRICS_SLOT_NUM           (EXEC_METRICS_SHARD_TASK + 1)
+
+namespace sql::exec
+{
+
+// the rows a statement returned, inserted or deleted, counted per thread while it runs
+void addRowTouched(uint64_t num_row);
+uint64_t takeRowTouched();
+
+// a plain copy of one or more histograms, used to merge and to read percentiles
+struct HistogramSnapshot_t
+{
+    std::array<uint64_t, EXEC_METRICS_BUCKET_NUM>  arr_bucket{};
+    uint64_t                                       count = 0;
+    uint64_t                                       max_value = 0;
+
+    uint64_t getPercentile(double percentile) const;
+};
+
+// log-linear histogram in the spirit of HdrHistogram, the owner thread is the only writer so no atomic read-modify-write is needed
+class SqlHistogram_t
+{
+public:
+    void record(uint64_t value);
+    void addTo(HistogramSnapshot_t& snapshot) const;
+
+    static uint32_t getBucket(uint64_t value);
+    static uint64_t getBucketUpperBound(uint32_t bucket);
+
+private:
+    std::array<std::atomic<uint64_t>, EXEC_METRICS_BUCKET_NUM>  arr_bucket_{};
+    std::atomic<uint64_t>                                       count_ = 0;
+    std::atomic<uint64_t>                                       max_value_ = 0;
+};
+
+struct PacketMetrics_t
+{
+    std::atomic<uint64_t>  num_packet = 0;
+    std::atomic<uint64_t>  num_failed = 0;
+    std::atomic<uint64_t>  num_row = 0;
+    SqlHistogram_t         wait_ns;   // enqueue to dispatch
+    SqlHistogram_t         exec_ns;
+
+    // hardware counter deltas summed over the packets, only while the counters are open
+    std::atomic<uint64_t>                                       num_perf_sample = 0;
+    std::array<std::atomic<uint64_t>, EXEC_PERF_COUNTER_NUM>    arr_perf_sum{};
+};
+
+// counters of one executor thread, written by that thread only
+class SqlThreadMetrics_t
+{
+public:
+    explicit SqlThreadMetrics_t(const std::string& name) : name_(name) {}
+
+    void record(size_t slot, uint64_t wait_ns, uint64_t exec_ns, uint64_t num_row, bool is_done);
+    void recordPerf(size_t slot, const PerfSample_t& perf_delta, uint64_t num_statement);   // a delta may cover a run of statements
+
+    inline const std::string& getName() const { return name_; }
+    inline const PacketMetrics_t& getPacketMetrics(size_t slot) const { return arr_packet_[slot]; }
+
+private:
+    std::string                                        name_;
+    std::array<PacketMetrics_t, EXEC_METRICS_SLOT_NUM> arr_packet_;
+};
+
+// one slot summed over every thread
+struct PacketSnapshot_t
+{
+    uint64_t             num_packet = 0;
+    uint64_t             num_failed = 0;
+    uint64_t             num_row = 0;
+    HistogramSnapshot_t  wait_ns;
+    HistogramSnapshot_t  exec_ns;
+};
+
+struct QueueStat_t
+{
+    uint32_t  capacity;
+    uint32_t  occupancy;
+    uint32_t  high_water_mark;
+    uint64_t  num_full;   // pushes that found the queue full
+};
+
+// every thread and queue that reports metrics, lives until the process exits
+class SqlMetricsRegistry_t
+{
+public:
+    static SqlMetricsRegistry_t& getInstance();
+    ~SqlMetricsRegistry_t();
+
+    // called on the thread itself, the returned block stays valid for the lifetime of the process
+    SqlThreadMetrics_t* registerThread(const std::string& name);
+    void registerQueue(const std::string& name, std::function<QueueStat_t()>&& queue_stat);
+
+    void print(FILE* p_file);
+    void getPacketSnapshot(size_t slot, PacketSnapshot_t& snapshot);
+    static const char* getSlotName(size_t slot);
+    bool startDump(const std::string& file_path, uint32_t interval_sec);
+
+private:
+    SqlMetricsRegistry_t() = default;
+    void runDump(std::string file_path, uint32_t interval_sec);
+
+    std::mutex                                                  mtx_registry_;
+    std::vector<std::unique_ptr<SqlThreadMetrics_t>>            vec_thread_metrics_;
+    std::vector<std::pair<std::string, std::function<QueueStat_t()>>>  vec_queue_stat_;
+
+    std::atomic<bool>                                           is_dumping_ = false;
+    std::thread                                                 th_dump_;
+};
+
+} // namespace sql::exec
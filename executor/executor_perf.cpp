@@ -0,0 +1,133 @@
+#include "errno.h"
+#include "string.h"
+#include "unistd.h"
+#include "sys/ioctl.h"
+#include "sys/syscall.h"
+#include "linux/perf_event.h"
+
+#include "executor/executor_perf.h"
+
+namespace sql::exec
+{
+
+struct PerfEventDescriptor_t
+{
+    uint32_t     type;
+    uint64_t     config;
+    const char*  name;
+};
+
+static const PerfEventDescriptor_t arr_perf_event[EXEC_PERF_COUNTER_NUM] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,       "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,     "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,     "LLC misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,    "branch misses"},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), "dTLB misses"},
+};
+
+PerfSample_t PerfSample_t::operator- (const PerfSample_t& __o) const
+{
+    PerfSample_t delta;
+    for (size_t index = 0; index < arr_value.size(); index ++) delta.arr_value[index] = arr_value[index] - __o.arr_value[index];
+    return delta;
+}
+
+bool SqlPerfCounter_t::open()
+{
+    if (isOpen()) return true;
+
+    // user space only, which perf_event_paranoid up to 2 still allows without privileges
+    std::array<int, EXEC_PERF_COUNTER_NUM> arr_errno{};
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = arr_perf_event[index].type;
+        attr.config = arr_perf_event[index].config;
+        attr.disabled = (group_fd_ < 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // the first counter granted leads the group, a refused one is left out rather than failing the rest
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd_, 0));
+        if (fd < 0)
+        {
+            arr_errno[index] = errno;
+            continue;
+        }
+        if (group_fd_ < 0) group_fd_ = fd;
+        arr_fd_[index] = fd;
+        arr_group_slot_[index] = static_cast<int>(num_open_ ++);
+    }
+
+    if (!isOpen())
+    {
+        printf("Fail to open hardware counters: %s, statements run uncounted\n", strerror(arr_errno[0]));
+        return false;
+    }
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++)
+    {
+        if (arr_fd_[index] < 0) printf("Fail to open hardware counter \"%s\": %s\n", arr_perf_event[index].name, strerror(arr_errno[index]));
+    }
+
+    ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void SqlPerfCounter_t::close()
+{
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++)
+    {
+        if (arr_fd_[index] >= 0) ::close(arr_fd_[index]);
+        arr_fd_[index] = -1;
+        arr_group_slot_[index] = -1;
+    }
+    group_fd_ = -1;
+    num_open_ = 0;
+}
+
+void SqlPerfCounter_t::read(PerfSample_t& sample) const
+{
+    sample = PerfSample_t{};
+    if (!isOpen()) return;
+
+    // nr, time enabled, time running, then one value per group member
+    uint64_t arr_buffer[3 + EXEC_PERF_COUNTER_NUM];
+    auto num_byte = ::read(group_fd_, arr_buffer, sizeof(arr_buffer));
+    if (num_byte < static_cast<ssize_t>(3 * sizeof(uint64_t))) return;
+
+    // the kernel multiplexes the group when the PMU is shared, scale up to the time it was enabled
+    uint64_t time_enabled = arr_buffer[1];
+    uint64_t time_running = arr_buffer[2];
+    double scale = (time_running > 0 && time_running < time_enabled) ? static_cast<double>(time_enabled) / time_running : 1.0;
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++)
+    {
+        int slot = arr_group_slot_[index];
+        if (slot < 0 || static_cast<uint64_t>(slot) >= arr_buffer[0]) continue;
+        sample.arr_value[index] = static_cast<uint64_t>(arr_buffer[3 + slot] * scale);
+    }
+}
+
+const char* SqlPerfCounter_t::getCounterName(size_t index)
+{
+    return arr_perf_event[index].name;
+}
+
+void SqlPerfCounter_t::printSample(FILE* p_file, const PerfSample_t& sample, uint64_t num_statement)
+{
+    if (num_statement == 0) return;
+
+    for (size_t index = 0; index < EXEC_PERF_COUNTER_NUM; index ++)
+    {
+        fprintf(p_file, (index == 0) ? "%s %.0f" : ", %s %.0f", getCounterName(index), static_cast<double>(sample.arr_value[index]) / num_statement);
+    }
+
+    uint64_t num_cycle = sample.get(EnumPerfCounterType::CYCLES);
+    if (num_cycle > 0) fprintf(p_file, ", IPC %.2f", static_cast<double>(sample.get(EnumPerfCounterType::INSTRUCTIONS)) / num_cycle);
+    fprintf(p_file, "\n");
+}
+
+} // namespace sql::exec
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "array"
+#include "stdint.h"
+#include "stdio.h"
+
+#define EXEC_PERF_COUNTER_NUM   5
+
+namespace sql::exec
+{
+
+enum class EnumPerfCounterType
+{
+    CYCLES        = 0,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    DTLB_MISSES,
+};
+
+// one reading of every counter, counters the kernel refused stay 0
+struct PerfSample_t
+{
+    std::array<uint64_t, EXEC_PERF_COUNTER_NUM>  arr_value{};
+
+    inline uint64_t get(const EnumPerfCounterType type) const { return arr_value[static_cast<size_t>(type)]; }
+    PerfSample_t operator- (const PerfSample_t& __o) const;
+};
+
+// hardware counters of the calling thread, user space only, read as one perf_event_open group
+class SqlPerfCounter_t
+{
+public:
+    ~SqlPerfCounter_t() { close(); }
+
+    // false when the kernel grants none of the counters, the engine then runs without them
+    bool open();
+    void close();
+    inline bool isOpen() const { return group_fd_ >= 0; }
+
+    void read(PerfSample_t& sample) const;
+
+    static const char* getCounterName(size_t index);
+    static void printSample(FILE* p_file, const PerfSample_t& sample, uint64_t num_statement);
+
+private:
+    int                                      group_fd_ = -1;
+    std::array<int, EXEC_PERF_COUNTER_NUM>   arr_fd_ = {-1, -1, -1, -1, -1};
+    std::array<int, EXEC_PERF_COUNTER_NUM>   arr_group_slot_ = {-1, -1, -1, -1, -1};   // position of the counter in a group read
+    uint32_t                                 num_open_ = 0;
+};
+
+} // namespace sql::exec
@@ -0,0 +1,109 @@
+#include "stdio.h"
+
+#include "executor/executor_profile.h"
+
+namespace sql::exec
+{
+
+static const char* arr_stage_name[] = {"output", "modify", "gather", "join", "aggregate", "access", "visibility", "filter"};
+static_assert(sizeof(arr_stage_name) / sizeof(arr_stage_name[0]) == static_cast<size_t>(EnumQueryStage::COUNT), "every stage needs a name");
+
+static thread_local SqlQueryProfile_t* p_active_profile = nullptr;
+
+SqlQueryProfile_t* getActiveProfile()
+{
+    return p_active_profile;
+}
+
+void setActiveProfile(SqlQueryProfile_t* p_profile)
+{
+    p_active_profile = p_profile;
+}
+
+void SqlQueryProfile_t::describeStage(const EnumQueryStage stage, const std::string& detail)
+{
+    auto& stage_profile = getStage(stage);
+    stage_profile.is_used = true;
+    if (detail.empty() || stage_profile.detail.find(detail) != std::string::npos) return;
+
+    if (!stage_profile.detail.empty()) stage_profile.detail.append("; ");
+    stage_profile.detail.append(detail);
+}
+
+void SqlQueryProfile_t::enterStage(const EnumQueryStage stage)
+{
+    uint64_t now_ns = getSteadyNs();
+    if (!vec_stage_stack_.empty()) getStage(vec_stage_stack_.back()).time_ns += now_ns - mark_ns_;
+    vec_stage_stack_.emplace_back(stage);
+    getStage(stage).is_used = true;
+    mark_ns_ = now_ns;
+}
+
+void SqlQueryProfile_t::leaveStage()
+{
+    uint64_t now_ns = getSteadyNs();
+    getStage(vec_stage_stack_.back()).time_ns += now_ns - mark_ns_;
+    vec_stage_stack_.pop_back();
+    mark_ns_ = now_ns;
+}
+
+void SqlQueryProfile_t::mergeShard(const SqlQueryProfile_t& shard_profile)
+{
+    num_shard_ ++;
+    for (size_t index = 0; index < arr_shard_stage_.size(); index ++)
+    {
+        auto& merged = arr_shard_stage_[index];
+        auto& shard = shard_profile.arr_stage_[index];
+        if (!shard.is_used) continue;
+
+        // every shard runs the same plan, so the first one describes it
+        if (!merged.is_used) merged.detail = shard.detail;
+        merged.is_used = true;
+        merged.num_row_in += shard.num_row_in;
+        merged.num_row_out += shard.num_row_out;
+        merged.time_ns += shard.time_ns;
+        merged.num_block += shard.num_block;
+        merged.num_block_zone_skipped += shard.num_block_zone_skipped;
+        merged.num_block_bloom_skipped += shard.num_block_bloom_skipped;
+        merged.num_byte += shard.num_byte;
+    }
+}
+
+void SqlQueryProfile_t::print(uint64_t total_ns)
+{
+    printf("Plan:\n");
+    printStage(arr_stage_, is_analyze_);
+    if (num_shard_ > 0)
+    {
+        printf("Plan on the shards, %s over %u shard(s):\n", is_analyze_ ? "summed" : "run", num_shard_);
+        printStage(arr_shard_stage_, is_analyze_);
+    }
+    if (is_analyze_) printf("Total time %.3f ms\n", total_ns / 1e6);
+    if (is_analyze_ && has_perf_sample_)
+    {
+        printf("Hardware counters%s: ", (num_shard_ > 0) ? " of the dispatcher thread" : "");
+        SqlPerfCounter_t::printSample(stdout, perf_sample_, 1);
+    }
+}
+
+void SqlQueryProfile_t::printStage(const std::array<StageProfile_t, static_cast<size_t>(EnumQueryStage::COUNT)>& arr_stage, bool is_analyze)
+{
+    for (size_t index = 0; index < arr_stage.size(); index ++)
+    {
+        auto& stage = arr_stage[index];
+        if (!stage.is_used) continue;
+
+        printf("  %-11s %s\n", arr_stage_name[index], stage.detail.c_str());
+        if (!is_analyze) continue;
+
+        printf("              rows in %lu, out %lu, time %.3f ms, bytes %lu", stage.num_row_in, stage.num_row_out, stage.time_ns / 1e6, stage.num_byte);
+        if (stage.num_block > 0)
+        {
+            printf(", blocks %lu, skipped %lu (zone map %lu, bloom %lu)", stage.num_block, stage.num_block_zone_skipped + stage.num_block_bloom_skipped,
+                   stage.num_block_zone_skipped, stage.num_block_bloom_skipped);
+        }
+        printf("\n");
+    }
+}
+
+} // namespace sql::exec
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "array"
+#include "string"
+#include "vector"
+#include "stdint.h"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_perf.h"
+
+namespace sql::exec
+{
+
+// stages of a statement, listed from the one that produces the result down to the one that reads the columns
+enum class EnumQueryStage
+{
+    OUTPUT    = 0,
+    MODIFY,
+    GATHER,
+    JOIN,
+    AGGREGATE,
+    ACCESS,
+    VISIBILITY,
+    FILTER,
+    COUNT,
+};
+
+struct StageProfile_t
+{
+    std::string  detail;                       // what EXPLAIN prints for the stage
+    bool         is_used = false;
+    uint64_t     num_row_in = 0;
+    uint64_t     num_row_out = 0;
+    uint64_t     time_ns = 0;                  // excluding the stages it calls into
+    uint64_t     num_block = 0;
+    uint64_t     num_block_zone_skipped = 0;
+    uint64_t     num_block_bloom_skipped = 0;
+    uint64_t     num_byte = 0;                 // bytes of column values and version timestamps read
+};
+
+// what EXPLAIN collects about one statement, only the thread running the statement touches it
+class SqlQueryProfile_t
+{
+public:
+    explicit SqlQueryProfile_t(bool is_analyze) : is_analyze_(is_analyze) {}
+
+    inline bool isAnalyze() const { return is_analyze_; }
+    inline StageProfile_t& getStage(const EnumQueryStage stage) { return arr_stage_[static_cast<size_t>(stage)]; }
+
+    // the same detail may be reported by several tables of a statement, it is only listed once
+    void describeStage(const EnumQueryStage stage, const std::string& detail);
+
+    // time is charged to the innermost entered stage, so nested stages do not count twice
+    void enterStage(const EnumQueryStage stage);
+    void leaveStage();
+
+    void mergeShard(const SqlQueryProfile_t& shard_profile);
+    inline void setPerfSample(const PerfSample_t& perf_sample) { has_perf_sample_ = true; perf_sample_ = perf_sample; }
+    void print(uint64_t total_ns);
+
+private:
+    static void printStage(const std::array<StageProfile_t, static_cast<size_t>(EnumQueryStage::COUNT)>& arr_stage, bool is_analyze);
+
+    bool                                                                 is_analyze_;
+    std::array<StageProfile_t, static_cast<size_t>(EnumQueryStage::COUNT)>  arr_stage_;
+    std::vector<EnumQueryStage>                                          vec_stage_stack_;
+    uint64_t                                                             mark_ns_ = 0;
+
+    // hardware counters of the thread that ran the statement, shards not included
+    bool                                                                 has_perf_sample_ = false;
+    PerfSample_t                                                         perf_sample_;
+
+    // stages that ran on the shards, summed over every shard
+    uint32_t                                                             num_shard_ = 0;
+    std::array<StageProfile_t, static_cast<size_t>(EnumQueryStage::COUNT)>  arr_shard_stage_;
+};
+
+// the profile of the statement running on this thread, nullptr unless it is explained
+SqlQueryProfile_t* getActiveProfile();
+void setActiveProfile(SqlQueryProfile_t* p_profile);
+
+// EXPLAIN without ANALYZE, the statement is planned and stops before it reads a row
+inline bool isPlanOnly()
+{
+    auto p_profile = getActiveProfile();
+    return p_profile != nullptr && !p_profile->isAnalyze();
+}
+
+// enters the stage for the lifetime of the guard, does nothing when no statement is analyzed
+class ProfileStageGuard_t
+{
+public:
+    ProfileStageGuard_t(SqlQueryProfile_t* p_profile, const EnumQueryStage stage)
+        : p_profile_((p_profile != nullptr && p_profile->isAnalyze()) ? p_profile : nullptr)
+    {
+        if (p_profile_ != nullptr) p_profile_->enterStage(stage);
+    }
+    ~ProfileStageGuard_t()
+    {
+        if (p_profile_ != nullptr) p_profile_->leaveStage();
+    }
+
+private:
+    SqlQueryProfile_t*  p_profile_;
+};
+
+} // namespace sql::exec
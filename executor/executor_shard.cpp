@@ -0,0 +1,583 @@
+#include "pthread.h"
+#include "numeric"
+#include "algorithm"
+
+#include "executor/executor_shard.h"
+#include "executor/executor_profile.h"
+#include "trace/sql_span.h"
+
+namespace sql::exec
+{
+
+// gathered rows are committed before every snapshot
+static const Snapshot_t gathered_snapshot = Snapshot_t{0, EXEC_TS_TXN_FLAG};
+
+bool SqlExecutorShard_t::start(uint32_t shard_index, bool is_perf_counter)
+{
+    shard_index_ = shard_index;
+    is_perf_counter_ = is_perf_counter;
+    auto sp_lfq = sp_lfq_;
+    SqlMetricsRegistry_t::getInstance().registerQueue("shard " + std::to_string(shard_index), [sp_lfq]()
+    {
+        return QueueStat_t{sp_lfq->getSize(), sp_lfq->getOccupancy(), sp_lfq->getHighWaterMark(), sp_lfq->getFullCount()};
+    });
+
+    is_running_ = true;
+    th_backend_ = std::thread(&SqlExecutorShard_t::runBackend, this);
+
+    // one shard per core, its partitions stay in that core's caches
+    auto num_hardware = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(shard_index % num_hardware, &cpu_set);
+    if (pthread_setaffinity_np(th_backend_.native_handle(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+        printf("Fail to pin shard %u to a core\n", shard_index);
+    }
+    return true;
+}
+
+void SqlExecutorShard_t::stop()
+{
+    if (!th_backend_.joinable()) return;
+
+    is_running_ = false;
+    th_backend_.join();
+}
+
+void SqlExecutorShard_t::post(ShardTask_t&& task)
+{
+    ShardEnvelope_t envelope{std::move(task), getSteadyNs()};
+    trace::SpanGuard_t span("post", "shard", envelope.enqueue_ns, trace::EnumSpanFlowType::START);
+    while (!sp_lfq_->push(std::move(envelope))) std::this_thread::yield();
+}
+
+SqlTable_t& SqlExecutorShard_t::getPartition(const SqlTable_t* p_table)
+{
+    auto iter_partition = map_partition_.find(p_table);
+    if (iter_partition != map_partition_.end()) return iter_partition->second;
+
+    // created on first use, the schema in the catalog never changes after the table is created
+    auto& partition = map_partition_[p_table];
+    partition.setProperty(p_table->getProperty());
+    return partition;
+}
+
+void SqlExecutorShard_t::dropPartition(const SqlTable_t* p_table)
+{
+    map_partition_.erase(p_table);
+}
+
+Snapshot_t SqlExecutorShard_t::getSnapshot() const
+{
+    return opt_txn_.has_value() ? opt_txn_->snapshot : txn_manager_.getSnapshot();
+}
+
+bool SqlExecutorShard_t::runInTransaction(const std::function<bool(SqlTransaction_t&)>& statement)
+{
+    if (opt_txn_.has_value()) return statement(*opt_txn_);
+
+    auto txn = txn_manager_.begin();
+    bool is_done = statement(txn);
+    if (is_done) txn_manager_.commit(txn);
+    else txn_manager_.rollback(txn);
+    return is_done;
+}
+
+void SqlExecutorShard_t::handleTransaction(const EnumTransactionActionType action)
+{
+    // the dispatcher has already checked the action against its own transaction state
+    switch (action)
+    {
+        case EnumTransactionActionType::BEGIN:
+            opt_txn_ = txn_manager_.begin();
+            break;
+        case EnumTransactionActionType::COMMIT:
+            if (opt_txn_.has_value()) txn_manager_.commit(*opt_txn_);
+            opt_txn_.reset();
+            break;
+        case EnumTransactionActionType::ROLLBACK:
+            if (opt_txn_.has_value()) txn_manager_.rollback(*opt_txn_);
+            opt_txn_.reset();
+            break;
+        default:
+            break;
+    }
+}
+
+bool SqlExecutorShard_t::prepareStatement(const std::function<bool(SqlTransaction_t&)>& statement)
+{
+    if (opt_txn_.has_value())
+    {
+        num_statement_write_ = opt_txn_->vec_write.size();
+        num_statement_undo_ = opt_txn_->vec_undo.size();
+        return statement(*opt_txn_);
+    }
+
+    opt_statement_txn_ = txn_manager_.begin();
+    return statement(*opt_statement_txn_);
+}
+
+void SqlExecutorShard_t::finishStatement(bool is_commit)
+{
+    // inside a transaction only the statement is undone, the transaction itself is settled by COMMIT or ROLLBACK
+    if (opt_statement_txn_.has_value())
+    {
+        if (is_commit) txn_manager_.commit(*opt_statement_txn_);
+        else txn_manager_.rollback(*opt_statement_txn_);
+        opt_statement_txn_.reset();
+    }
+    else if (!is_commit && opt_txn_.has_value())
+    {
+        txn_manager_.rollbackStatement(*opt_txn_, num_statement_write_, num_statement_undo_);
+    }
+}
+
+void SqlExecutorShard_t::finishInsert(ShardInsert_t&& insert)
+{
+    // never full, the coordinator keeps fewer batches on a shard than the queue holds
+    while (!done_lfq_.push(std::move(insert))) std::this_thread::yield();
+}
+
+void SqlExecutorShard_t::runBackend()
+{
+    auto p_metrics = SqlMetricsRegistry_t::getInstance().registerThread("shard " + std::to_string(shard_index_));
+    trace::SqlSpanTracer_t::getInstance().nameThread("shard " + std::to_string(shard_index_));
+    SqlPerfCounter_t perf_counter;
+    if (is_perf_counter_) perf_counter.open();
+
+    ShardEnvelope_t envelope;
+    PerfSample_t perf_begin, perf_end;
+    while (is_running_)
+    {
+        if (!sp_lfq_->pop(envelope))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint64_t run_ns = getSteadyNs();
+        if (trace::SqlSpanTracer_t::isTracing())
+        {
+            trace::SqlSpanTracer_t::getInstance().record(trace::Span_t{"shard queue wait", "shard", envelope.enqueue_ns, run_ns,
+                                                                       envelope.enqueue_ns, trace::EnumSpanFlowType::FINISH});
+        }
+
+        takeRowTouched();
+        perf_counter.read(perf_begin);
+        {
+            trace::SpanGuard_t span("shard task", "shard");
+            envelope.task(*this);
+            envelope.task = nullptr;
+        }
+        perf_counter.read(perf_end);
+        p_metrics->record(EXEC_METRICS_SHARD_TASK, run_ns - envelope.enqueue_ns, getSteadyNs() - run_ns, takeRowTouched(), true);
+        if (perf_counter.isOpen()) p_metrics->recordPerf(EXEC_METRICS_SHARD_TASK, perf_end - perf_begin, 1);
+    }
+}
+
+bool SqlShardCoordinator_t::init(uint32_t num_shard, bool is_perf_counter, ShardInsertHandler_t&& on_insert)
+{
+    if (num_shard > EXEC_SHARD_MAX_NUM)
+    {
+        printf("Fail to start shards: at most %d shards are supported\n", EXEC_SHARD_MAX_NUM);
+        return false;
+    }
+
+    for (uint32_t shard_index = 0; shard_index < num_shard; shard_index ++)
+    {
+        vec_shard_.emplace_back(std::make_unique<SqlExecutorShard_t>());
+        if (!vec_shard_.back()->start(shard_index, is_perf_counter)) return false;
+    }
+    on_insert_ = std::move(on_insert);
+    vec_shard_insert_.resize(num_shard);
+    vec_num_insert_.assign(num_shard, 0);
+    return true;
+}
+
+uint32_t SqlShardCoordinator_t::getRowShard(SqlTable_t* p_table, const std::vector<std::string>& vec_value)
+{
+    // a row that cannot be routed is sent to shard 0, which reports why it is invalid
+    auto& vec_property = p_table->getProperty();
+    auto primary_column_index = p_table->getPrimaryColumnIndex();
+    SqlValue_t primary_key;
+    if (vec_value.size() == vec_property.size() && convertValue(vec_value[primary_column_index], vec_property[primary_column_index].value_type, primary_key))
+    {
+        return getShardIndex(primary_key, static_cast<uint32_t>(vec_shard_.size()));
+    }
+    return 0;
+}
+
+bool SqlShardCoordinator_t::insertRow(SqlTable_t* p_table, const std::vector<std::string>& vec_value)
+{
+    bool is_inserted = false;
+    runOnShard(getRowShard(p_table, vec_value), [&](SqlExecutorShard_t& shard, uint32_t)
+    {
+        auto& partition = shard.getPartition(p_table);
+        is_inserted = shard.runInTransaction([&](SqlTransaction_t& txn)
+        {
+            return partition.insertRow(txn, vec_value);
+        });
+        if (is_inserted) addRowTouched(1);
+    });
+    return is_inserted;
+}
+
+void SqlShardCoordinator_t::postInsert(SqlTable_t* p_table, std::vector<PacketEnvelope_t>& vec_envelope, uint32_t run_begin, uint32_t run_end, uint64_t dispatch_ns)
+{
+    for (uint32_t index = run_begin; index < run_end; index ++)
+    {
+        auto& packet = std::get<PacketInsert_t>(vec_envelope[index].packet);
+        vec_shard_insert_[getRowShard(p_table, packet.vec_value)].vec_envelope.emplace_back(std::move(vec_envelope[index]));
+    }
+
+    for (uint32_t shard_index = 0; shard_index < vec_shard_.size(); shard_index ++)
+    {
+        auto& shard_insert = vec_shard_insert_[shard_index];
+        if (shard_insert.vec_envelope.empty()) continue;
+
+        // a shard far behind is waited for, its batches handed back meanwhile so it is never stuck on a full done queue
+        while (vec_num_insert_[shard_index] >= EXEC_SHARD_INSERT_NUM)
+        {
+            pollInsert();
+            std::this_thread::yield();
+        }
+
+        shard_insert.dispatch_ns = dispatch_ns;
+        vec_shard_[shard_index]->post([p_table, insert = std::move(shard_insert)](SqlExecutorShard_t& shard) mutable
+        {
+            std::vector<const std::vector<std::string>*> vec_p_row;
+            vec_p_row.reserve(insert.vec_envelope.size());
+            for (auto& envelope : insert.vec_envelope) vec_p_row.emplace_back(&std::get<PacketInsert_t>(envelope.packet).vec_value);
+
+            // a rejected row leaves nothing behind, so the rows of a batch share one transaction
+            auto& partition = shard.getPartition(p_table);
+            shard.runInTransaction([&](SqlTransaction_t& txn)
+            {
+                partition.insertRows(txn, vec_p_row, insert.vec_is_inserted);
+                return true;
+            });
+            addRowTouched(std::count_if(insert.vec_is_inserted.begin(), insert.vec_is_inserted.end(), [](uint8_t is_inserted) { return is_inserted != 0; }));
+            shard.finishInsert(std::move(insert));
+        });
+        shard_insert = ShardInsert_t();
+        vec_num_insert_[shard_index] ++;
+        num_insert_ ++;
+    }
+}
+
+void SqlShardCoordinator_t::pollInsert()
+{
+    ShardInsert_t insert;
+    for (uint32_t shard_index = 0; num_insert_ > 0 && shard_index < vec_shard_.size(); shard_index ++)
+    {
+        while (vec_num_insert_[shard_index] > 0 && vec_shard_[shard_index]->popInsert(insert))
+        {
+            vec_num_insert_[shard_index] --;
+            num_insert_ --;
+            on_insert_(insert);
+        }
+    }
+}
+
+void SqlShardCoordinator_t::waitInsert()
+{
+    while (true)
+    {
+        pollInsert();
+        if (num_insert_ == 0) return;
+        std::this_thread::yield();
+    }
+}
+
+bool SqlShardCoordinator_t::deleteRow(SqlTable_t* p_table, const ConditionDescriptor_t& condition, uint32_t& num_deleted)
+{
+    std::vector<uint32_t> vec_num_deleted(vec_shard_.size(), 0);
+    bool is_deleted = runWrite(getTargetShard(p_table, condition), [&](SqlExecutorShard_t& shard, uint32_t shard_index, SqlTransaction_t& txn)
+    {
+        // the task of every shard counts the rows it touched itself, the metrics of a thread are its own
+        bool is_done = shard.getPartition(p_table).deleteRow(txn, condition, vec_num_deleted[shard_index]);
+        addRowTouched(vec_num_deleted[shard_index]);
+        return is_done;
+    });
+
+    num_deleted = is_deleted ? std::accumulate(vec_num_deleted.begin(), vec_num_deleted.end(), 0u) : 0;
+    return is_deleted;
+}
+
+bool SqlShardCoordinator_t::updateRow(SqlTable_t* p_table, const std::vector<AssignmentDescriptor_t>& vec_assignment, const ConditionDescriptor_t& condition, uint32_t& num_updated)
+{
+    // a row lives on the shard its primary key hashes to, a new key would have to move it
+    auto& primary_property = p_table->getProperty()[p_table->getPrimaryColumnIndex()];
+    for (auto& assignment : vec_assignment)
+    {
+        if (assignment.column_name != primary_property.column_name) continue;
+        printf("Fail to update: primary key \"%s\" of a sharded table can\'t be assigned\n", assignment.column_name.c_str());
+        return false;
+    }
+
+    std::vector<uint32_t> vec_num_updated(vec_shard_.size(), 0);
+    bool is_updated = runWrite(getTargetShard(p_table, condition), [&](SqlExecutorShard_t& shard, uint32_t shard_index, SqlTransaction_t& txn)
+    {
+        bool is_done = shard.getPartition(p_table).updateRow(txn, vec_assignment, condition, vec_num_updated[shard_index]);
+        addRowTouched(vec_num_updated[shard_index]);
+        return is_done;
+    });
+
+    num_updated = is_updated ? std::accumulate(vec_num_updated.begin(), vec_num_updated.end(), 0u) : 0;
+    return is_updated;
+}
+
+bool SqlShardCoordinator_t::selectData(SqlTable_t* p_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, const LimitDescriptor_t& limit)
+{
+    std::vector<bool> vec_is_wanted;
+    p_table->getWantedColumn(vec_projection, order, vec_is_wanted);
+
+    // every shard sends at most offset + count rows, already in order
+    size_t row_quota = (limit.is_limited) ? static_cast<size_t>(limit.offset) + limit.count : SIZE_MAX;
+    SqlTable_t gathered_table;
+    bool is_gathered;
+    gatherRow(p_table, getTargetShard(p_table, condition), vec_is_wanted, condition, order, row_quota, gathered_table, is_gathered);
+
+    // the merge is the ordinary select over the gathered rows, a failed gather reruns it with the condition to report the error
+    return gathered_table.selectData(gathered_snapshot, vec_projection, is_gathered ? ConditionDescriptor_t{} : condition, order, limit);
+}
+
+bool SqlShardCoordinator_t::selectJoinData(const std::string& table_name, SqlTable_t* p_table, SqlTable_t* p_join_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition)
+{
+    // a self join is refused by the join itself, there is nothing to gather for it
+    SqlTable_t arr_gathered_table[2];
+    if (p_table == p_join_table) return arr_gathered_table[0].selectJoinData(gathered_snapshot, table_name, arr_gathered_table[0], vec_projection, join, condition);
+
+    // rows with equal join keys live on different shards, so both inputs are gathered and joined here
+    SqlTable_t* arr_table[2] = {p_table, p_join_table};
+    std::vector<bool> arr_vec_is_wanted[2];
+    p_table->getJoinWantedColumn(table_name, *p_join_table, vec_projection, join, arr_vec_is_wanted[0], arr_vec_is_wanted[1]);
+
+    // the shards filter the side the WHERE condition names, a condition they cannot take is left to the join to report
+    uint32_t condition_side;
+    ConditionDescriptor_t side_condition;
+    bool is_pushed = p_table->getJoinCondition(table_name, *p_join_table, join, condition, condition_side, side_condition);
+    for (uint32_t side = 0; side < 2; side ++)
+    {
+        bool is_gathered;
+        bool is_filtered = is_pushed && side == condition_side;
+        gatherRow(arr_table[side], EXEC_SHARD_ALL, arr_vec_is_wanted[side], is_filtered ? side_condition : ConditionDescriptor_t{}, OrderDescriptor_t{}, SIZE_MAX, arr_gathered_table[side], is_gathered);
+        is_pushed = is_pushed && is_gathered;
+    }
+
+    return arr_gathered_table[0].selectJoinData(gathered_snapshot, table_name, arr_gathered_table[1], vec_projection, join, is_pushed ? ConditionDescriptor_t{} : condition);
+}
+
+bool SqlShardCoordinator_t::selectGroupData(SqlTable_t* p_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const std::string& group_column_name)
+{
+    SqlTable_t::AggregatePlan_t plan;
+    if (!p_table->getAggregatePlan(vec_projection, group_column_name, plan)) return false;
+
+    // every shard aggregates its own partition
+    std::vector<std::vector<SqlGroupTable_t>> vec_shard_group_table(vec_shard_.size());
+    std::vector<uint8_t>                      vec_is_done(vec_shard_.size(), true);
+    runOnShard(getTargetShard(p_table, condition), [&](SqlExecutorShard_t& shard, uint32_t shard_index)
+    {
+        auto& partition = shard.getPartition(p_table);
+        vec_is_done[shard_index] = partition.aggregateData(shard.getSnapshot(), plan, condition, vec_shard_group_table[shard_index]);
+        for (auto& group_table : vec_shard_group_table[shard_index]) addRowTouched(group_table.getGroupNum());
+    });
+
+    for (auto is_done : vec_is_done)
+    {
+        if (is_done) continue;
+        printf("Fail to select: invalid condition\n");
+        return false;
+    }
+
+    auto p_profile = getActiveProfile();
+    if (p_profile != nullptr)
+    {
+        p_profile->describeStage(EnumQueryStage::OUTPUT, "print column \"" + plan.str_column_name + "\"");
+        p_profile->describeStage(EnumQueryStage::AGGREGATE, "merge the partial groups of the shards");
+        if (!p_profile->isAnalyze()) return true;
+    }
+
+    // a group may show up on several shards, merge the partial states
+    std::vector<SqlGroupTable_t> vec_group_table(1, SqlGroupTable_t{plan.vec_aggregate_column.size()});
+    {
+        ProfileStageGuard_t aggregate_guard(p_profile, EnumQueryStage::AGGREGATE);
+        auto& merged_table = vec_group_table[0];
+        for (auto& vec_partial_table : vec_shard_group_table)
+        {
+            for (auto& partial_table : vec_partial_table)
+            {
+                for (uint32_t group = 0; group < partial_table.getGroupNum(); group ++)
+                {
+                    auto merged_group = merged_table.findOrInsert(partial_table.getKey(group), partial_table.getHash(group));
+                    mergeAggregateState(plan.vec_aggregate_column, merged_table.getState(merged_group), partial_table.getState(group));
+                }
+                if (p_profile != nullptr) p_profile->getStage(EnumQueryStage::AGGREGATE).num_row_in += partial_table.getGroupNum();
+            }
+        }
+        if (p_profile != nullptr) p_profile->getStage(EnumQueryStage::AGGREGATE).num_row_out += merged_table.getGroupNum();
+    }
+
+    SqlTable_t::printGroupData(plan, vec_group_table);
+    return true;
+}
+
+void SqlShardCoordinator_t::handleTransaction(const EnumTransactionActionType action)
+{
+    runOnShard(EXEC_SHARD_ALL, [action](SqlExecutorShard_t& shard, uint32_t)
+    {
+        shard.handleTransaction(action);
+    });
+}
+
+void SqlShardCoordinator_t::dropTable(const SqlTable_t* p_table)
+{
+    // waits for the shards, the catalog table may be freed as soon as this returns
+    runOnShard(EXEC_SHARD_ALL, [p_table](SqlExecutorShard_t& shard, uint32_t)
+    {
+        shard.dropPartition(p_table);
+    });
+}
+
+void SqlShardCoordinator_t::getMemoryUsage(const SqlTable_t* p_table, MemoryUsage_t& usage)
+{
+    std::vector<MemoryUsage_t> vec_usage(vec_shard_.size());
+    runOnShard(EXEC_SHARD_ALL, [p_table, &vec_usage](SqlExecutorShard_t& shard, uint32_t shard_index)
+    {
+        shard.getPartition(p_table).getMemoryUsage(vec_usage[shard_index]);
+    });
+    for (auto& shard_usage : vec_usage) usage += shard_usage;
+}
+
+void SqlShardCoordinator_t::getPartition(const SqlTable_t* p_table, std::vector<SqlTable_t*>& vec_partition)
+{
+    // the wait makes every task posted before visible to this thread, and no shard runs anything until the next post
+    vec_partition.assign(vec_shard_.size(), nullptr);
+    runOnShard(EXEC_SHARD_ALL, [p_table, &vec_partition](SqlExecutorShard_t& shard, uint32_t shard_index)
+    {
+        vec_partition[shard_index] = &shard.getPartition(p_table);
+    });
+}
+
+void SqlShardCoordinator_t::runOnShard(uint32_t target_shard, const std::function<void(SqlExecutorShard_t&, uint32_t)>& task)
+{
+    // an explained statement is profiled on every shard it runs on, the profiles are summed once all are done
+    auto p_profile = getActiveProfile();
+    std::vector<SqlQueryProfile_t> vec_shard_profile;
+    if (p_profile != nullptr) vec_shard_profile.assign(vec_shard_.size(), SqlQueryProfile_t(p_profile->isAnalyze()));
+
+    std::atomic<uint32_t> cnt_done = 0;
+    uint32_t num_target = 0;
+    for (uint32_t shard_index = 0; shard_index < vec_shard_.size(); shard_index ++)
+    {
+        if (target_shard != EXEC_SHARD_ALL && target_shard != shard_index) continue;
+
+        auto p_shard_profile = (p_profile != nullptr) ? &vec_shard_profile[shard_index] : nullptr;
+        vec_shard_[shard_index]->post([&task, &cnt_done, shard_index, p_shard_profile](SqlExecutorShard_t& shard)
+        {
+            setActiveProfile(p_shard_profile);
+            task(shard, shard_index);
+            setActiveProfile(nullptr);
+            cnt_done.fetch_add(1, std::memory_order_release);
+        });
+        num_target ++;
+    }
+
+    while (cnt_done.load(std::memory_order_acquire) < num_target) std::this_thread::yield();
+
+    if (p_profile == nullptr) return;
+    for (uint32_t shard_index = 0; shard_index < vec_shard_.size(); shard_index ++)
+    {
+        if (target_shard == EXEC_SHARD_ALL || target_shard == shard_index) p_profile->mergeShard(vec_shard_profile[shard_index]);
+    }
+}
+
+bool SqlShardCoordinator_t::runWrite(uint32_t target_shard, const std::function<bool(SqlExecutorShard_t&, uint32_t, SqlTransaction_t&)>& statement)
+{
+    bool is_done = true;
+    if (target_shard != EXEC_SHARD_ALL)
+    {
+        runOnShard(target_shard, [&](SqlExecutorShard_t& shard, uint32_t shard_index)
+        {
+            is_done = shard.runInTransaction([&](SqlTransaction_t& txn) { return statement(shard, shard_index, txn); });
+        });
+        return is_done;
+    }
+
+    // every shard holds its part open until all of them ran it, so a shard that failed leaves nothing behind on the others
+    std::vector<uint8_t> vec_is_done(vec_shard_.size(), false);
+    runOnShard(EXEC_SHARD_ALL, [&](SqlExecutorShard_t& shard, uint32_t shard_index)
+    {
+        vec_is_done[shard_index] = shard.prepareStatement([&](SqlTransaction_t& txn) { return statement(shard, shard_index, txn); });
+    });
+    is_done = std::all_of(vec_is_done.begin(), vec_is_done.end(), [](uint8_t is_shard_done) { return is_shard_done; });
+
+    // the outcome is not waited for, the queue of a shard keeps it ahead of anything posted later
+    for (auto& p_shard : vec_shard_)
+    {
+        p_shard->post([is_done](SqlExecutorShard_t& shard) { shard.finishStatement(is_done); });
+    }
+    return is_done;
+}
+
+uint32_t SqlShardCoordinator_t::getTargetShard(SqlTable_t* p_table, const ConditionDescriptor_t& condition)
+{
+    // an equality on the primary key names the one shard that can hold the row
+    auto& primary_property = p_table->getProperty()[p_table->getPrimaryColumnIndex()];
+    if (condition.action != EnumConditionActionType::EQ || condition.column_name != primary_property.column_name) return EXEC_SHARD_ALL;
+
+    SqlValue_t primary_key = condition.anchor_val;
+    if (auto p_raw_anchor = std::get_if<std::string>(&condition.anchor_val))
+    {
+        if (!convertValue(*p_raw_anchor, primary_property.value_type, primary_key)) return EXEC_SHARD_ALL;
+    }
+    return getShardIndex(primary_key, static_cast<uint32_t>(vec_shard_.size()));
+}
+
+void SqlShardCoordinator_t::gatherRow(SqlTable_t* p_table, uint32_t target_shard, const std::vector<bool>& vec_is_wanted, const ConditionDescriptor_t& condition,
+                                      const OrderDescriptor_t& order, size_t row_quota, SqlTable_t& gathered_table, bool& is_gathered)
+{
+    auto p_profile = getActiveProfile();
+    ProfileStageGuard_t gather_guard(p_profile, EnumQueryStage::GATHER);
+    if (p_profile != nullptr)
+    {
+        std::string str_shard = (target_shard == EXEC_SHARD_ALL) ? "all " + std::to_string(vec_shard_.size()) + " shard(s)"
+                                                                 : "shard " + std::to_string(target_shard) + ", picked by the primary key";
+        p_profile->describeStage(EnumQueryStage::GATHER, "collect the rows from " + str_shard);
+    }
+
+    std::vector<std::vector<std::vector<SqlValue_t>>> vec_shard_row(vec_shard_.size());
+    std::vector<uint8_t>                              vec_is_done(vec_shard_.size(), true);
+    runOnShard(target_shard, [&](SqlExecutorShard_t& shard, uint32_t shard_index)
+    {
+        auto& partition = shard.getPartition(p_table);
+        vec_is_done[shard_index] = partition.gatherRow(shard.getSnapshot(), vec_is_wanted, condition, order, row_quota, vec_shard_row[shard_index]);
+        addRowTouched(vec_shard_row[shard_index].size());
+    });
+
+    // a gathered table is read once, so it keeps no bloom filters or radix tree indexes
+    auto vec_property = p_table->getProperty();
+    for (auto& property : vec_property)
+    {
+        property.is_bloom = false;
+        property.is_indexed = false;
+    }
+    gathered_table.setProperty(vec_property);
+
+    // all shards share the schema, so they all fail alike and nothing is kept then
+    is_gathered = std::all_of(vec_is_done.begin(), vec_is_done.end(), [](uint8_t is_done) { return is_done != 0; });
+    if (!is_gathered) return;
+
+    for (auto& vec_row : vec_shard_row)
+    {
+        if (p_profile != nullptr)
+        {
+            p_profile->getStage(EnumQueryStage::GATHER).num_row_in += vec_row.size();
+            p_profile->getStage(EnumQueryStage::GATHER).num_row_out += vec_row.size();
+        }
+        for (auto& row : vec_row) gathered_table.appendRow(std::move(row));
+    }
+}
+
+} // namespace sql::exec
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "map"
+#include "vector"
+#include "memory"
+#include "thread"
+#include "atomic"
+#include "optional"
+#include "functional"
+
+#include "def/sql_interface_def.h"
+#include "common/lock_free_queue.h"
+#include "executor/executor_hash.h"
+#include "executor/executor_sql.h"
+#include "executor/executor_metrics.h"
+
+#define EXEC_SHARD_MAX_NUM      64
+#define EXEC_SHARD_QUEUE_SIZE   4096
+#define EXEC_SHARD_ALL          UINT32_MAX
+#define EXEC_SHARD_INSERT_NUM   (EXEC_SHARD_QUEUE_SIZE - 1)   // insert batches a shard holds at most, so its done queue never fills
+
+namespace sql::exec
+{
+
+class SqlExecutorShard_t;
+
+using ShardTask_t = std::function<void(SqlExecutorShard_t&)>;
+
+struct ShardEnvelope_t
+{
+    ShardTask_t  task;
+    uint64_t     enqueue_ns = 0;
+};
+
+// the inserts of a batch owned by one shard, handed back to the dispatcher once the shard ran them
+struct ShardInsert_t
+{
+    std::vector<PacketEnvelope_t>  vec_envelope;
+    std::vector<uint8_t>           vec_is_inserted;
+    uint64_t                       dispatch_ns = 0;
+};
+
+using ShardInsertHandler_t = std::function<void(ShardInsert_t&)>;
+
+// owner shard of a primary key, the hash is remixed so shards do not line up with the bits join and aggregation tables use
+inline uint32_t getShardIndex(const SqlValue_t& key, uint32_t num_shard)
+{
+    uint64_t hash = hashValue(key);
+    hash = (hash ^ (hash >> 33)) * 0xff51afd7ed558ccdull;
+    hash = hash ^ (hash >> 33);
+    return static_cast<uint32_t>(hash % num_shard);
+}
+
+// one pinned executor thread, it owns one partition of every table and no other thread touches what it owns
+class SqlExecutorShard_t
+{
+public:
+    SqlExecutorShard_t() : sp_lfq_(std::make_shared<LockFreeQueue<ShardEnvelope_t>>(EXEC_SHARD_QUEUE_SIZE)), done_lfq_(EXEC_SHARD_QUEUE_SIZE) {}
+    ~SqlExecutorShard_t() { stop(); }
+
+    bool start(uint32_t shard_index, bool is_perf_counter);
+    void stop();
+
+    // called by the coordinator thread only, the queue has a single producer
+    void post(ShardTask_t&& task);
+    inline bool popInsert(ShardInsert_t& insert) { return done_lfq_.pop(insert); }
+
+    // everything below runs on the shard thread
+    SqlTable_t& getPartition(const SqlTable_t* p_table);
+    void dropPartition(const SqlTable_t* p_table);
+    Snapshot_t getSnapshot() const;
+    bool runInTransaction(const std::function<bool(SqlTransaction_t&)>& statement);
+    void handleTransaction(const EnumTransactionActionType action);
+
+    // a statement run on several shards is held open by prepareStatement(), finishStatement() keeps or undoes it once all of them ran it
+    bool prepareStatement(const std::function<bool(SqlTransaction_t&)>& statement);
+    void finishStatement(bool is_commit);
+    void finishInsert(ShardInsert_t&& insert);
+
+private:
+    void runBackend();
+
+    uint32_t                                  shard_index_ = 0;
+    bool                                      is_perf_counter_ = false;
+    std::atomic<bool>                         is_running_ = false;
+    std::thread                               th_backend_;
+    std::shared_ptr<LockFreeQueue<ShardEnvelope_t>>  sp_lfq_;   // shared with the metrics registry, which may outlive the shard
+    LockFreeQueue<ShardInsert_t>              done_lfq_;        // insert batches run, back to the coordinator
+
+    std::map<const SqlTable_t*, SqlTable_t>   map_partition_;   // keyed by the catalog table of the coordinator
+    SqlTransactionManager_t                   txn_manager_;
+    std::optional<SqlTransaction_t>           opt_txn_;
+    std::optional<SqlTransaction_t>           opt_statement_txn_;   // a prepared statement outside of opt_txn_
+    size_t                                    num_statement_write_ = 0;   // what opt_txn_ had written before the prepared statement
+    size_t                                    num_statement_undo_ = 0;
+};
+
+// runs statements of the dispatcher on the shards, it reads the schema in the catalog and never a partition
+class SqlShardCoordinator_t
+{
+public:
+    bool init(uint32_t num_shard, bool is_perf_counter, ShardInsertHandler_t&& on_insert);
+    inline bool isEnabled() const { return !vec_shard_.empty(); }
+
+    // inserts are not waited for, every shard hands the batch it got back to on_insert once it ran it
+    void postInsert(SqlTable_t* p_table, std::vector<PacketEnvelope_t>& vec_envelope, uint32_t run_begin, uint32_t run_end, uint64_t dispatch_ns);   // the run is moved from
+    void pollInsert();
+    void waitInsert();   // until every insert posted so far is handed back
+
+    bool insertRow(SqlTable_t* p_table, const std::vector<std::string>& vec_value);   // waits for the owner shard, for recovery
+    bool deleteRow(SqlTable_t* p_table, const ConditionDescriptor_t& condition, uint32_t& num_deleted);
+    bool updateRow(SqlTable_t* p_table, const std::vector<AssignmentDescriptor_t>& vec_assignment, const ConditionDescriptor_t& condition, uint32_t& num_updated);
+    bool selectData(SqlTable_t* p_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, const LimitDescriptor_t& limit);
+    bool selectJoinData(const std::string& table_name, SqlTable_t* p_table, SqlTable_t* p_join_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition);
+    bool selectGroupData(SqlTable_t* p_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const std::string& group_column_name);
+    void handleTransaction(const EnumTransactionActionType action);
+    void dropTable(const SqlTable_t* p_table);
+    void getMemoryUsage(const SqlTable_t* p_table, MemoryUsage_t& usage);
+
+    // the partition of the table on every shard in shard order, for a checkpoint or a recovery to work on while the shards wait
+    void getPartition(const SqlTable_t* p_table, std::vector<SqlTable_t*>& vec_partition);
+    inline uint32_t getShardNum() const { return static_cast<uint32_t>(vec_shard_.size()); }
+
+private:
+    // runs the task on one shard or on all of them and waits until every one is done
+    void runOnShard(uint32_t target_shard, const std::function<void(SqlExecutorShard_t&, uint32_t)>& task);
+    // a write on all of them only stays if every shard ran it
+    bool runWrite(uint32_t target_shard, const std::function<bool(SqlExecutorShard_t&, uint32_t, SqlTransaction_t&)>& statement);
+    uint32_t getTargetShard(SqlTable_t* p_table, const ConditionDescriptor_t& condition);
+    uint32_t getRowShard(SqlTable_t* p_table, const std::vector<std::string>& vec_value);
+    void gatherRow(SqlTable_t* p_table, uint32_t target_shard, const std::vector<bool>& vec_is_wanted, const ConditionDescriptor_t& condition,
+                   const OrderDescriptor_t& order, size_t row_quota, SqlTable_t& gathered_table, bool& is_gathered);
+
+    std::vector<std::unique_ptr<SqlExecutorShard_t>>  vec_shard_;
+    ShardInsertHandler_t                              on_insert_;
+    std::vector<ShardInsert_t>                        vec_shard_insert_;   // the batch being split up, one per shard
+    std::vector<uint32_t>                             vec_num_insert_;     // batches posted to a shard and not handed back yet
+    uint32_t                                          num_insert_ = 0;
+};
+
+} // namespace sql::exec
@@ -0,0 +1,409 @@
+#include "executor/executor_sort.h"
+
+#include "algorithm"
+#include "errno.h"
+#include "string.h"
+#include "unistd.h"
+
+namespace sql::exec
+{
+
+SqlSortRun_t& SqlSortRun_t::operator= (SqlSortRun_t&& __o) noexcept
+{
+    if (this != &__o)
+    {
+        close();
+        p_file_        = __o.p_file_;
+        vec_buffer_    = std::move(__o.vec_buffer_);
+        buffer_cursor_ = __o.buffer_cursor_;
+        buffer_filled_ = __o.buffer_filled_;
+        is_failed_     = __o.is_failed_;
+        __o.p_file_    = nullptr;
+    }
+    return *this;
+}
+
+bool SqlSortRun_t::open(size_t io_buffer_size)
+{
+    p_file_ = tmpfile();
+    if (p_file_ == nullptr) return false;
+
+    vec_buffer_.resize(io_buffer_size);
+    buffer_cursor_ = 0;
+    buffer_filled_ = 0;
+    is_failed_ = false;
+    return true;
+}
+
+bool SqlSortRun_t::write(const SortEntry_t& entry, const EnumValueType key_type)
+{
+    switch (key_type)
+    {
+        case EnumValueType::VALUE_TYPE_INT:
+        {
+            auto int_key = std::get<int32_t>(entry.key);
+            if (!writeBytes(&int_key, sizeof(int_key))) return false;
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_STRING:
+        {
+            auto& str_key = std::get<std::string>(entry.key);
+            auto length = static_cast<uint32_t>(str_key.size());
+            if (!writeBytes(&length, sizeof(length)) || !writeBytes(str_key.data(), length)) return false;
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_BIGINT:
+        case EnumValueType::VALUE_TYPE_TIMESTAMP:
+        {
+            auto bigint_key = std::get<int64_t>(entry.key);
+            if (!writeBytes(&bigint_key, sizeof(bigint_key))) return false;
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_DOUBLE:
+        {
+            auto double_key = std::get<double>(entry.key);
+            if (!writeBytes(&double_key, sizeof(double_key))) return false;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    return writeBytes(&entry.row_index, sizeof(entry.row_index));
+}
+
+bool SqlSortRun_t::rewind(size_t io_buffer_size)
+{
+    if (p_file_ == nullptr || !flush()) return false;
+    if (lseek(fileno(p_file_), 0, SEEK_SET) != 0) return false;
+
+    // the write buffer is given back, only a read buffer sized for the merge fan-in is kept
+    vec_buffer_.resize(io_buffer_size);
+    vec_buffer_.shrink_to_fit();
+    buffer_cursor_ = 0;
+    buffer_filled_ = 0;
+    return true;
+}
+
+bool SqlSortRun_t::read(SortEntry_t& entry, const EnumValueType key_type)
+{
+    // the run only ends cleanly before the key of an entry, a later short read means the entry was cut short
+    if (!readKey(entry, key_type)) return false;
+    if (readBytes(&entry.row_index, sizeof(entry.row_index))) return true;
+
+    is_failed_ = true;
+    return false;
+}
+
+bool SqlSortRun_t::readKey(SortEntry_t& entry, const EnumValueType key_type)
+{
+    switch (key_type)
+    {
+        case EnumValueType::VALUE_TYPE_INT:
+        {
+            int32_t int_key;
+            if (!readBytes(&int_key, sizeof(int_key))) return false;
+            entry.key = int_key;
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_STRING:
+        {
+            uint32_t length;
+            if (!readBytes(&length, sizeof(length))) return false;
+
+            std::string str_key(length, '\0');
+            if (!readBytes(str_key.data(), length))
+            {
+                is_failed_ = true;
+                return false;
+            }
+            entry.key = std::move(str_key);
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_BIGINT:
+        case EnumValueType::VALUE_TYPE_TIMESTAMP:
+        {
+            int64_t bigint_key;
+            if (!readBytes(&bigint_key, sizeof(bigint_key))) return false;
+            entry.key = bigint_key;
+            break;
+        }
+        case EnumValueType::VALUE_TYPE_DOUBLE:
+        {
+            double double_key;
+            if (!readBytes(&double_key, sizeof(double_key))) return false;
+            entry.key = double_key;
+            break;
+        }
+        default:
+            is_failed_ = true;
+            return false;
+    }
+    return true;
+}
+
+void SqlSortRun_t::close()
+{
+    if (p_file_ != nullptr)
+    {
+        fclose(p_file_);
+        p_file_ = nullptr;
+    }
+    vec_buffer_.clear();
+    vec_buffer_.shrink_to_fit();
+}
+
+bool SqlSortRun_t::writeBytes(const void* p_data, size_t size)
+{
+    auto p_byte = static_cast<const char*>(p_data);
+    while (size > 0)
+    {
+        if (buffer_cursor_ == vec_buffer_.size() && !flush()) return false;
+
+        size_t length = std::min(size, vec_buffer_.size() - buffer_cursor_);
+        memcpy(vec_buffer_.data() + buffer_cursor_, p_byte, length);
+        buffer_cursor_ += length;
+        p_byte += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool SqlSortRun_t::readBytes(void* p_data, size_t size)
+{
+    // false at the end of the file with nothing of the value read, a read error or the end of the file within the value fails the run
+    auto p_byte = static_cast<char*>(p_data);
+    size_t total_size = size;
+    while (size > 0)
+    {
+        if (buffer_cursor_ == buffer_filled_)
+        {
+            ssize_t length;
+            do
+            {
+                length = ::read(fileno(p_file_), vec_buffer_.data(), vec_buffer_.size());
+            } while (length < 0 && errno == EINTR);
+            if (length <= 0)
+            {
+                if (length < 0 || size < total_size) is_failed_ = true;
+                return false;
+            }
+            buffer_cursor_ = 0;
+            buffer_filled_ = static_cast<size_t>(length);
+        }
+
+        size_t length = std::min(size, buffer_filled_ - buffer_cursor_);
+        memcpy(p_byte, vec_buffer_.data() + buffer_cursor_, length);
+        buffer_cursor_ += length;
+        p_byte += length;
+        size -= length;
+    }
+    return true;
+}
+
+bool SqlSortRun_t::flush()
+{
+    size_t offset = 0;
+    while (offset < buffer_cursor_)
+    {
+        auto length = ::write(fileno(p_file_), vec_buffer_.data() + offset, buffer_cursor_ - offset);
+        if (length < 0 && errno == EINTR) continue;
+        if (length <= 0) return false;
+        offset += static_cast<size_t>(length);
+    }
+    buffer_cursor_ = 0;
+    return true;
+}
+
+SqlExternalSort_t::SqlExternalSort_t(const EnumValueType key_type, const EnumOrderDirection direction, size_t memory_limit)
+    : key_type_(key_type), direction_(direction), memory_limit_(memory_limit)
+{
+}
+
+bool SqlExternalSort_t::push(const SqlValue_t& key, uint32_t row_index)
+{
+    // the entries take what the vector reserved, a full vector doubles, so the run is spilled first when the doubled one would not fit
+    if (!vec_entry_.empty() && vec_entry_.size() == vec_entry_.capacity() && getEntryByte(vec_entry_.capacity() * 2) > memory_limit_ && !spillRun()) return false;
+
+    vec_entry_.emplace_back(SortEntry_t{key, row_index});
+    auto p_str_key = std::get_if<std::string>(&vec_entry_.back().key);
+    if (p_str_key != nullptr && p_str_key->capacity() > std::string().capacity()) key_byte_ += p_str_key->capacity() + 1;
+
+    if (getEntryByte(vec_entry_.capacity()) >= memory_limit_) return spillRun();
+    return true;
+}
+
+bool SqlExternalSort_t::finish()
+{
+    auto entry_less = [this](const SortEntry_t& lhs, const SortEntry_t& rhs) { return isLess(lhs, rhs); };
+    std::sort(vec_entry_.begin(), vec_entry_.end(), entry_less);
+    entry_cursor_ = 0;
+    if (vec_run_.empty()) return true;
+
+    // everything goes through the merge once something has been spilled
+    if (!vec_entry_.empty() && !spillRun()) return false;
+
+    // reduce the run count to the fan-in, each pass merges the oldest runs into a new one
+    while (vec_run_.size() > EXEC_SORT_MAX_FAN_IN)
+    {
+        vec_merge_run_.clear();
+        for (size_t index = 0; index < EXEC_SORT_MAX_FAN_IN; index ++)
+        {
+            vec_merge_run_.emplace_back(std::move(vec_run_[index]));
+        }
+        vec_run_.erase(vec_run_.begin(), vec_run_.begin() + EXEC_SORT_MAX_FAN_IN);
+
+        SqlSortRun_t merged_run;
+        if (!merged_run.open(getIoBufferSize(1)) || !buildLoserTree()) return false;
+
+        SortEntry_t entry;
+        while (popLoserTree(entry))
+        {
+            if (!merged_run.write(entry, key_type_))
+            {
+                printf("Fail to sort: cannot write temporary run file\n");
+                return false;
+            }
+        }
+        if (is_failed_) return false;
+        vec_run_.emplace_back(std::move(merged_run));
+    }
+
+    vec_merge_run_ = std::move(vec_run_);
+    vec_run_.clear();
+    return buildLoserTree();
+}
+
+bool SqlExternalSort_t::next(uint32_t& row_index)
+{
+    if (vec_merge_run_.empty())
+    {
+        if (entry_cursor_ >= vec_entry_.size()) return false;
+        row_index = vec_entry_[entry_cursor_ ++].row_index;
+        return true;
+    }
+
+    SortEntry_t entry;
+    if (!popLoserTree(entry)) return false;
+    row_index = entry.row_index;
+    return true;
+}
+
+bool SqlExternalSort_t::isLess(const SortEntry_t& lhs, const SortEntry_t& rhs) const
+{
+    // ties keep row order, runs are produced in row order so the merge stays deterministic
+    if (lhs.key != rhs.key)
+    {
+        return (direction_ == EnumOrderDirection::DESC) ? (rhs.key < lhs.key) : (lhs.key < rhs.key);
+    }
+    return lhs.row_index < rhs.row_index;
+}
+
+bool SqlExternalSort_t::spillRun()
+{
+    auto entry_less = [this](const SortEntry_t& lhs, const SortEntry_t& rhs) { return isLess(lhs, rhs); };
+    std::sort(vec_entry_.begin(), vec_entry_.end(), entry_less);
+
+    SqlSortRun_t run;
+    if (!run.open(getIoBufferSize(1)))
+    {
+        printf("Fail to sort: cannot create temporary run file\n");
+        return false;
+    }
+
+    for (auto& entry : vec_entry_)
+    {
+        if (!run.write(entry, key_type_))
+        {
+            printf("Fail to sort: cannot write temporary run file\n");
+            return false;
+        }
+    }
+
+    vec_run_.emplace_back(std::move(run));
+    num_spilled_run_ ++;
+
+    vec_entry_.clear();
+    vec_entry_.shrink_to_fit();
+    key_byte_ = 0;
+    return true;
+}
+
+size_t SqlExternalSort_t::getIoBufferSize(size_t num_run) const
+{
+    size_t io_buffer_size = memory_limit_ / std::max<size_t>(num_run, 1);
+    return std::clamp<size_t>(io_buffer_size, EXEC_SORT_MIN_IO_BUFFER, EXEC_SORT_MAX_IO_BUFFER);
+}
+
+bool SqlExternalSort_t::isBeating(size_t lhs, size_t rhs) const
+{
+    size_t sentinel = vec_merge_run_.size();
+    if (lhs == sentinel) return true;
+    if (rhs == sentinel) return false;
+    if (vec_exhausted_[lhs]) return false;
+    if (vec_exhausted_[rhs]) return true;
+    return isLess(vec_head_[lhs], vec_head_[rhs]);
+}
+
+bool SqlExternalSort_t::buildLoserTree()
+{
+    size_t num_run = vec_merge_run_.size();
+    size_t io_buffer_size = getIoBufferSize(num_run);
+
+    vec_head_.assign(num_run, SortEntry_t{});
+    vec_exhausted_.assign(num_run, false);
+    for (size_t index = 0; index < num_run; index ++)
+    {
+        if (!vec_merge_run_[index].rewind(io_buffer_size))
+        {
+            printf("Fail to sort: cannot read temporary run file\n");
+            return false;
+        }
+        vec_exhausted_[index] = !vec_merge_run_[index].read(vec_head_[index], key_type_);
+        if (vec_merge_run_[index].isFailed())
+        {
+            printf("Fail to sort: cannot read temporary run file\n");
+            is_failed_ = true;
+            return false;
+        }
+    }
+
+    vec_loser_.assign(std::max<size_t>(num_run, 1), num_run);
+    for (size_t index = num_run; index > 0; index --)
+    {
+        adjustLoserTree(index - 1);
+    }
+    return true;
+}
+
+void SqlExternalSort_t::adjustLoserTree(size_t leaf)
+{
+    size_t num_run = vec_merge_run_.size();
+    size_t winner = leaf;
+    for (size_t node = (leaf + num_run) / 2; node > 0; node /= 2)
+    {
+        if (isBeating(vec_loser_[node], winner)) std::swap(winner, vec_loser_[node]);
+    }
+    vec_loser_[0] = winner;
+}
+
+bool SqlExternalSort_t::popLoserTree(SortEntry_t& entry)
+{
+    size_t winner = vec_loser_[0];
+    if (winner >= vec_merge_run_.size() || vec_exhausted_[winner]) return false;
+
+    entry = std::move(vec_head_[winner]);
+    vec_exhausted_[winner] = !vec_merge_run_[winner].read(vec_head_[winner], key_type_);
+    if (vec_merge_run_[winner].isFailed())
+    {
+        printf("Fail to sort: cannot read temporary run file\n");
+        is_failed_ = true;
+        return false;
+    }
+    if (vec_exhausted_[winner]) vec_merge_run_[winner].close();
+
+    adjustLoserTree(winner);
+    return true;
+}
+
+} // namespace sql::exec
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "vector"
+#include "utility"
+#include "stdio.h"
+
+#include "def/sql_interface_def.h"
+
+// working memory of one sort before it spills a run to disk, override with -DEXEC_SORT_MEMORY_LIMIT=<bytes>
+#ifndef EXEC_SORT_MEMORY_LIMIT
+#define EXEC_SORT_MEMORY_LIMIT     (64 * 1024 * 1024)
+#endif
+
+#define EXEC_SORT_MAX_FAN_IN       64
+#define EXEC_SORT_MIN_IO_BUFFER    (64 * 1024)
+#define EXEC_SORT_MAX_IO_BUFFER    (1024 * 1024)
+
+namespace sql::exec
+{
+
+struct SortEntry_t
+{
+    SqlValue_t  key;
+    uint32_t    row_index;
+};
+
+// a sorted run spilled to an anonymous temp file, written and read back sequentially in large chunks
+class SqlSortRun_t
+{
+public:
+    SqlSortRun_t() = default;
+    SqlSortRun_t(const SqlSortRun_t&) = delete;
+    SqlSortRun_t(SqlSortRun_t&& __o) noexcept { *this = std::move(__o); }
+    SqlSortRun_t& operator= (SqlSortRun_t&& __o) noexcept;
+    ~SqlSortRun_t() { close(); }
+
+    bool open(size_t io_buffer_size);
+    bool write(const SortEntry_t& entry, const EnumValueType key_type);
+    bool rewind(size_t io_buffer_size);
+    bool read(SortEntry_t& entry, const EnumValueType key_type);   // false at the end of the run or on a read error
+    void close();
+
+    inline bool isFailed() const { return is_failed_; }   // a read error or an entry cut short, not the end of the run
+
+private:
+    bool writeBytes(const void* p_data, size_t size);
+    bool readKey(SortEntry_t& entry, const EnumValueType key_type);
+    bool readBytes(void* p_data, size_t size);
+    bool flush();
+
+    FILE*              p_file_ = nullptr;
+    std::vector<char>  vec_buffer_;
+    size_t             buffer_cursor_ = 0;
+    size_t             buffer_filled_ = 0;
+    bool               is_failed_ = false;
+};
+
+// sorts (key, row index) entries within a memory budget, spilling sorted runs and merging them with a loser tree
+class SqlExternalSort_t
+{
+public:
+    SqlExternalSort_t(const EnumValueType key_type, const EnumOrderDirection direction, size_t memory_limit = EXEC_SORT_MEMORY_LIMIT);
+
+    bool push(const SqlValue_t& key, uint32_t row_index);
+    bool finish();
+    bool next(uint32_t& row_index);   // false once every entry is out or a run fails to read
+
+    inline size_t getRunNum() const { return num_spilled_run_; }
+    inline bool isFailed() const { return is_failed_; }
+
+private:
+    bool isLess(const SortEntry_t& lhs, const SortEntry_t& rhs) const;
+    bool spillRun();
+    inline size_t getEntryByte(size_t num_entry) const { return num_entry * sizeof(SortEntry_t) + key_byte_; }
+    size_t getIoBufferSize(size_t num_run) const;
+
+    // loser tree over vec_merge_run_, leaf k is a sentinel that beats every run
+    bool isBeating(size_t lhs, size_t rhs) const;
+    bool buildLoserTree();
+    void adjustLoserTree(size_t leaf);
+    bool popLoserTree(SortEntry_t& entry);
+
+    EnumValueType               key_type_;
+    EnumOrderDirection          direction_;
+    size_t                      memory_limit_;
+
+    std::vector<SortEntry_t>    vec_entry_;
+    size_t                      key_byte_ = 0;     // held by string keys on the heap, next to the capacity of vec_entry_
+    size_t                      entry_cursor_ = 0;
+    bool                        is_failed_ = false;
+
+    size_t                      num_spilled_run_ = 0;
+    std::vector<SqlSortRun_t>   vec_run_;
+    std::vector<SqlSortRun_t>   vec_merge_run_;
+    std::vector<SortEntry_t>    vec_head_;
+    std::vector<bool>           vec_exhausted_;
+    std::vector<size_t>         vec_loser_;
+};
+
+} // namespace sql::exec
@@ -1,251 +1,1694 @@
 #include "executor/executor_sql.h"
+#include "executor/executor_hash.h"
+#include "executor/executor_metrics.h"
+#include "executor/executor_profile.h"
 
 #include "set"
+#include "cmath"
+#include "memory"
+#include "algorithm"
+#include "stdexcept"
 #include "functional"
 
 namespace sql::exec
 {
-bool SqlTable_t::selectData(const std::string& column_name)
+
+// appends the matching rows of [row_begin, row_end), blocks whose zone map rules the anchor out are not read at all
+template <typename SqlType>
+void filterColumn(const SqlColumn_t& column, const SqlValue_t& anchor_value, const SqlType& typed_anchor_value, const EnumConditionActionType action, 
+                  uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection, StageProfile_t* p_stage)
+{
+    // point lookups ask the bloom filter of a block before reading its rows
+    bool is_bloom_probe = (action == EnumConditionActionType::EQ && column.hasBloomFilter());
+    uint64_t anchor_hash = is_bloom_probe ? hashValue(anchor_value) : 0;
+
+    uint32_t row = row_begin;
+    while (row < row_end)
+    {
+        uint32_t block = row >> EXEC_BLOCK_BITS;
+        uint32_t block_end = std::min<uint32_t>(row_end, (block + 1) << EXEC_BLOCK_BITS);
+        bool is_zone_matched = isZoneMatched(column.getZoneMap(block), anchor_value, action);
+        bool is_bloom_matched = !is_zone_matched || !is_bloom_probe || column.getBloomFilter(block).mayContain(anchor_hash);
+
+        // a scan hands a block over in several batches, it is counted with the batch holding its first row
+        if (p_stage != nullptr)
+        {
+            bool is_block_begin = (row & EXEC_BLOCK_MASK) == 0;
+            p_stage->num_block += is_block_begin;
+            p_stage->num_block_zone_skipped += is_block_begin && !is_zone_matched;
+            p_stage->num_block_bloom_skipped += is_block_begin && !is_bloom_matched;
+            if (is_zone_matched && is_bloom_matched)
+            {
+                uint64_t row_byte = sizeof(SqlValue_t);
+                if (column.isEncoded(block))
+                {
+                    if constexpr (std::is_same_v<SqlType, double>) row_byte = column.getDoubleBlock(block).getByte() / EXEC_BLOCK_ROW_NUM;
+                    else if constexpr (std::is_same_v<SqlType, std::string>) row_byte = column.getStringBlock(block).getByte() / EXEC_BLOCK_ROW_NUM;
+                    else row_byte = column.getIntBlock(block).getByte() / EXEC_BLOCK_ROW_NUM;
+                }
+                p_stage->num_byte += (block_end - row) * row_byte;
+            }
+        }
+
+        // a sealed block is filtered on its encoded form, its contiguous array or its inline strings
+        if (is_zone_matched && is_bloom_matched && column.isEncoded(block))
+        {
+            uint32_t slot_begin = row & EXEC_BLOCK_MASK, slot_end = block_end - (block << EXEC_BLOCK_BITS);
+            if constexpr (std::is_same_v<SqlType, double>) column.getDoubleBlock(block).filter(action, typed_anchor_value, slot_begin, slot_end, block << EXEC_BLOCK_BITS, vec_selection);
+            else if constexpr (std::is_same_v<SqlType, std::string>) column.getStringBlock(block).filter(action, typed_anchor_value, slot_begin, slot_end, block << EXEC_BLOCK_BITS, vec_selection);
+            else column.getIntBlock(block).filter(action, typed_anchor_value, slot_begin, slot_end, block << EXEC_BLOCK_BITS, vec_selection);
+            row = block_end;
+            continue;
+        }
+
+        if (is_zone_matched && is_bloom_matched)
+        {
+            auto& block_value = column.getBlock(block);
+            for (; row < block_end; row ++)
+            {
+                auto& value = std::get<SqlType>(block_value[row & EXEC_BLOCK_MASK]);
+                if (compare<SqlType>(value, typed_anchor_value, action)) vec_selection.emplace_back(row);
+            }
+        }
+        row = block_end;
+    }
+}
+
+// a filter over a column holding SqlType, false if the anchor does not hold it
+template <typename SqlType>
+static bool getColumnFilter(const SqlColumn_t& column, const SqlValue_t& anchor_value, const EnumConditionActionType action, StageProfile_t* p_stage,
+                            std::function<void(uint32_t, uint32_t, std::vector<uint32_t>&)>& row_filter)
+{
+    auto p_typed_anchor_value = std::get_if<SqlType>(&anchor_value);
+    if (p_typed_anchor_value == nullptr) return false;
+
+    row_filter = [&column, anchor_value, typed_anchor_value = *p_typed_anchor_value, action, p_stage](uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)
+    {
+        filterColumn<SqlType>(column, anchor_value, typed_anchor_value, action, row_begin, row_end, vec_selection, p_stage);
+    };
+    return true;
+}
+
+static bool isLeapYear(int64_t year)
+{
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// days between 1970-01-01 and a date of the proleptic gregorian calendar
+static int64_t getDayFromCivil(int64_t year, int64_t month, int64_t day)
+{
+    year -= (month <= 2);
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// reads an unsigned decimal of exactly num_digit digits at pos
+static bool parseDigit(const std::string& raw_value, size_t pos, size_t num_digit, int64_t& number)
+{
+    if (pos + num_digit > raw_value.size()) return false;
+
+    number = 0;
+    for (size_t index = pos; index < pos + num_digit; index ++)
+    {
+        if (!isdigit(static_cast<unsigned char>(raw_value[index]))) return false;
+        number = number * 10 + (raw_value[index] - '0');
+    }
+    return true;
+}
+
+// YYYY-MM-DD[THH:MM:SS[.ffffff]] in UTC to microseconds since the epoch
+static bool parseTimestamp(const std::string& raw_value, int64_t& timestamp)
+{
+    static const int64_t arr_month_day[12] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    int64_t year, month, day, hour = 0, minute = 0, second = 0, microsecond = 0;
+    if (raw_value.size() < 10 || raw_value[4] != '-' || raw_value[7] != '-'
+     || !parseDigit(raw_value, 0, 4, year) || !parseDigit(raw_value, 5, 2, month) || !parseDigit(raw_value, 8, 2, day)) return false;
+
+    if (raw_value.size() > 10)
+    {
+        if (raw_value.size() < 19 || raw_value[10] != 'T' || raw_value[13] != ':' || raw_value[16] != ':'
+         || !parseDigit(raw_value, 11, 2, hour) || !parseDigit(raw_value, 14, 2, minute) || !parseDigit(raw_value, 17, 2, second)) return false;
+    }
+    if (raw_value.size() > 19)
+    {
+        size_t num_digit = raw_value.size() - 20;
+        if (raw_value[19] != '.' || num_digit == 0 || num_digit > 6 || !parseDigit(raw_value, 20, num_digit, microsecond)) return false;
+        for (; num_digit < 6; num_digit ++) microsecond *= 10;
+    }
+
+    if (month < 1 || month > 12 || day < 1 || day > arr_month_day[month - 1] || (month == 2 && day == 29 && !isLeapYear(year))) return false;
+    if (hour > 23 || minute > 59 || second > 59) return false;
+
+    timestamp = ((getDayFromCivil(year, month, day) * 24 + hour) * 60 + minute) * 60 + second;
+    timestamp = timestamp * EXEC_MICROSECOND_PER_SECOND + microsecond;
+    return true;
+}
+
+// the inverse of parseTimestamp, the fraction is left out when it is zero
+static std::string formatTimestamp(int64_t timestamp)
+{
+    int64_t second = timestamp / EXEC_MICROSECOND_PER_SECOND, microsecond = timestamp % EXEC_MICROSECOND_PER_SECOND;
+    if (microsecond < 0)
+    {
+        microsecond += EXEC_MICROSECOND_PER_SECOND;
+        second --;
+    }
+    int64_t day = second / 86400, second_of_day = second % 86400;
+    if (second_of_day < 0)
+    {
+        second_of_day += 86400;
+        day --;
+    }
+
+    day += 719468;
+    int64_t era = (day >= 0 ? day : day - 146096) / 146097;
+    int64_t day_of_era = day - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;
+    int64_t month = (month_index < 10) ? month_index + 3 : month_index - 9;
+    int64_t year = year_of_era + era * 400 + (month <= 2);
+
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld",
+                          static_cast<long long>(year), static_cast<long long>(month), static_cast<long long>(day_of_year - (153 * month_index + 2) / 5 + 1),
+                          static_cast<long long>(second_of_day / 3600), static_cast<long long>(second_of_day / 60 % 60), static_cast<long long>(second_of_day % 60));
+    if (microsecond != 0) snprintf(buffer + length, sizeof(buffer) - length, ".%06lld", static_cast<long long>(microsecond));
+    return buffer;
+}
+
+// a value as SELECT prints it
+static std::string formatValue(const EnumValueType value_type, const SqlValue_t& value)
+{
+    char buffer[32];
+    switch (value_type)
+    {
+        case EnumValueType::VALUE_TYPE_INT:       return std::to_string(std::get<int32_t>(value));
+        case EnumValueType::VALUE_TYPE_STRING:    return std::get<std::string>(value);
+        case EnumValueType::VALUE_TYPE_BIGINT:    return std::to_string(std::get<int64_t>(value));
+        case EnumValueType::VALUE_TYPE_TIMESTAMP: return formatTimestamp(std::get<int64_t>(value));
+        case EnumValueType::VALUE_TYPE_DOUBLE:
+        {
+            snprintf(buffer, sizeof(buffer), "%.15g", std::get<double>(value));
+            return buffer;
+        }
+        default:
+            return "";
+    }
+}
+
+bool convertValue(const std::string& raw_value, const EnumValueType value_type, SqlValue_t& value)
+{
+    switch (value_type)
+    {
+        case EnumValueType::VALUE_TYPE_INT:
+        {
+            try
+            {
+                value = SqlValue_t{static_cast<int32_t>(std::stoi(raw_value))};
+            }
+            catch (std::invalid_argument const &exception) { return false; }
+            catch (std::out_of_range const &exception) { return false; }
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_STRING:
+        {
+            value = SqlValue_t{raw_value};
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_BIGINT:
+        {
+            try
+            {
+                value = SqlValue_t{static_cast<int64_t>(std::stoll(raw_value))};
+            }
+            catch (std::invalid_argument const &exception) { return false; }
+            catch (std::out_of_range const &exception) { return false; }
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_DOUBLE:
+        {
+            // NaN and infinity would break the ordering zone maps and the sort rely on
+            try
+            {
+                auto real_value = std::stod(raw_value);
+                if (!std::isfinite(real_value)) return false;
+                value = SqlValue_t{real_value};
+            }
+            catch (std::invalid_argument const &exception) { return false; }
+            catch (std::out_of_range const &exception) { return false; }
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_TIMESTAMP:
+        {
+            int64_t timestamp;
+            if (!parseTimestamp(raw_value, timestamp)) return false;
+            value = SqlValue_t{timestamp};
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// "column" op anchor, as EXPLAIN prints a condition
+static std::string describeCondition(const std::string& column_name, const EnumConditionActionType action, const EnumValueType value_type, const SqlValue_t& anchor_value)
+{
+    std::string str_condition = "\"" + column_name + "\" ";
+    switch (action)
+    {
+        case EnumConditionActionType::LT:   str_condition.append("< ");  break;
+        case EnumConditionActionType::LTEQ: str_condition.append("<= "); break;
+        case EnumConditionActionType::EQ:   str_condition.append("= ");  break;
+        case EnumConditionActionType::GTEQ: str_condition.append(">= "); break;
+        case EnumConditionActionType::GT:   str_condition.append("> ");  break;
+        case EnumConditionActionType::LIKE: str_condition.append("LIKE "); break;
+        default: break;
+    }
+
+    if (action == EnumConditionActionType::LIKE) str_condition.append("\"" + formatValue(value_type, anchor_value) + "%\"");
+    else if (value_type == EnumValueType::VALUE_TYPE_STRING) str_condition.append("\"" + formatValue(value_type, anchor_value) + "\"");
+    else str_condition.append(formatValue(value_type, anchor_value));
+    return str_condition;
+}
+
+bool SqlTable_t::selectData(const Snapshot_t& snapshot, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, const LimitDescriptor_t& limit)
+{
+    auto p_profile = getActiveProfile();
+    ProfileStageGuard_t output_guard(p_profile, EnumQueryStage::OUTPUT);
+
+    std::vector<uint32_t> vec_column_index;
+    if (!getProjection(vec_projection, vec_column_index)) return false;
+
+    std::vector<ValuePrinter_t> vec_printer_wrapper(vec_column_index.size());
+    for (size_t index = 0; index < vec_column_index.size(); index ++)
+    {
+        if (!getValuePrinter(vec_property_[vec_column_index[index]].value_type, vec_printer_wrapper[index]))
+        {
+            printf("Fail to select: invalid column type\n");
+            return false;
+        }
+    }
+
+    RowFilter_t row_filter;
+    if (!getRowFilter(snapshot, condition, row_filter))
+    {
+        printf("Fail to select: invalid condition\n");
+        return false;
+    }
+
+    // rows beyond offset + count are never printed, so every access path may stop there
+    size_t row_quota = (limit.is_limited) ? static_cast<size_t>(limit.offset) + limit.count : SIZE_MAX;
+    size_t row_skip  = (limit.is_limited) ? limit.offset : 0;
+    size_t cnt_visited = 0;
+    uint32_t cnt_row = 0;
+
+    // late materialization: only rows that survived the filter get their projected columns gathered
+    SqlValue_t decoded_value;
+    RowVisitor_t row_visitor = [&](uint32_t row_index)
+    {
+        ProfileStageGuard_t visit_guard(p_profile, EnumQueryStage::OUTPUT);
+        if (cnt_visited ++ >= row_skip)
+        {
+            printf(" ");
+            for (size_t index = 0; index < vec_column_index.size(); index ++)
+            {
+                vec_printer_wrapper[index](vec_column_[vec_column_index[index]].getValue(row_index, decoded_value));
+            }
+            printf("\n");
+            cnt_row ++;
+        }
+        return cnt_visited < row_quota;
+    };
+
+    uint32_t order_column_index = 0;
+    if (order.direction != EnumOrderDirection::IDLE && !getColumnIndex(order.column_name, order_column_index))
+    {
+        printf("Fail to select: order column \"%s\" doesn\'t exist\n", order.column_name.c_str());
+        return false;
+    }
+
+    std::string str_column_name = "";
+    for (auto column_index : vec_column_index)
+    {
+        if (!str_column_name.empty()) str_column_name.append(", ");
+        str_column_name.append(vec_property_[column_index].column_name);
+    }
+
+    if (p_profile != nullptr)
+    {
+        std::string str_limit = (limit.is_limited) ? ", offset " + std::to_string(limit.offset) + " limit " + std::to_string(limit.count) : "";
+        p_profile->describeStage(EnumQueryStage::OUTPUT, "print column \"" + str_column_name + "\"" + str_limit);
+        if (!p_profile->isAnalyze()) return visitRow(row_filter, order_column_index, order.direction, row_quota, row_visitor);
+    }
+    printf("Select data from column \"%s\":\n", str_column_name.c_str());
+
+    if (!visitRow(row_filter, order_column_index, order.direction, row_quota, row_visitor)) return false;
+    printf("%d row(s) selected\n", cnt_row);
+    addRowTouched(cnt_row);
+
+    if (p_profile != nullptr)
+    {
+        auto& output = p_profile->getStage(EnumQueryStage::OUTPUT);
+        output.num_row_in += cnt_visited;
+        output.num_row_out += cnt_row;
+        output.num_byte += static_cast<uint64_t>(cnt_row) * vec_column_index.size() * sizeof(SqlValue_t);
+    }
+    return true;
+}
+
+bool SqlTable_t::selectJoinData(const Snapshot_t& snapshot, const std::string& table_name, SqlTable_t& join_table, const std::vector<ProjectionDescriptor_t>& vec_projection_descriptor, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition)
+{
+    auto p_profile = getActiveProfile();
+    ProfileStageGuard_t output_guard(p_profile, EnumQueryStage::OUTPUT);
+
+    auto& join_table_name = join.table_name;
+    if (&join_table == this)
+    {
+        printf("Fail to join: table \"%s\" cannot be joined with itself\n", table_name.c_str());
+        return false;
+    }
+
+    SqlTable_t* arr_table[2] = {this, &join_table};
+    auto resolve_column = [&](const std::string& column_name, JoinColumn_t& join_column)
+    {
+        if (getJoinColumn(column_name, table_name, join_table, join_table_name, join_column)) return true;
+        printf("Fail to join: column \"%s\" doesn\'t exist or is ambiguous\n", column_name.c_str());
+        return false;
+    };
+
+    // projection, "*" expands to every column of both tables
+    std::vector<JoinColumn_t> vec_projection;
+    std::vector<std::string>  vec_projection_name;
+    for (auto& projection : vec_projection_descriptor)
+    {
+        auto& column_name = projection.column_name;
+        if (projection.aggregate != EnumAggregateType::IDLE)
+        {
+            printf("Fail to join: aggregate functions are not supported on joins\n");
+            return false;
+        }
+
+        if (column_name == "*")
+        {
+            for (uint32_t side = 0; side < 2; side ++)
+            {
+                auto& side_table_name = (side == 0) ? table_name : join_table_name;
+                for (uint32_t index = 0; index < arr_table[side]->vec_property_.size(); index ++)
+                {
+                    vec_projection.emplace_back(JoinColumn_t{side, index});
+                    vec_projection_name.emplace_back(side_table_name + "." + arr_table[side]->vec_property_[index].column_name);
+                }
+            }
+            continue;
+        }
+
+        JoinColumn_t join_column;
+        if (!resolve_column(column_name, join_column)) return false;
+        vec_projection.emplace_back(join_column);
+        vec_projection_name.emplace_back(column_name);
+    }
+
+    std::vector<ValuePrinter_t> vec_printer_wrapper(vec_projection.size());
+    for (size_t index = 0; index < vec_projection.size(); index ++)
+    {
+        auto& property = arr_table[vec_projection[index].side]->vec_property_[vec_projection[index].column_index];
+        if (!getValuePrinter(property.value_type, vec_printer_wrapper[index]))
+        {
+            printf("Fail to join: invalid column type\n");
+            return false;
+        }
+    }
+
+    // join keys, one from each table and of the same type
+    JoinColumn_t lhs_key, rhs_key;
+    if (!resolve_column(join.lhs_column_name, lhs_key) || !resolve_column(join.rhs_column_name, rhs_key)) return false;
+    if (lhs_key.side == rhs_key.side)
+    {
+        printf("Fail to join: join condition must compare a column of each table\n");
+        return false;
+    }
+
+    JoinColumn_t arr_key[2] = {lhs_key, rhs_key};
+    if (lhs_key.side == 1) std::swap(arr_key[0], arr_key[1]);
+    if (vec_property_[arr_key[0].column_index].value_type != join_table.vec_property_[arr_key[1].column_index].value_type)
+    {
+        printf("Fail to join: join columns have different types\n");
+        return false;
+    }
+
+    // the WHERE condition is pushed below the join, only qualifying rows reach the hash table
+    std::vector<uint32_t> arr_selection[2];
+    uint32_t condition_side;
+    ConditionDescriptor_t side_condition;
+    if (!getJoinCondition(table_name, join_table, join, condition, condition_side, side_condition))
+    {
+        printf("Fail to join: column \"%s\" doesn\'t exist or is ambiguous\n", condition.column_name.c_str());
+        return false;
+    }
+
+    RowFilter_t arr_row_filter[2];
+    for (uint32_t side = 0; side < 2; side ++)
+    {
+        if (!arr_table[side]->getRowFilter(snapshot, (side == condition_side) ? side_condition : ConditionDescriptor_t{}, arr_row_filter[side]))
+        {
+            printf("Fail to join: invalid condition\n");
+            return false;
+        }
+    }
+
+    if (p_profile != nullptr)
+    {
+        std::string str_column_name = "";
+        for (auto& projection_name : vec_projection_name)
+        {
+            if (!str_column_name.empty()) str_column_name.append(", ");
+            str_column_name.append(projection_name);
+        }
+        p_profile->describeStage(EnumQueryStage::OUTPUT, "print column \"" + str_column_name + "\"");
+        p_profile->describeStage(EnumQueryStage::JOIN, "hash join on \"" + join.lhs_column_name + "\" = \"" + join.rhs_column_name + "\", built on the smaller input");
+        p_profile->describeStage(EnumQueryStage::ACCESS, "full scan of both tables");
+        if (!p_profile->isAnalyze()) return true;
+    }
+
+    {
+        ProfileStageGuard_t access_guard(p_profile, EnumQueryStage::ACCESS);
+        for (uint32_t side = 0; side < 2; side ++) arr_row_filter[side](0, arr_table[side]->getRowNum(), arr_selection[side]);
+    }
+
+    // build on the smaller input
+    uint32_t build_side = (arr_selection[0].size() <= arr_selection[1].size()) ? 0 : 1;
+    uint32_t probe_side = 1 - build_side;
+
+    printf("Select data from column \"");
+    for (size_t index = 0; index < vec_projection_name.size(); index ++)
+    {
+        printf((index == 0) ? "%s" : ", %s", vec_projection_name[index].c_str());
+    }
+    printf("\":\n");
+
+    uint32_t cnt_row = 0;
+    ProfileStageGuard_t join_guard(p_profile, EnumQueryStage::JOIN);
+    SqlHashJoin_t hash_join(arr_table[build_side]->vec_column_[arr_key[build_side].column_index], arr_table[probe_side]->vec_column_[arr_key[probe_side].column_index]);
+    SqlValue_t decoded_value;
+    hash_join.join(arr_selection[build_side], arr_selection[probe_side], [&](uint32_t build_row, uint32_t probe_row)
+    {
+        ProfileStageGuard_t visit_guard(p_profile, EnumQueryStage::OUTPUT);
+        uint32_t arr_row[2];
+        arr_row[build_side] = build_row;
+        arr_row[probe_side] = probe_row;
+
+        printf(" ");
+        for (size_t index = 0; index < vec_projection.size(); index ++)
+        {
+            auto& join_column = vec_projection[index];
+            vec_printer_wrapper[index](arr_table[join_column.side]->vec_column_[join_column.column_index].getValue(arr_row[join_column.side], decoded_value));
+        }
+        printf("\n");
+        cnt_row ++;
+    });
+    printf("%d row(s) selected\n", cnt_row);
+    addRowTouched(cnt_row);
+
+    if (p_profile != nullptr)
+    {
+        uint64_t num_input = arr_selection[0].size() + arr_selection[1].size();
+        auto& access = p_profile->getStage(EnumQueryStage::ACCESS);
+        access.num_row_in += arr_table[0]->getRowNum() + arr_table[1]->getRowNum();
+        access.num_row_out += num_input;
+        auto& join_stage = p_profile->getStage(EnumQueryStage::JOIN);
+        join_stage.num_row_in += num_input;
+        join_stage.num_row_out += cnt_row;
+        join_stage.num_byte += num_input * sizeof(SqlValue_t);
+        auto& output = p_profile->getStage(EnumQueryStage::OUTPUT);
+        output.num_row_in += cnt_row;
+        output.num_row_out += cnt_row;
+        output.num_byte += static_cast<uint64_t>(cnt_row) * vec_projection.size() * sizeof(SqlValue_t);
+    }
+    return true;
+}
+
+bool SqlTable_t::selectGroupData(const Snapshot_t& snapshot, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const std::string& group_column_name)
+{
+    AggregatePlan_t plan;
+    if (!getAggregatePlan(vec_projection, group_column_name, plan)) return false;
+
+    std::vector<SqlGroupTable_t> vec_group_table;
+    if (!aggregateData(snapshot, plan, condition, vec_group_table))
+    {
+        printf("Fail to select: invalid condition\n");
+        return false;
+    }
+    if (isPlanOnly()) return true;
+
+    printGroupData(plan, vec_group_table);
+    return true;
+}
+
+bool SqlTable_t::getAggregatePlan(const std::vector<ProjectionDescriptor_t>& vec_projection, const std::string& group_column_name, AggregatePlan_t& plan)
+{
+    static const char* arr_aggregate_name[] = {"", "COUNT", "SUM", "MIN", "MAX", "AVG"};
+
+    plan = AggregatePlan_t{};
+    plan.vec_projection = vec_projection;
+    if (!group_column_name.empty())
+    {
+        if (!getColumnIndex(group_column_name, plan.group_column_index))
+        {
+            printf("Fail to select: group column \"%s\" doesn\'t exist\n", group_column_name.c_str());
+            return false;
+        }
+        plan.has_group_column = true;
+    }
+
+    // every output column is either the group key or an aggregate
+    for (auto& projection : vec_projection)
+    {
+        ValuePrinter_t printer_wrapper;
+        uint32_t column_index = EXEC_COLUMN_NONE;
+        if (projection.column_name != "*" && !getColumnIndex(projection.column_name, column_index))
+        {
+            printf("Fail to select: column \"%s\" doesn\'t exist\n", projection.column_name.c_str());
+            return false;
+        }
+
+        if (projection.aggregate == EnumAggregateType::IDLE)
+        {
+            if (!plan.has_group_column || projection.column_name == "*" || column_index != plan.group_column_index)
+            {
+                printf("Fail to select: column \"%s\" must appear in GROUP BY or an aggregate function\n", projection.column_name.c_str());
+                return false;
+            }
+        }
+        else if (column_index == EXEC_COLUMN_NONE && projection.aggregate != EnumAggregateType::COUNT)
+        {
+            printf("Fail to select: %s(*) is not supported\n", arr_aggregate_name[static_cast<int>(projection.aggregate)]);
+            return false;
+        }
+        else if ((projection.aggregate == EnumAggregateType::SUM || projection.aggregate == EnumAggregateType::AVG) 
+              && vec_property_[column_index].value_type != EnumValueType::VALUE_TYPE_INT
+              && vec_property_[column_index].value_type != EnumValueType::VALUE_TYPE_BIGINT
+              && vec_property_[column_index].value_type != EnumValueType::VALUE_TYPE_DOUBLE)
+        {
+            printf("Fail to select: %s requires an INT, BIGINT or DOUBLE column\n", arr_aggregate_name[static_cast<int>(projection.aggregate)]);
+            return false;
+        }
+
+        if (projection.aggregate == EnumAggregateType::IDLE || projection.aggregate == EnumAggregateType::MIN || projection.aggregate == EnumAggregateType::MAX)
+        {
+            getValuePrinter(vec_property_[column_index].value_type, printer_wrapper);
+        }
+        if (projection.aggregate != EnumAggregateType::IDLE)
+        {
+            bool is_real = (column_index != EXEC_COLUMN_NONE && vec_property_[column_index].value_type == EnumValueType::VALUE_TYPE_DOUBLE);
+            plan.vec_aggregate_column.emplace_back(AggregateColumn_t{projection.aggregate, nullptr, is_real});
+            plan.vec_aggregate_column_index.emplace_back(column_index);
+        }
+        plan.vec_printer.emplace_back(std::move(printer_wrapper));
+
+        if (!plan.str_column_name.empty()) plan.str_column_name.append(", ");
+        if (projection.aggregate == EnumAggregateType::IDLE) plan.str_column_name.append(projection.column_name);
+        else plan.str_column_name.append(std::string(arr_aggregate_name[static_cast<int>(projection.aggregate)]) + "(" + projection.column_name + ")");
+    }
+
+    return true;
+}
+
+bool SqlTable_t::aggregateData(const Snapshot_t& snapshot, const AggregatePlan_t& plan, const ConditionDescriptor_t& condition, std::vector<SqlGroupTable_t>& vec_group_table)
+{
+    RowFilter_t row_filter;
+    if (!getRowFilter(snapshot, condition, row_filter)) return false;
+
+    // bind the plan to the columns of this table
+    auto vec_aggregate_column = plan.vec_aggregate_column;
+    for (size_t index = 0; index < vec_aggregate_column.size(); index ++)
+    {
+        auto column_index = plan.vec_aggregate_column_index[index];
+        vec_aggregate_column[index].p_column = (column_index == EXEC_COLUMN_NONE) ? nullptr : &vec_column_[column_index];
+    }
+
+    auto p_profile = getActiveProfile();
+    if (p_profile != nullptr)
+    {
+        std::string str_group = plan.has_group_column ? "grouped by \"" + vec_property_[plan.group_column_index].column_name + "\"" : "into a single group";
+        p_profile->describeStage(EnumQueryStage::OUTPUT, "print column \"" + plan.str_column_name + "\"");
+        p_profile->describeStage(EnumQueryStage::AGGREGATE, "hash aggregate over a full scan, " + str_group);
+        if (!p_profile->isAnalyze()) return true;
+    }
+
+    uint64_t num_visible = (p_profile != nullptr) ? p_profile->getStage(EnumQueryStage::VISIBILITY).num_row_out : 0;
+    {
+        ProfileStageGuard_t aggregate_guard(p_profile, EnumQueryStage::AGGREGATE);
+        SqlHashAggregate_t hash_aggregate(plan.has_group_column ? &vec_column_[plan.group_column_index] : nullptr, vec_aggregate_column);
+        // the row filter counts into the one profile, so a profiled aggregate keeps to the calling thread
+        hash_aggregate.aggregate(getRowNum(), row_filter, (p_profile != nullptr) ? 1 : EXEC_AGGREGATE_MAX_WORKER);
+        vec_group_table = hash_aggregate.releaseResult();
+    }
+
+    if (p_profile != nullptr)
+    {
+        auto& aggregate = p_profile->getStage(EnumQueryStage::AGGREGATE);
+        aggregate.num_row_in += p_profile->getStage(EnumQueryStage::VISIBILITY).num_row_out - num_visible;
+        for (auto& group_table : vec_group_table) aggregate.num_row_out += group_table.getGroupNum();
+    }
+    return true;
+}
+
+void SqlTable_t::printGroupData(const AggregatePlan_t& plan, const std::vector<SqlGroupTable_t>& vec_group_table)
+{
+    auto p_profile = getActiveProfile();
+    ProfileStageGuard_t output_guard(p_profile, EnumQueryStage::OUTPUT);
+
+    // groups come out per hash partition, print them in key order instead
+    std::vector<std::pair<const SqlGroupTable_t*, uint32_t>> vec_group;
+    for (auto& group_table : vec_group_table)
+    {
+        for (uint32_t group = 0; group < group_table.getGroupNum(); group ++) vec_group.emplace_back(&group_table, group);
+    }
+    std::sort(vec_group.begin(), vec_group.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.first->getKey(lhs.second) < rhs.first->getKey(rhs.second);
+    });
+
+    // an aggregate without GROUP BY always yields one row, even over no rows
+    SqlGroupTable_t empty_table(plan.vec_aggregate_column.size());
+    if (!plan.has_group_column && vec_group.empty())
+    {
+        empty_table.findOrInsert(SqlValue_t{}, 0);
+        vec_group.emplace_back(&empty_table, 0);
+    }
+
+    auto& vec_projection = plan.vec_projection;
+    printf("Select data from column \"%s\":\n", plan.str_column_name.c_str());
+    for (auto& [p_group_table, group] : vec_group)
+    {
+        auto p_state = p_group_table->getState(group);
+        size_t aggregate_index = 0;
+
+        printf(" ");
+        for (size_t index = 0; index < vec_projection.size(); index ++)
+        {
+            if (vec_projection[index].aggregate == EnumAggregateType::IDLE)
+            {
+                plan.vec_printer[index](p_group_table->getKey(group));
+                continue;
+            }
+
+            bool is_real = plan.vec_aggregate_column[aggregate_index].is_real;
+            auto& state = p_state[aggregate_index ++];
+            switch (vec_projection[index].aggregate)
+            {
+                case EnumAggregateType::COUNT: printf(" %lld,", static_cast<long long>(state.count)); break;
+                case EnumAggregateType::SUM:
+                {
+                    if (is_real) printf(" %.15g,", state.sum_real);
+                    else printf(" %lld,", static_cast<long long>(state.sum));
+                    break;
+                }
+                case EnumAggregateType::AVG:
+                {
+                    if (state.count == 0) printf(" NULL,");
+                    else printf(" %.4f,", (is_real ? state.sum_real : static_cast<double>(state.sum)) / state.count);
+                    break;
+                }
+                default:
+                {
+                    if (state.count == 0) printf(" NULL,");
+                    else plan.vec_printer[index](state.extreme);
+                    break;
+                }
+            }
+        }
+        printf("\n");
+    }
+    printf("%d row(s) selected\n", static_cast<uint32_t>(vec_group.size()));
+    addRowTouched(vec_group.size());
+
+    if (p_profile != nullptr)
+    {
+        auto& output = p_profile->getStage(EnumQueryStage::OUTPUT);
+        output.num_row_in += vec_group.size();
+        output.num_row_out += vec_group.size();
+        output.num_byte += vec_group.size() * vec_projection.size() * sizeof(SqlValue_t);
+    }
+}
+
+void SqlTable_t::getWantedColumn(const std::vector<ProjectionDescriptor_t>& vec_projection, const OrderDescriptor_t& order, std::vector<bool>& vec_is_wanted)
+{
+    vec_is_wanted.assign(vec_property_.size(), false);
+    uint32_t column_index;
+    for (auto& projection : vec_projection)
+    {
+        if (projection.column_name == "*") vec_is_wanted.assign(vec_property_.size(), true);
+        else if (getColumnIndex(projection.column_name, column_index)) vec_is_wanted[column_index] = true;
+    }
+    if (order.direction != EnumOrderDirection::IDLE && getColumnIndex(order.column_name, column_index)) vec_is_wanted[column_index] = true;
+}
+
+void SqlTable_t::getJoinWantedColumn(const std::string& table_name, SqlTable_t& join_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const JoinDescriptor_t& join,
+                                     std::vector<bool>& vec_is_wanted, std::vector<bool>& vec_is_join_wanted)
+{
+    // names that resolve to no column are left to the join, which reports them
+    vec_is_wanted.assign(vec_property_.size(), false);
+    vec_is_join_wanted.assign(join_table.vec_property_.size(), false);
+    std::vector<bool>* arr_vec_is_wanted[2] = {&vec_is_wanted, &vec_is_join_wanted};
+    auto want_column = [&](const std::string& column_name)
+    {
+        JoinColumn_t join_column;
+        if (getJoinColumn(column_name, table_name, join_table, join.table_name, join_column)) (*arr_vec_is_wanted[join_column.side])[join_column.column_index] = true;
+    };
+
+    for (auto& projection : vec_projection)
+    {
+        if (projection.column_name != "*") want_column(projection.column_name);
+        else
+        {
+            vec_is_wanted.assign(vec_is_wanted.size(), true);
+            vec_is_join_wanted.assign(vec_is_join_wanted.size(), true);
+        }
+    }
+    want_column(join.lhs_column_name);
+    want_column(join.rhs_column_name);
+}
+
+bool SqlTable_t::getJoinCondition(const std::string& table_name, SqlTable_t& join_table, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition, uint32_t& condition_side, ConditionDescriptor_t& side_condition)
+{
+    // side 2 means no condition, otherwise the condition names the column of its side without qualifier
+    condition_side = 2;
+    side_condition = condition;
+    if (condition.action == EnumConditionActionType::IDLE) return true;
+
+    JoinColumn_t condition_column;
+    if (!getJoinColumn(condition.column_name, table_name, join_table, join.table_name, condition_column)) return false;
+    condition_side = condition_column.side;
+    SqlTable_t* arr_table[2] = {this, &join_table};
+    side_condition.column_name = arr_table[condition_side]->vec_property_[condition_column.column_index].column_name;
+    return true;
+}
+
+bool SqlTable_t::gatherRow(const Snapshot_t& snapshot, const std::vector<bool>& vec_is_wanted, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, size_t row_quota, std::vector<std::vector<SqlValue_t>>& vec_row)
+{
+    RowFilter_t row_filter;
+    if (!getRowFilter(snapshot, condition, row_filter)) return false;
+
+    uint32_t order_column_index = 0;
+    if (order.direction != EnumOrderDirection::IDLE && !getColumnIndex(order.column_name, order_column_index)) return false;
+
+    auto p_profile = getActiveProfile();
+    uint64_t num_wanted = std::count(vec_is_wanted.begin(), vec_is_wanted.end(), true);
+    if (p_profile != nullptr) p_profile->describeStage(EnumQueryStage::GATHER, "copy " + std::to_string(num_wanted) + " column(s) of every row to the coordinator");
+
+    // columns nobody asked for travel as empty values
+    size_t num_gathered = vec_row.size();
+    bool is_visited = visitRow(row_filter, order_column_index, order.direction, row_quota, [&](uint32_t row_index)
+    {
+        ProfileStageGuard_t visit_guard(p_profile, EnumQueryStage::GATHER);
+        auto& row = vec_row.emplace_back(vec_column_.size());
+        for (uint32_t index = 0; index < vec_column_.size(); index ++)
+        {
+            if (vec_is_wanted[index]) row[index] = vec_column_[index].getValue(row_index);
+        }
+        return vec_row.size() < row_quota;
+    });
+
+    if (p_profile != nullptr)
+    {
+        auto& gather = p_profile->getStage(EnumQueryStage::GATHER);
+        gather.num_row_in += vec_row.size() - num_gathered;
+        gather.num_row_out += vec_row.size() - num_gathered;
+        gather.num_byte += (vec_row.size() - num_gathered) * num_wanted * sizeof(SqlValue_t);
+    }
+    return is_visited;
+}
+
+void SqlTable_t::appendRow(std::vector<SqlValue_t>&& row)
+{
+    // committed before any snapshot and never ended
+    map_primary_index_.emplace(row[primary_column_index_], getRowNum());
+    for (uint32_t index = 0; index < row.size(); index ++)
+    {
+        vec_column_[index].emplace_back(std::move(row[index]));
+    }
+    vec_begin_ts_.emplace_back(0);
+    vec_end_ts_.emplace_back(EXEC_TS_INFINITY);
+    syncMemory();
+}
+
+void SqlTable_t::getLiveRow(std::vector<uint32_t>& vec_row) const
+{
+    // taken between transactions, every version is either committed and alive or dead
+    vec_row.clear();
+    for (uint32_t index = 0; index < getRowNum(); index ++)
+    {
+        if (vec_end_ts_[index] == EXEC_TS_INFINITY) vec_row.emplace_back(index);
+    }
+}
+
+void SqlTable_t::beginBulkLoad()
+{
+    // bloom filters and the radix trees are left out until every row is in
+    vec_column_.assign(vec_property_.size(), SqlColumn_t{});
+    vec_begin_ts_.clear();
+    vec_end_ts_.clear();
+    num_dead_row_ = 0;
+    map_primary_index_.clear();
+}
+
+void SqlTable_t::buildLoadIndex(uint32_t column_index)
+{
+    auto& column = vec_column_[column_index];
+    if (vec_property_[column_index].is_bloom)
+    {
+        column.enableBloomFilter();
+        column.refreshBlockFilter();
+    }
+    if (vec_property_[column_index].is_indexed) column.enableArtIndex();
+    if (column_index == primary_column_index_) rebuildPrimaryIndex();
+}
+
+bool SqlTable_t::finishBulkLoad()
+{
+    uint32_t num_row = getRowNum();
+    for (auto& column : vec_column_)
+    {
+        if (column.size() != num_row) return false;
+    }
+
+    vec_begin_ts_.assign(num_row, 0);
+    vec_end_ts_.assign(num_row, EXEC_TS_INFINITY);
+    syncMemory();
+    return true;
+}
+
+bool SqlTable_t::insertRow(SqlTransaction_t& txn, const std::vector<std::string>& value)
+{
+    auto value_ = std::vector<SqlValue_t>{};
+    if (!appendVersion(txn, value, value_)) return false;
+
+    syncMemory();
+    return true;
+}
+
+uint32_t SqlTable_t::insertRows(SqlTransaction_t& txn, const std::vector<const std::vector<std::string>*>& vec_p_value, std::vector<uint8_t>& vec_is_inserted)
+{
+    // one reservation for the run, at least doubling so back-to-back runs do not reallocate every time
+    size_t num_row_wanted = getRowNum() + vec_p_value.size();
+    if (vec_begin_ts_.capacity() < num_row_wanted)
+    {
+        size_t capacity = std::max(num_row_wanted, vec_begin_ts_.capacity() * 2);
+        vec_begin_ts_.reserve(capacity);
+        vec_end_ts_.reserve(capacity);
+    }
+    size_t num_write_wanted = txn.vec_write.size() + vec_p_value.size();
+    if (txn.vec_write.capacity() < num_write_wanted) txn.vec_write.reserve(std::max(num_write_wanted, txn.vec_write.capacity() * 2));
+
+    // the memory charge is settled once per run, so the limit may be overshot by a run at most
+    uint32_t num_inserted = 0;
+    std::vector<SqlValue_t> value;
+    vec_is_inserted.assign(vec_p_value.size(), false);
+    for (size_t index = 0; index < vec_p_value.size(); index ++)
+    {
+        if (!appendVersion(txn, *vec_p_value[index], value)) continue;
+
+        vec_is_inserted[index] = true;
+        num_inserted ++;
+    }
+    syncMemory();
+    return num_inserted;
+}
+
+bool SqlTable_t::appendVersion(SqlTransaction_t& txn, const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value)
+{
+    auto& budget = SqlMemoryBudget_t::getInstance();
+    if (budget.isExceeded())
+    {
+        printf("Fail to insert: memory limit of %.1f MB reached, %.1f MB in use\n", budget.getLimit() / EXEC_MEMORY_MB, budget.getUsed() / EXEC_MEMORY_MB);
+        return false;
+    }
+
+    if (!verifyRowData(txn, raw_value, value))
+    {
+        printf("Fail to insert: data verification failed\n");
+        return false;
+    }
+
+    // the new version stays private to the transaction until it commits
+    uint32_t row_index = getRowNum();
+    map_primary_index_.emplace(value[primary_column_index_], row_index);
+    for (uint32_t index = 0; index < value.size(); index ++)
+    {
+        vec_column_[index].emplace_back(std::move(value[index]));
+    }
+    vec_begin_ts_.emplace_back(txn.snapshot.txn_id);
+    vec_end_ts_.emplace_back(EXEC_TS_INFINITY);
+    txn.vec_write.emplace_back(WriteRecord_t{this, row_index, EnumWriteType::INSERT});
+    return true;
+}
+
+bool SqlTable_t::deleteRow(SqlTransaction_t& txn, const ConditionDescriptor_t& condition, uint32_t& num_deleted)
+{
+    uint32_t column_index;
+    if (!getColumnIndex(condition.column_name, column_index))
+    {
+        printf("Fail to delete: column \"%s\" doesn\'t exist\n", condition.column_name.c_str());
+        return false;
+    }
+
+    RowFilter_t row_filter;
+    if (!getRowFilter(txn.snapshot, condition, row_filter))
+    {
+        printf("Fail to delete: invalid condition\n");
+        return false;
+    }
+
+    auto p_profile = getActiveProfile();
+    if (p_profile != nullptr)
+    {
+        p_profile->describeStage(EnumQueryStage::MODIFY, "end the matching versions, the first deleter wins");
+        p_profile->describeStage(EnumQueryStage::ACCESS, "full scan of " + std::to_string(getRowNum()) + " row(s)");
+        if (!p_profile->isAnalyze()) return true;
+    }
+
+    std::vector<uint32_t> vec_selection;
+    {
+        ProfileStageGuard_t access_guard(p_profile, EnumQueryStage::ACCESS);
+        row_filter(0, getRowNum(), vec_selection);
+    }
+    ProfileStageGuard_t modify_guard(p_profile, EnumQueryStage::MODIFY);
+    if (p_profile != nullptr)
+    {
+        auto& access = p_profile->getStage(EnumQueryStage::ACCESS);
+        access.num_row_in += getRowNum();
+        access.num_row_out += vec_selection.size();
+        auto& modify = p_profile->getStage(EnumQueryStage::MODIFY);
+        modify.num_row_in += vec_selection.size();
+        modify.num_byte += vec_selection.size() * sizeof(Timestamp_t);
+    }
+
+    // first deleter wins: a visible version already ended by someone else is a write-write conflict
+    for (auto row_index : vec_selection)
+    {
+        if (vec_end_ts_[row_index] != EXEC_TS_INFINITY)
+        {
+            printf("Fail to delete: row is being modified by another transaction\n");
+            return false;
+        }
+    }
+
+    // only the end timestamp is set here, the rows are removed by garbage collection later on
+    for (auto row_index : vec_selection)
+    {
+        vec_end_ts_[row_index] = txn.snapshot.txn_id;
+        txn.vec_write.emplace_back(WriteRecord_t{this, row_index, EnumWriteType::DELETE});
+    }
+
+    num_deleted = static_cast<uint32_t>(vec_selection.size());
+    if (p_profile != nullptr) p_profile->getStage(EnumQueryStage::MODIFY).num_row_out += num_deleted;
+    return true;
+}
+
+bool SqlTable_t::updateRow(SqlTransaction_t& txn, const std::vector<AssignmentDescriptor_t>& vec_assignment, const ConditionDescriptor_t& condition, uint32_t& num_updated)
+{
+    std::vector<uint32_t> vec_column_index;
+    std::vector<SqlValue_t> vec_value;
+    bool is_primary_assigned = false, is_string_assigned = false;
+    for (auto& assignment : vec_assignment)
+    {
+        uint32_t column_index;
+        if (!getColumnIndex(assignment.column_name, column_index))
+        {
+            printf("Fail to update: column \"%s\" doesn\'t exist\n", assignment.column_name.c_str());
+            return false;
+        }
+        if (std::find(vec_column_index.begin(), vec_column_index.end(), column_index) != vec_column_index.end())
+        {
+            printf("Fail to update: column \"%s\" is assigned twice\n", assignment.column_name.c_str());
+            return false;
+        }
+
+        SqlValue_t value;
+        if (!convertValue(assignment.value, vec_property_[column_index].value_type, value))
+        {
+            printf("Fail to update: invalid value \"%s\" for column \"%s\"\n", assignment.value.c_str(), assignment.column_name.c_str());
+            return false;
+        }
+        is_primary_assigned |= (column_index == primary_column_index_);
+        is_string_assigned |= (vec_property_[column_index].value_type == EnumValueType::VALUE_TYPE_STRING);
+        vec_column_index.emplace_back(column_index);
+        vec_value.emplace_back(std::move(value));
+    }
+
+    uint32_t column_index;
+    if (!getColumnIndex(condition.column_name, column_index))
+    {
+        printf("Fail to update: column \"%s\" doesn\'t exist\n", condition.column_name.c_str());
+        return false;
+    }
+
+    RowFilter_t row_filter;
+    if (!getRowFilter(txn.snapshot, condition, row_filter))
+    {
+        printf("Fail to update: invalid condition\n");
+        return false;
+    }
+
+    auto p_profile = getActiveProfile();
+    if (p_profile != nullptr)
+    {
+        p_profile->describeStage(EnumQueryStage::MODIFY, "rewrite " + std::to_string(vec_assignment.size()) + " cell(s) of the matching versions in place, old values kept for rollback");
+        p_profile->describeStage(EnumQueryStage::ACCESS, "full scan of " + std::to_string(getRowNum()) + " row(s)");
+        if (!p_profile->isAnalyze()) return true;
+    }
+
+    std::vector<uint32_t> vec_selection;
+    {
+        ProfileStageGuard_t access_guard(p_profile, EnumQueryStage::ACCESS);
+        row_filter(0, getRowNum(), vec_selection);
+    }
+    ProfileStageGuard_t modify_guard(p_profile, EnumQueryStage::MODIFY);
+    if (p_profile != nullptr)
+    {
+        auto& access = p_profile->getStage(EnumQueryStage::ACCESS);
+        access.num_row_in += getRowNum();
+        access.num_row_out += vec_selection.size();
+        auto& modify = p_profile->getStage(EnumQueryStage::MODIFY);
+        modify.num_row_in += vec_selection.size();
+        modify.num_byte += vec_selection.size() * vec_assignment.size() * sizeof(SqlValue_t);
+    }
+
+    for (auto row_index : vec_selection)
+    {
+        if (vec_end_ts_[row_index] != EXEC_TS_INFINITY)
+        {
+            printf("Fail to update: row is being modified by another transaction\n");
+            return false;
+        }
+    }
+
+    // a new primary key must not collide with any other live version, nor be given to two rows at once
+    if (is_primary_assigned && !vec_selection.empty())
+    {
+        auto& primary_value = vec_value[std::find(vec_column_index.begin(), vec_column_index.end(), primary_column_index_) - vec_column_index.begin()];
+        bool is_duplicate = (vec_selection.size() > 1);
+        auto range_primary = map_primary_index_.equal_range(primary_value);
+        for (auto iter = range_primary.first; iter != range_primary.second && !is_duplicate; iter ++)
+        {
+            auto end_ts = vec_end_ts_[iter->second];
+            is_duplicate = (iter->second != vec_selection[0] && !isVersionDead(end_ts) && end_ts != txn.snapshot.txn_id);
+        }
+        if (is_duplicate)
+        {
+            printf("Fail to update: duplicate primary key\n");
+            return false;
+        }
+    }
+
+    auto& budget = SqlMemoryBudget_t::getInstance();
+    if (is_string_assigned && !vec_selection.empty() && budget.isExceeded())
+    {
+        printf("Fail to update: memory limit of %.1f MB reached, %.1f MB in use\n", budget.getLimit() / EXEC_MEMORY_MB, budget.getUsed() / EXEC_MEMORY_MB);
+        return false;
+    }
+
+    // the version keeps its timestamps, every rewritten cell leaves its old value in the undo log of the transaction
+    for (auto row_index : vec_selection)
+    {
+        for (size_t index = 0; index < vec_column_index.size(); index ++)
+        {
+            auto old_value = vec_column_[vec_column_index[index]].getValue(row_index);
+            if (old_value == vec_value[index]) continue;
+
+            txn.vec_write.emplace_back(WriteRecord_t{this, row_index, EnumWriteType::UPDATE, static_cast<uint32_t>(txn.vec_undo.size())});
+            txn.vec_undo.emplace_back(UndoValue_t{vec_column_index[index], std::move(old_value)});
+            writeCell(row_index, vec_column_index[index], SqlValue_t(vec_value[index]));
+        }
+    }
+    syncMemory();
+
+    num_updated = static_cast<uint32_t>(vec_selection.size());
+    if (p_profile != nullptr) p_profile->getStage(EnumQueryStage::MODIFY).num_row_out += num_updated;
+    return true;
+}
+
+void SqlTable_t::setProperty(const std::vector<TableColumnProperty_t>& vec_column_property)
+{
+    vec_property_ = vec_column_property;
+    vec_column_.assign(vec_property_.size(), SqlColumn_t{});
+    for (uint32_t index = 0; index < vec_property_.size(); index ++)
+    {
+        if (vec_property_[index].is_primary) primary_column_index_ = index;
+        if (vec_property_[index].is_bloom) vec_column_[index].enableBloomFilter();
+        if (vec_property_[index].is_indexed) vec_column_[index].enableArtIndex();
+    }
+    rebuildPrimaryIndex();
+}
+
+void SqlTable_t::commitVersion(uint32_t row_index, const EnumWriteType write_type, Timestamp_t commit_ts)
 {
-    uint32_t column_index;
-    if (!getColumnIndex(column_name, column_index))
+    if (write_type == EnumWriteType::INSERT)
     {
-        printf("Fail to delete: column \"%s\" doesn\'t exist\n", column_name.c_str());
-        return false;
+        vec_begin_ts_[row_index] = commit_ts;
+        return;
     }
-    
-    std::function<void(const SqlValue_t&)> printer_wrapper;
-    switch (vec_property_[column_index].value_type)
+    if (write_type != EnumWriteType::DELETE) return;
+
+    vec_end_ts_[row_index] = commit_ts;
+    num_dead_row_ ++;
+}
+
+void SqlTable_t::rollbackVersion(uint32_t row_index, const EnumWriteType write_type, const UndoValue_t* p_undo)
+{
+    if (write_type == EnumWriteType::UPDATE)
     {
-        case EnumValueType::VALUE_TYPE_INT:
+        writeCell(row_index, p_undo->column_index, SqlValue_t(p_undo->old_value));
+        syncMemory();
+        return;
+    }
+
+    if (write_type == EnumWriteType::INSERT)
+    {
+        // never born, hidden from every snapshot and collected like any dead version
+        vec_begin_ts_[row_index] = 0;
+        vec_end_ts_[row_index] = 0;
+        num_dead_row_ ++;
+        return;
+    }
+
+    vec_end_ts_[row_index] = EXEC_TS_INFINITY;
+}
+
+void SqlTable_t::collectGarbage()
+{
+    if (num_dead_row_ == 0 || num_dead_row_ * EXEC_GC_DEAD_ROW_RATIO < getRowNum()) return;
+
+    std::vector<uint32_t> vec_dead_row;
+    for (uint32_t index = 0; index < getRowNum(); index ++)
+    {
+        if (isVersionDead(vec_end_ts_[index])) vec_dead_row.emplace_back(index);
+    }
+    if (vec_dead_row.empty()) return;
+
+    // compact every column and the version timestamps, the dead rows are in ascending row order
+    for (auto& column : vec_column_) column.compact(vec_dead_row);
+    auto compact = [&vec_dead_row](std::vector<Timestamp_t>& vec_ts)
+    {
+        size_t cursor = 0;
+        uint32_t index_kept = 0;
+        for (uint32_t index = 0; index < vec_ts.size(); index ++)
         {
-            printer_wrapper = [](const SqlValue_t& value)
+            if (cursor < vec_dead_row.size() && vec_dead_row[cursor] == index)
             {
-                printf("  %d,\n", std::get<int32_t>(value));
-            };
-            break;
+                cursor ++;
+                continue;
+            }
+            vec_ts[index_kept ++] = vec_ts[index];
         }
-        case EnumValueType::VALUE_TYPE_STRING:
+        return index_kept;
+    };
+    vec_begin_ts_.resize(compact(vec_begin_ts_));
+    vec_end_ts_.resize(compact(vec_end_ts_));
+    num_dead_row_ = 0;
+
+    // row positions after the first dead row have shifted
+    rebuildPrimaryIndex();
+    syncMemory();
+}
+
+void SqlTable_t::getMemoryUsage(MemoryUsage_t& usage) const
+{
+    for (auto& column : vec_column_) column.addMemoryUsage(usage);
+    usage[EnumMemoryCategory::ROW] += (vec_begin_ts_.capacity() + vec_end_ts_.capacity()) * sizeof(Timestamp_t);
+
+    // a tree node holds the pair and three links and a color, the keys copy the strings of the primary column
+    usage[EnumMemoryCategory::INDEX] += map_primary_index_.size() * (sizeof(std::pair<const SqlValue_t, uint32_t>) + 4 * sizeof(void*));
+    if (!vec_column_.empty()) usage[EnumMemoryCategory::INDEX] += vec_column_[primary_column_index_].getStringByte();
+}
+
+void SqlTable_t::syncMemory()
+{
+    MemoryUsage_t usage;
+    getMemoryUsage(usage);
+    memory_charge_.update(usage.getTotal());
+}
+
+bool SqlTable_t::getColumnIndex(const std::string& column_name, uint32_t& index)
+{
+    for (uint16_t index_ = 0; index_ < vec_property_.size(); index_ ++)
+    {
+        if (column_name == vec_property_[index_].column_name)
         {
-            printer_wrapper = [](const SqlValue_t& value)
-            {
-                printf("  %s,\n", std::get<std::string>(value).c_str());
-            };
-            break;
+            index = index_;
+            return true;
         }
-        default:
+    }
+
+    return false;
+}
+
+bool SqlTable_t::getProjection(const std::vector<ProjectionDescriptor_t>& vec_projection, std::vector<uint32_t>& vec_column_index)
+{
+    vec_column_index.clear();
+    for (auto& projection : vec_projection)
+    {
+        auto& column_name = projection.column_name;
+        if (projection.aggregate != EnumAggregateType::IDLE)
         {
-            printf("Fail to select: invalid column type\n");
+            printf("Fail to select: aggregate function on \"%s\" mixed with plain columns\n", column_name.c_str());
+            return false;
+        }
+
+        if (column_name == "*")
+        {
+            for (uint32_t index = 0; index < vec_property_.size(); index ++) vec_column_index.emplace_back(index);
+            continue;
+        }
+
+        uint32_t column_index;
+        if (!getColumnIndex(column_name, column_index))
+        {
+            printf("Fail to select: column \"%s\" doesn\'t exist\n", column_name.c_str());
             return false;
         }
+        vec_column_index.emplace_back(column_index);
     }
 
-    printf("Select all data from column \"%s\":\n", column_name.c_str());
-    auto row_iter = vec_data_.begin();
-    while (row_iter != vec_data_.end())
+    if (vec_column_index.empty())
     {
-        printer_wrapper(*row_iter->data());
-        row_iter ++;
+        printf("Fail to select: no column selected\n");
+        return false;
     }
 
     return true;
 }
 
-bool SqlTable_t::selectData(const std::string& column_name, const ConditionDescriptor_t& condition)
+bool SqlTable_t::getJoinColumn(const std::string& column_name, const std::string& table_name, SqlTable_t& join_table, const std::string& join_table_name, JoinColumn_t& join_column)
 {
-    uint32_t column_index;
-    if (!getColumnIndex(column_name, column_index))
+    auto pos_dot = column_name.find('.');
+    if (pos_dot != std::string::npos)
     {
-        printf("Fail to delete: column \"%s\" doesn\'t exist\n", column_name.c_str());
+        auto qualifier = column_name.substr(0, pos_dot);
+        auto bare_column_name = column_name.substr(pos_dot + 1);
+        if (qualifier == table_name)
+        {
+            join_column.side = 0;
+            return getColumnIndex(bare_column_name, join_column.column_index);
+        }
+        if (qualifier == join_table_name)
+        {
+            join_column.side = 1;
+            return join_table.getColumnIndex(bare_column_name, join_column.column_index);
+        }
         return false;
     }
 
-    std::function<bool(const SqlValue_t&, const SqlValue_t&, const EnumConditionActionType&)> printer_wrapper;
-    switch (vec_property_[column_index].value_type)
+    // an unqualified name must belong to exactly one side
+    uint32_t column_index, join_column_index;
+    bool is_found = getColumnIndex(column_name, column_index);
+    bool is_join_found = join_table.getColumnIndex(column_name, join_column_index);
+    if (is_found == is_join_found) return false;
+
+    join_column = (is_found) ? JoinColumn_t{0, column_index} : JoinColumn_t{1, join_column_index};
+    return true;
+}
+
+bool SqlTable_t::getRowFilter(const Snapshot_t& snapshot, const ConditionDescriptor_t& condition, RowFilter_t& row_filter)
+{
+    RowFilter_t condition_filter;
+    if (!getConditionFilter(condition, condition_filter)) return false;
+
+    auto p_profile = getActiveProfile();
+    if (p_profile != nullptr) p_profile->describeStage(EnumQueryStage::VISIBILITY, "keep the versions the snapshot sees");
+    if (p_profile != nullptr && !p_profile->isAnalyze()) p_profile = nullptr;
+
+    // visibility is checked after the predicate, so only its survivors pay for it
+    row_filter = [this, snapshot, p_profile, condition_filter = std::move(condition_filter)](uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)
     {
-        case EnumValueType::VALUE_TYPE_INT:
+        ProfileStageGuard_t visibility_guard(p_profile, EnumQueryStage::VISIBILITY);
+        size_t selection_begin = vec_selection.size();
+        size_t num_selected = selection_begin;
         {
-            printer_wrapper = [](const SqlValue_t& value, const SqlValue_t& anchor_value, const EnumConditionActionType& action)
-            {
-                auto int_value = std::get<int32_t>(value);
-                auto int_anchor_value = std::get<int32_t>(anchor_value);
-                if (compare<int32_t>(int_value, int_anchor_value, action))
-                {
-                    printf("  %d,\n", std::get<int32_t>(value));
-                    return true;
-                }
-                return false;
-            };
-            break;
+            ProfileStageGuard_t filter_guard(p_profile, EnumQueryStage::FILTER);
+            condition_filter(row_begin, row_end, vec_selection);
         }
-        case EnumValueType::VALUE_TYPE_STRING:
+
+        size_t num_matched = vec_selection.size() - num_selected;
+        for (size_t index = num_selected; index < vec_selection.size(); index ++)
         {
-            printer_wrapper = [](const SqlValue_t& value, const SqlValue_t& anchor_value, const EnumConditionActionType& action)
-            {
-                auto str_value = std::get<std::string>(value);
-                auto str_anchor_value = std::get<std::string>(anchor_value);
-                if (compare<std::string>(str_value, str_anchor_value, action))
-                {
-                    printf("  %s,\n", std::get<std::string>(value).c_str());
-                    return true;
-                }
-                return false;
-            };
-            break;
+            auto row_index = vec_selection[index];
+            if (isVersionVisible(vec_begin_ts_[row_index], vec_end_ts_[row_index], snapshot)) vec_selection[num_selected ++] = row_index;
         }
-        default:
+        vec_selection.resize(num_selected);
+
+        if (p_profile != nullptr)
         {
-            printf("Fail to select: invalid column type\n");
-            return false;
+            auto& filter = p_profile->getStage(EnumQueryStage::FILTER);
+            filter.num_row_in += row_end - row_begin;
+            filter.num_row_out += num_matched;
+            auto& visibility = p_profile->getStage(EnumQueryStage::VISIBILITY);
+            visibility.num_row_in += num_matched;
+            visibility.num_row_out += num_selected - selection_begin;
+            visibility.num_byte += num_matched * 2 * sizeof(Timestamp_t);
         }
+    };
+    return true;
+}
+
+bool SqlTable_t::getConditionFilter(const ConditionDescriptor_t& condition, RowFilter_t& row_filter)
+{
+    auto p_profile = getActiveProfile();
+    if (condition.action == EnumConditionActionType::IDLE)
+    {
+        if (p_profile != nullptr) p_profile->describeStage(EnumQueryStage::FILTER, "no condition, every row passes");
+        row_filter = [](uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)
+        {
+            for (uint32_t index = row_begin; index < row_end; index ++) vec_selection.emplace_back(index);
+        };
+        return true;
     }
 
-    printf("Select data from column \"%s\":\n", column_name.c_str());
-    uint32_t cnt_row = 0;
-    auto row_iter = vec_data_.begin();
-    while (row_iter != vec_data_.end())
+    uint32_t column_index;
+    if (!getColumnIndex(condition.column_name, column_index)) return false;
+
+    // the parser hands over the anchor as raw text, cast it to the column type once
+    SqlValue_t anchor_value = condition.anchor_val;
+    if (auto p_raw_anchor = std::get_if<std::string>(&condition.anchor_val))
+    {
+        if (!convertValue(*p_raw_anchor, vec_property_[column_index].value_type, anchor_value)) return false;
+    }
+
+    auto action = condition.action;
+    auto value_type = vec_property_[column_index].value_type;
+    if (action == EnumConditionActionType::LIKE && value_type != EnumValueType::VALUE_TYPE_STRING) return false;
+
+    auto& column = vec_column_[column_index];
+    column.refreshBlockFilter();
+
+    // the radix tree answers equality and prefix matches at once, batches then take their share of the sorted rows
+    bool is_art_lookup = column.hasArtIndex() && (action == EnumConditionActionType::EQ || action == EnumConditionActionType::LIKE);
+    StageProfile_t* p_stage = nullptr;
+    if (p_profile != nullptr)
+    {
+        bool is_bloom_probe = (action == EnumConditionActionType::EQ && column.hasBloomFilter());
+        p_profile->describeStage(EnumQueryStage::FILTER, describeCondition(condition.column_name, action, value_type, anchor_value)
+                                 + (is_art_lookup ? ", rows looked up in radix tree index" : std::string(", blocks pruned by zone map") + (is_bloom_probe ? " and bloom filter" : "")));
+        if (p_profile->isAnalyze()) p_stage = &p_profile->getStage(EnumQueryStage::FILTER);
+    }
+
+    if (is_art_lookup)
     {
-        if (printer_wrapper(*row_iter->data(), condition.anchor_val, condition.action))
+        auto& anchor = std::get<std::string>(anchor_value);
+        auto sp_matched_row = std::make_shared<std::vector<uint32_t>>();
+        if (action == EnumConditionActionType::EQ) column.getArtIndex().lookup(anchor, *sp_matched_row);
+        else column.getArtIndex().scanPrefix(anchor, *sp_matched_row);
+
+        row_filter = [sp_matched_row, p_stage](uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)
         {
-            cnt_row ++;
-        }
-        row_iter ++;
+            auto iter_begin = std::lower_bound(sp_matched_row->begin(), sp_matched_row->end(), row_begin);
+            auto iter_end = std::lower_bound(iter_begin, sp_matched_row->end(), row_end);
+            vec_selection.insert(vec_selection.end(), iter_begin, iter_end);
+            if (p_stage != nullptr) p_stage->num_byte += (iter_end - iter_begin) * sizeof(uint32_t);
+        };
+        return true;
     }
-    printf("%d row(s) selected\n", cnt_row);
 
-    return true;
+    switch (value_type)
+    {
+        case EnumValueType::VALUE_TYPE_INT:       return getColumnFilter<int32_t>(column, anchor_value, action, p_stage, row_filter);
+        case EnumValueType::VALUE_TYPE_STRING:    return getColumnFilter<std::string>(column, anchor_value, action, p_stage, row_filter);
+        case EnumValueType::VALUE_TYPE_BIGINT:
+        case EnumValueType::VALUE_TYPE_TIMESTAMP: return getColumnFilter<int64_t>(column, anchor_value, action, p_stage, row_filter);
+        case EnumValueType::VALUE_TYPE_DOUBLE:    return getColumnFilter<double>(column, anchor_value, action, p_stage, row_filter);
+        default:
+            return false;
+    }
 }
 
-bool SqlTable_t::insertRow(const std::vector<std::string>& value)
+bool SqlTable_t::verifyRowData(const SqlTransaction_t& txn, const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value)
 {
-    auto value_ = std::vector<SqlValue_t>{};
-    if (!verifyRowData(value, value_))
+    if (raw_value.empty() || raw_value.size() != vec_property_.size()) return false;
+
+    value.clear();
+    value.reserve(raw_value.size());
+    for (uint16_t index = 0; index < raw_value.size(); index ++)
     {
-        printf("Fail to insert: data verification failed\n");
-        return false;
+        SqlValue_t cell;
+        if (!convertValue(raw_value[index], vec_property_[index].value_type, cell)) return false;
+        value.emplace_back(std::move(cell));
+    }
+
+    // duplicate primary key, unless every other version of it is dead or deleted by this very transaction
+    auto range_primary = map_primary_index_.equal_range(value[primary_column_index_]);
+    for (auto iter = range_primary.first; iter != range_primary.second; iter ++)
+    {
+        auto end_ts = vec_end_ts_[iter->second];
+        if (!isVersionDead(end_ts) && end_ts != txn.snapshot.txn_id) return false;
     }
 
-    vec_data_.emplace_back(value_);
     return true;
 }
 
-bool SqlTable_t::deleteRow(const ConditionDescriptor_t& condition)
+void SqlTable_t::rebuildPrimaryIndex()
 {
-    uint32_t column_index;
-    if (!getColumnIndex(condition.column_name, column_index))
+    map_primary_index_.clear();
+    if (vec_column_.empty()) return;
+
+    // sorted first, every key then goes in right at the end of the tree instead of a search from its root
+    auto& primary_column = vec_column_[primary_column_index_];
+    std::vector<std::pair<SqlValue_t, uint32_t>> vec_key(primary_column.size());
+    for (uint32_t index = 0; index < primary_column.size(); index ++)
     {
-        printf("Fail to delete: column \"%s\" doesn\'t exist\n", condition.column_name.c_str());
-        return false;
+        vec_key[index] = {primary_column.getValue(index), index};
+    }
+    std::sort(vec_key.begin(), vec_key.end());
+    for (auto& [key, index] : vec_key)
+    {
+        map_primary_index_.emplace_hint(map_primary_index_.end(), std::move(key), index);
+    }
+}
+
+void SqlTable_t::writeCell(uint32_t row_index, uint32_t column_index, SqlValue_t&& value)
+{
+    if (column_index == primary_column_index_)
+    {
+        auto range_primary = map_primary_index_.equal_range(vec_column_[column_index].getValue(row_index));
+        for (auto iter = range_primary.first; iter != range_primary.second; iter ++)
+        {
+            if (iter->second != row_index) continue;
+            map_primary_index_.erase(iter);
+            break;
+        }
+        map_primary_index_.emplace(value, row_index);
     }
+    vec_column_[column_index].setValue(row_index, std::move(value));
+}
 
-    std::function<bool(const SqlValue_t&, const SqlValue_t&, const EnumConditionActionType&)> compare_wrapper;
-    switch (vec_property_[column_index].value_type)
+bool SqlTable_t::getValuePrinter(const EnumValueType value_type, ValuePrinter_t& value_printer)
+{
+    switch (value_type)
     {
         case EnumValueType::VALUE_TYPE_INT:
         {
-            compare_wrapper = [](const SqlValue_t& value, const SqlValue_t& anchor_value, const EnumConditionActionType& action)
+            value_printer = [](const SqlValue_t& value)
             {
-                auto int_value = std::get<int32_t>(value);
-                auto int_anchor_value = std::get<int32_t>(anchor_value);
-                return compare<int32_t>(int_value, int_anchor_value, action);
+                printf(" %d,", std::get<int32_t>(value));
             };
-            break;
+            return true;
         }
         case EnumValueType::VALUE_TYPE_STRING:
         {
-            compare_wrapper = [](const SqlValue_t& value, const SqlValue_t& anchor_value, const EnumConditionActionType& action)
+            value_printer = [](const SqlValue_t& value)
             {
-                auto str_value = std::get<std::string>(value);
-                auto str_anchor_value = std::get<std::string>(anchor_value);
-                return compare<std::string>(str_value, str_anchor_value, action);
+                printf(" %s,", std::get<std::string>(value).c_str());
             };
-            break;
+            return true;
         }
-        default:
+        case EnumValueType::VALUE_TYPE_BIGINT:
         {
-            printf("Fail to delete: invalid column type\n");
-            return false;
+            value_printer = [](const SqlValue_t& value)
+            {
+                printf(" %lld,", static_cast<long long>(std::get<int64_t>(value)));
+            };
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_DOUBLE:
+        {
+            value_printer = [](const SqlValue_t& value)
+            {
+                printf(" %.15g,", std::get<double>(value));
+            };
+            return true;
+        }
+        case EnumValueType::VALUE_TYPE_TIMESTAMP:
+        {
+            value_printer = [](const SqlValue_t& value)
+            {
+                printf(" %s,", formatTimestamp(std::get<int64_t>(value)).c_str());
+            };
+            return true;
         }
+        default:
+            return false;
     }
+}
 
-    uint32_t cnt_row = 0;
-    auto row_iter = vec_data_.begin();
-    while (row_iter != vec_data_.end())
+bool SqlTable_t::visitRow(const RowFilter_t& row_filter, uint32_t order_column_index, const EnumOrderDirection direction, size_t row_quota, const RowVisitor_t& row_visitor)
+{
+    auto visit_row = [&](const RowVisitor_t& visitor)
     {
-        if (compare_wrapper(*row_iter->data(), condition.anchor_val, condition.action))
+        if (row_quota == 0) return true;
+        if (direction == EnumOrderDirection::IDLE)
         {
-            row_iter = vec_data_.erase(row_iter);
-            cnt_row ++;
+            scanRow(row_filter, visitor);
+            return true;
         }
-        else
+        if (order_column_index == primary_column_index_)
         {
-            row_iter ++;
+            scanRowByPrimaryIndex(row_filter, direction, visitor);
+            return true;
         }
-    }
+        return sortRow(row_filter, order_column_index, direction, row_quota, visitor);
+    };
 
-    printf("%d row(s) deleted\n", cnt_row);
-    return true;
+    auto p_profile = getActiveProfile();
+    if (p_profile == nullptr) return visit_row(row_visitor);
+
+    // the same decisions as visit_row, spelled out
+    std::string str_direction = (direction == EnumOrderDirection::DESC) ? "desc" : "asc";
+    std::string str_access = "full scan of " + std::to_string(getRowNum()) + " row(s) in " + std::to_string((getRowNum() + EXEC_BLOCK_MASK) >> EXEC_BLOCK_BITS) + " block(s)";
+    if (row_quota == 0) str_access = "nothing, the limit is 0";
+    else if (direction == EnumOrderDirection::IDLE && row_quota != SIZE_MAX) str_access.append(", stops after " + std::to_string(row_quota) + " row(s)");
+    else if (direction != EnumOrderDirection::IDLE && order_column_index == primary_column_index_) str_access = "walk the primary key index " + str_direction;
+    else if (direction != EnumOrderDirection::IDLE && isTopNSort(row_quota)) str_access.append(", top-" + std::to_string(row_quota) + " heap on \"" + vec_property_[order_column_index].column_name + "\" " + str_direction);
+    else if (direction != EnumOrderDirection::IDLE) str_access.append(", external sort on \"" + vec_property_[order_column_index].column_name + "\" " + str_direction);
+    p_profile->describeStage(EnumQueryStage::ACCESS, str_access);
+    if (!p_profile->isAnalyze()) return true;
+
+    auto& access = p_profile->getStage(EnumQueryStage::ACCESS);
+    auto& visibility = p_profile->getStage(EnumQueryStage::VISIBILITY);
+    uint64_t num_visible = visibility.num_row_out;
+    bool is_visited;
+    {
+        ProfileStageGuard_t access_guard(p_profile, EnumQueryStage::ACCESS);
+        is_visited = visit_row([&](uint32_t row_index)
+        {
+            access.num_row_out ++;
+            return row_visitor(row_index);
+        });
+    }
+    access.num_row_in += visibility.num_row_out - num_visible;
+    return is_visited;
 }
 
-bool SqlTable_t::getColumnIndex(const std::string& column_name, uint32_t& index)
+void SqlTable_t::scanRow(const RowFilter_t& row_filter, const RowVisitor_t& row_visitor)
 {
-    for (uint16_t index_ = 0; index_ < vec_property_.size(); index_ ++)
+    std::vector<uint32_t> vec_selection;
+    vec_selection.reserve(EXEC_SCAN_BATCH_SIZE);
+
+    uint32_t num_row = getRowNum();
+    for (uint32_t row_begin = 0; row_begin < num_row; row_begin += EXEC_SCAN_BATCH_SIZE)
     {
-        if (column_name == vec_property_[index_].column_name)
+        vec_selection.clear();
+        row_filter(row_begin, std::min<uint32_t>(num_row, row_begin + EXEC_SCAN_BATCH_SIZE), vec_selection);
+        for (auto index : vec_selection)
         {
-            index = index_;
-            return true;
+            if (!row_visitor(index)) return;
         }
     }
+}
 
-    return false;
+void SqlTable_t::scanRowByPrimaryIndex(const RowFilter_t& row_filter, const EnumOrderDirection direction, const RowVisitor_t& row_visitor)
+{
+    std::vector<uint32_t> vec_selection;
+    auto visit_row = [&](uint32_t index)
+    {
+        vec_selection.clear();
+        row_filter(index, index + 1, vec_selection);
+        return vec_selection.empty() || row_visitor(index);
+    };
+
+    if (direction == EnumOrderDirection::DESC)
+    {
+        for (auto iter = map_primary_index_.rbegin(); iter != map_primary_index_.rend(); iter ++)
+        {
+            if (!visit_row(iter->second)) break;
+        }
+    }
+    else
+    {
+        for (auto iter = map_primary_index_.begin(); iter != map_primary_index_.end(); iter ++)
+        {
+            if (!visit_row(iter->second)) break;
+        }
+    }
 }
 
-bool SqlTable_t::verifyRowData(const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value)
+bool SqlTable_t::sortRow(const RowFilter_t& row_filter, uint32_t order_column_index, const EnumOrderDirection direction, size_t row_quota, const RowVisitor_t& row_visitor)
 {
-    if (raw_value.empty() || raw_value.size() != vec_property_.size()) return false;
+    auto& order_column = vec_column_[order_column_index];
 
-    value.clear();
-    for (uint16_t index = 0; index < value.size(); index ++)
+    // ties keep insertion order, so the ordering is total and the output deterministic
+    SqlValue_t lhs_decoded_value, rhs_decoded_value;
+    auto row_less = [&order_column, direction, &lhs_decoded_value, &rhs_decoded_value](uint32_t lhs, uint32_t rhs)
+    {
+        auto& lhs_value = order_column.getValue(lhs, lhs_decoded_value);
+        auto& rhs_value = order_column.getValue(rhs, rhs_decoded_value);
+        if (lhs_value != rhs_value)
+        {
+            return (direction == EnumOrderDirection::DESC) ? (rhs_value < lhs_value) : (lhs_value < rhs_value);
+        }
+        return lhs < rhs;
+    };
+
+    // bounded top-N: a max-heap of the best rows seen so far, its front is the first to be evicted
+    if (isTopNSort(row_quota))
     {
-        switch (vec_property_[index].value_type)
+        std::vector<uint32_t> vec_row_index;
+        vec_row_index.reserve(row_quota);
+        scanRow(row_filter, [&](uint32_t index)
         {
-            case EnumValueType::VALUE_TYPE_INT:
+            if (vec_row_index.size() < row_quota)
             {
-                try
-                {
-                    int32_t num_val = std::stoi(raw_value[index]);
-                    if (vec_property_[index].is_primary)
-                    {
-                        for (uint16_t index_ = 0; index_ < vec_data_.size(); index_ ++)
-                        {
-                            if (num_val == std::get<int32_t>(vec_data_[index_][index])) return false;  // duplicate primary key
-                        }
-                    }
-                    value.emplace_back(SqlValue_t{num_val});
-                }
-                catch (std::invalid_argument const &exception) { return false; }
-                catch (std::out_of_range const &exception) { return false; }
-                break;
+                vec_row_index.emplace_back(index);
+                std::push_heap(vec_row_index.begin(), vec_row_index.end(), row_less);
             }
-            case EnumValueType::VALUE_TYPE_STRING:
+            else if (row_less(index, vec_row_index.front()))
             {
-                if (vec_property_[index].is_primary)
-                {
-                    for (uint16_t index_ = 0; index_ < vec_data_.size(); index_ ++)
-                    {
-                        if (raw_value[index] == std::get<std::string>(vec_data_[index_][index])) return false;  // duplicate primary key
-                    }
-                }
-                value.emplace_back(SqlValue_t{raw_value[index]});
-                break;
+                std::pop_heap(vec_row_index.begin(), vec_row_index.end(), row_less);
+                vec_row_index.back() = index;
+                std::push_heap(vec_row_index.begin(), vec_row_index.end(), row_less);
             }
-            default: 
-                return false;
+            return true;
+        });
+        std::sort_heap(vec_row_index.begin(), vec_row_index.end(), row_less);
+
+        for (auto index : vec_row_index)
+        {
+            if (!row_visitor(index)) break;
         }
+        return true;
     }
 
-    return true;
+    // full sort, spills sorted runs to disk once the memory budget is exhausted
+    SqlExternalSort_t sorter(vec_property_[order_column_index].value_type, direction);
+    bool is_pushed = true;
+    scanRow(row_filter, [&](uint32_t index)
+    {
+        is_pushed = sorter.push(order_column.getValue(index, lhs_decoded_value), index);
+        return is_pushed;
+    });
+    if (!is_pushed || !sorter.finish()) return false;
+
+    // a run that fails to read back ends the rows early, the statement fails instead of returning fewer rows
+    uint32_t index;
+    while (sorter.next(index))
+    {
+        if (!row_visitor(index)) break;
+    }
+    return !sorter.isFailed();
 }
 
 bool SqlDatabase_t::createTable(const std::string& tb_name, const std::vector<TableColumnProperty_t>& vec_column_property)
@@ -277,6 +1720,12 @@ bool SqlDatabase_t::createTable(const std::string& tb_name, const std::vector<Ta
             return false;
         }
 
+        if (column_property.is_indexed && column_property.value_type != EnumValueType::VALUE_TYPE_STRING)
+        {
+            printf("Fail to create table: table \"%s\" indexes non-STRING column \"%s\"\n", tb_name.c_str(), column_property.column_name.c_str());
+            return false;
+        }
+
         set_name.emplace(column_property.column_name);
         num_primary += (column_property.is_primary) ? 1 : 0;
     }
@@ -313,12 +1762,36 @@ bool SqlDatabase_t::dropTable(const std::string& tb_name)
     return true;
 }
 
+SqlTable_t& SqlDatabase_t::restoreTable(const std::string& tb_name, const std::vector<TableColumnProperty_t>& vec_column_property)
+{
+    auto& table = map_table_[tb_name];
+    table.setProperty(vec_column_property);
+    return table;
+}
+
+void SqlDatabase_t::removeTable(const std::string& tb_name)
+{
+    map_table_.erase(tb_name);
+}
+
 SqlTable_t* SqlDatabase_t::getTableByName(const std::string& tb_name)
 {
     auto iter_tb = map_table_.find(tb_name);
     return (iter_tb == map_table_.end()) ? nullptr : &iter_tb->second;
 }
 
+void SqlDatabase_t::getAllTable(std::vector<SqlTable_t*>& vec_table)
+{
+    vec_table.clear();
+    for (auto& [tb_name, table] : map_table_) vec_table.emplace_back(&table);
+}
+
+void SqlDatabase_t::getAllTableName(std::vector<std::string>& vec_tb_name)
+{
+    vec_tb_name.clear();
+    for (auto& [tb_name, table] : map_table_) vec_tb_name.emplace_back(tb_name);
+}
+
 bool SqlSupreme_t::createDatabase(const std::string& db_name)
 {
     auto iter_db = map_database_.find(db_name);
@@ -343,11 +1816,41 @@ bool SqlSupreme_t::dropDatabase(const std::string& db_name)
         return false;
     }
 
-    map_database_.erase(db_name);
+    removeDatabase(db_name);
     printf("Drop database \"%s\"\n", db_name.c_str());
     return true;
 }
 
+SqlDatabase_t& SqlSupreme_t::restoreDatabase(const std::string& db_name)
+{
+    return map_database_[db_name];
+}
+
+void SqlSupreme_t::removeDatabase(const std::string& db_name)
+{
+    auto iter_db = map_database_.find(db_name);
+    if (iter_db == map_database_.end()) return;
+
+    if (p_db_in_use_ == &iter_db->second)
+    {
+        p_db_in_use_ = nullptr;
+        db_name_in_use_.clear();
+    }
+    map_database_.erase(iter_db);
+}
+
+SqlDatabase_t* SqlSupreme_t::getDatabaseByName(const std::string& db_name)
+{
+    auto iter_db = map_database_.find(db_name);
+    return (iter_db == map_database_.end()) ? nullptr : &iter_db->second;
+}
+
+void SqlSupreme_t::getAllDatabaseName(std::vector<std::string>& vec_db_name)
+{
+    vec_db_name.clear();
+    for (auto& [db_name, db] : map_database_) vec_db_name.emplace_back(db_name);
+}
+
 bool SqlSupreme_t::useDatabase(const std::string& db_name)
 {
     auto iter_db = map_database_.find(db_name);
@@ -358,6 +1861,7 @@ bool SqlSupreme_t::useDatabase(const std::string& db_name)
     }
 
     p_db_in_use_ = &iter_db->second;
+    db_name_in_use_ = db_name;
     printf("Use database \"%s\"\n", db_name.c_str());
     return true;
 }
@@ -1,8 +1,22 @@
 #pragma once
 
 #include "map"
+#include "type_traits"
+#include "functional"
 
 #include "def/sql_interface_def.h"
+#include "executor/executor_block.h"
+#include "executor/executor_sort.h"
+#include "executor/executor_join.h"
+#include "executor/executor_aggregate.h"
+#include "executor/executor_txn.h"
+#include "executor/executor_memory.h"
+
+#define EXEC_SCAN_BATCH_SIZE 1024
+#define EXEC_COLUMN_NONE     UINT32_MAX   // the "*" of COUNT(*)
+#define EXEC_MICROSECOND_PER_SECOND 1000000ll   // TIMESTAMP resolution
+
+static_assert(EXEC_BLOCK_ROW_NUM % EXEC_SCAN_BATCH_SIZE == 0, "a scan batch must not straddle two blocks");
 
 namespace sql::exec
 {
@@ -17,25 +31,118 @@ bool compare(const SqlType& value, const SqlType& anchor_value, const EnumCondit
         case EnumConditionActionType::EQ:   return value == anchor_value;
         case EnumConditionActionType::GTEQ: return value >= anchor_value;
         case EnumConditionActionType::GT:   return value >  anchor_value;
+        case EnumConditionActionType::LIKE:
+            if constexpr (std::is_same_v<SqlType, std::string>) return value.starts_with(anchor_value);
+            else return false;
         default: return false;
     }
 }
 
+bool convertValue(const std::string& raw_value, const EnumValueType value_type, SqlValue_t& value);
+
 class SqlTable_t
 {
 public:
-    bool selectData(const std::string& column_name);
-    bool selectData(const std::string& column_name, const ConditionDescriptor_t& condition);
-    bool insertRow(const std::vector<std::string>& value);
-    bool deleteRow(const ConditionDescriptor_t& condition);
-    inline void setProperty(const std::vector<TableColumnProperty_t>& vec_column_property) { vec_property_ = vec_column_property; }
+    using ValuePrinter_t = std::function<void(const SqlValue_t&)>;
+
+    // output columns of an aggregate select resolved against the schema, every partition of a table can share it
+    struct AggregatePlan_t
+    {
+        std::vector<ProjectionDescriptor_t>  vec_projection;
+        bool                                 has_group_column = false;
+        uint32_t                             group_column_index = 0;
+        std::vector<AggregateColumn_t>       vec_aggregate_column;      // column pointers are left empty
+        std::vector<uint32_t>                vec_aggregate_column_index;
+        std::vector<ValuePrinter_t>          vec_printer;
+        std::string                          str_column_name;
+    };
+
+    bool selectData(const Snapshot_t& snapshot, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, const LimitDescriptor_t& limit);
+    bool selectJoinData(const Snapshot_t& snapshot, const std::string& table_name, SqlTable_t& join_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition);
+    bool selectGroupData(const Snapshot_t& snapshot, const std::vector<ProjectionDescriptor_t>& vec_projection, const ConditionDescriptor_t& condition, const std::string& group_column_name);
+    bool insertRow(SqlTransaction_t& txn, const std::vector<std::string>& value);
+    // a run of inserts into this table, each row is verified on its own and a rejected one leaves nothing behind
+    uint32_t insertRows(SqlTransaction_t& txn, const std::vector<const std::vector<std::string>*>& vec_p_value, std::vector<uint8_t>& vec_is_inserted);
+    bool deleteRow(SqlTransaction_t& txn, const ConditionDescriptor_t& condition, uint32_t& num_deleted);
+    bool updateRow(SqlTransaction_t& txn, const std::vector<AssignmentDescriptor_t>& vec_assignment, const ConditionDescriptor_t& condition, uint32_t& num_updated);
+    void setProperty(const std::vector<TableColumnProperty_t>& vec_column_property);
+    inline const std::vector<TableColumnProperty_t>& getProperty() const { return vec_property_; }
+    inline uint32_t getPrimaryColumnIndex() const { return primary_column_index_; }
+
+    // building blocks of a select over a table split into partitions
+    bool getAggregatePlan(const std::vector<ProjectionDescriptor_t>& vec_projection, const std::string& group_column_name, AggregatePlan_t& plan);
+    bool aggregateData(const Snapshot_t& snapshot, const AggregatePlan_t& plan, const ConditionDescriptor_t& condition, std::vector<SqlGroupTable_t>& vec_group_table);
+    static void printGroupData(const AggregatePlan_t& plan, const std::vector<SqlGroupTable_t>& vec_group_table);
+    void getWantedColumn(const std::vector<ProjectionDescriptor_t>& vec_projection, const OrderDescriptor_t& order, std::vector<bool>& vec_is_wanted);
+    void getJoinWantedColumn(const std::string& table_name, SqlTable_t& join_table, const std::vector<ProjectionDescriptor_t>& vec_projection, const JoinDescriptor_t& join,
+                             std::vector<bool>& vec_is_wanted, std::vector<bool>& vec_is_join_wanted);
+    bool getJoinCondition(const std::string& table_name, SqlTable_t& join_table, const JoinDescriptor_t& join, const ConditionDescriptor_t& condition, uint32_t& condition_side, ConditionDescriptor_t& side_condition);
+    bool gatherRow(const Snapshot_t& snapshot, const std::vector<bool>& vec_is_wanted, const ConditionDescriptor_t& condition, const OrderDescriptor_t& order, size_t row_quota, std::vector<std::vector<SqlValue_t>>& vec_row);
+    void appendRow(std::vector<SqlValue_t>&& row);
+
+    // a checkpoint copies the live versions column by column, recovery fills the columns of an empty table the same way
+    // and then builds the indexes of every column once, different columns may be loaded and indexed on different threads
+    void getLiveRow(std::vector<uint32_t>& vec_row) const;
+    inline const SqlColumn_t& getColumn(uint32_t column_index) const { return vec_column_[column_index]; }
+    void beginBulkLoad();
+    inline SqlColumn_t& getLoadColumn(uint32_t column_index) { return vec_column_[column_index]; }
+    inline bool hasLoadIndex(uint32_t column_index) const { return column_index == primary_column_index_ || vec_property_[column_index].is_bloom || vec_property_[column_index].is_indexed; }
+    void buildLoadIndex(uint32_t column_index);
+    bool finishBulkLoad();
+
+    // called by the transaction manager once a transaction ends
+    void commitVersion(uint32_t row_index, const EnumWriteType write_type, Timestamp_t commit_ts);
+    void rollbackVersion(uint32_t row_index, const EnumWriteType write_type, const UndoValue_t* p_undo);
+    void collectGarbage();
+
+    // an estimate from container sizes, kept cheap enough to run after every insert
+    void getMemoryUsage(MemoryUsage_t& usage) const;
 
 private:
+    // appends the rows in [row_begin, row_end) that satisfy the condition to the selection vector
+    using RowFilter_t  = std::function<void(uint32_t row_begin, uint32_t row_end, std::vector<uint32_t>& vec_selection)>;
+    using RowVisitor_t = std::function<bool(uint32_t)>;   // returns false once no more rows are wanted
+
+    // a column of either side of a join, side 0 is this table and side 1 the joined one
+    struct JoinColumn_t
+    {
+        uint32_t  side;
+        uint32_t  column_index;
+    };
+
     std::vector<TableColumnProperty_t>    vec_property_;
-    std::vector<std::vector<SqlValue_t>>  vec_data_;
+    std::vector<SqlColumn_t>              vec_column_;   // column-major, a predicate only touches its own column
+
+    // every row is a version, alive from begin to end timestamp, see isVersionVisible()
+    std::vector<Timestamp_t>              vec_begin_ts_;
+    std::vector<Timestamp_t>              vec_end_ts_;
+    uint32_t                              num_dead_row_ = 0;
+
+    // ordered primary key index: key -> row position of every version with that key
+    uint32_t                              primary_column_index_ = 0;
+    std::multimap<SqlValue_t, uint32_t>   map_primary_index_;
+
+    SqlMemoryCharge_t                     memory_charge_;
+
+    inline uint32_t getRowNum() const { return vec_column_.empty() ? 0 : static_cast<uint32_t>(vec_column_[0].size()); }
+    inline bool isTopNSort(size_t row_quota) const { return row_quota <= getRowNum() && row_quota * sizeof(uint32_t) <= EXEC_SORT_MEMORY_LIMIT; }
 
     bool getColumnIndex(const std::string& column_name, uint32_t& index);
-    bool verifyRowData(const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value);
+    bool getProjection(const std::vector<ProjectionDescriptor_t>& vec_projection, std::vector<uint32_t>& vec_column_index);
+    bool getJoinColumn(const std::string& column_name, const std::string& table_name, SqlTable_t& join_table, const std::string& join_table_name, JoinColumn_t& join_column);
+    bool getRowFilter(const Snapshot_t& snapshot, const ConditionDescriptor_t& condition, RowFilter_t& row_filter);
+    bool getConditionFilter(const ConditionDescriptor_t& condition, RowFilter_t& row_filter);
+    bool verifyRowData(const SqlTransaction_t& txn, const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value);
+    bool appendVersion(SqlTransaction_t& txn, const std::vector<std::string>& raw_value, std::vector<SqlValue_t>& value);
+    void rebuildPrimaryIndex();
+    void writeCell(uint32_t row_index, uint32_t column_index, SqlValue_t&& value);   // keeps the primary key index in step
+    void syncMemory();
+    static bool getValuePrinter(const EnumValueType value_type, ValuePrinter_t& value_printer);
+
+    bool visitRow(const RowFilter_t& row_filter, uint32_t order_column_index, const EnumOrderDirection direction, size_t row_quota, const RowVisitor_t& row_visitor);
+    void scanRow(const RowFilter_t& row_filter, const RowVisitor_t& row_visitor);
+    void scanRowByPrimaryIndex(const RowFilter_t& row_filter, const EnumOrderDirection direction, const RowVisitor_t& row_visitor);
+    bool sortRow(const RowFilter_t& row_filter, uint32_t order_column_index, const EnumOrderDirection direction, size_t row_quota, const RowVisitor_t& row_visitor);
 
 };
 
@@ -44,8 +151,13 @@ class SqlDatabase_t
 public:
     bool createTable(const std::string& tb_name, const std::vector<TableColumnProperty_t>& vec_column_property);
     bool dropTable(const std::string& tb_name);
+    // recovery brings back what the log or a checkpoint holds, it was checked and reported when it first ran
+    SqlTable_t& restoreTable(const std::string& tb_name, const std::vector<TableColumnProperty_t>& vec_column_property);
+    void removeTable(const std::string& tb_name);
 
     SqlTable_t* getTableByName(const std::string& tb_name);
+    void getAllTable(std::vector<SqlTable_t*>& vec_table);
+    void getAllTableName(std::vector<std::string>& vec_tb_name);
 
 private:
     std::map<std::string, SqlTable_t>  map_table_;
@@ -57,11 +169,17 @@ public:
     bool createDatabase(const std::string& db_name);
     bool dropDatabase(const std::string& db_name);
     bool useDatabase(const std::string& db_name);
+    SqlDatabase_t& restoreDatabase(const std::string& db_name);
+    void removeDatabase(const std::string& db_name);
 
     SqlDatabase_t* getDatabaseInUse() { return p_db_in_use_; }
+    inline const std::string& getDatabaseNameInUse() const { return db_name_in_use_; }
+    SqlDatabase_t* getDatabaseByName(const std::string& db_name);
+    void getAllDatabaseName(std::vector<std::string>& vec_db_name);
 
 private:
     SqlDatabase_t*  p_db_in_use_ = nullptr;
+    std::string     db_name_in_use_;
     std::map<std::string, SqlDatabase_t>  map_database_;
 };
 
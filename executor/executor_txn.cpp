@@ -0,0 +1,64 @@
+#include "set"
+
+#include "executor/executor_txn.h"
+#include "executor/executor_sql.h"
+
+namespace sql::exec
+{
+
+SqlTransaction_t SqlTransactionManager_t::begin()
+{
+    num_active_txn_ ++;
+    return SqlTransaction_t{Snapshot_t{last_commit_ts_, EXEC_TS_TXN_FLAG | next_txn_id_ ++}, {}, {}};
+}
+
+void SqlTransactionManager_t::commit(SqlTransaction_t& txn)
+{
+    if (!txn.vec_write.empty())
+    {
+        Timestamp_t commit_ts = ++ last_commit_ts_;
+        for (auto& write : txn.vec_write) write.p_table->commitVersion(write.row_index, write.write_type, commit_ts);
+    }
+    finish(txn);
+}
+
+void SqlTransactionManager_t::rollback(SqlTransaction_t& txn)
+{
+    // newest first, so a row inserted and then deleted by the same transaction ends up never born
+    // and a cell updated twice gets back the value it had before the first update
+    for (auto iter = txn.vec_write.rbegin(); iter != txn.vec_write.rend(); iter ++)
+    {
+        auto p_undo = (iter->write_type == EnumWriteType::UPDATE) ? &txn.vec_undo[iter->undo_index] : nullptr;
+        iter->p_table->rollbackVersion(iter->row_index, iter->write_type, p_undo);
+    }
+    finish(txn);
+}
+
+void SqlTransactionManager_t::rollbackStatement(SqlTransaction_t& txn, size_t num_write, size_t num_undo)
+{
+    for (size_t write_index = txn.vec_write.size(); write_index > num_write; write_index --)
+    {
+        auto& write = txn.vec_write[write_index - 1];
+        auto p_undo = (write.write_type == EnumWriteType::UPDATE) ? &txn.vec_undo[write.undo_index] : nullptr;
+        write.p_table->rollbackVersion(write.row_index, write.write_type, p_undo);
+    }
+    txn.vec_write.resize(num_write);
+    txn.vec_undo.resize(num_undo);
+}
+
+void SqlTransactionManager_t::finish(SqlTransaction_t& txn)
+{
+    num_active_txn_ --;
+
+    // garbage collection moves rows, so it only runs while no transaction holds row positions
+    if (num_active_txn_ == 0)
+    {
+        std::set<SqlTable_t*> set_table;
+        for (auto& write : txn.vec_write) set_table.emplace(write.p_table);
+        for (auto p_table : set_table) p_table->collectGarbage();
+    }
+    txn.vec_write.clear();
+    txn.vec_undo.clear();
+}
+
+} // namespace sql::exec
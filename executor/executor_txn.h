@@ -0,0 +1,93 @@
+#pragma once
+
+#include "vector"
+#include "algorithm"
+#include "stdint.h"
+
+#include "def/sql_interface_def.h"
+
+#define EXEC_TS_TXN_FLAG          0x8000000000000000ull   // a timestamp with this bit is the id of an uncommitted transaction
+#define EXEC_TS_INFINITY          0x7fffffffffffffffull   // end timestamp of a version nobody has deleted
+#define EXEC_GC_DEAD_ROW_RATIO    4                       // collect a table once 1 / ratio of its versions are dead
+
+namespace sql::exec
+{
+
+class SqlTable_t;
+
+using Timestamp_t = uint64_t;
+
+// what a statement sees: versions committed at or before read_ts plus the writes of its own transaction
+struct Snapshot_t
+{
+    Timestamp_t  read_ts;
+    Timestamp_t  txn_id;
+};
+
+inline bool isVersionVisible(Timestamp_t begin_ts, Timestamp_t end_ts, const Snapshot_t& snapshot)
+{
+    bool is_born = (begin_ts == snapshot.txn_id) || ((begin_ts & EXEC_TS_TXN_FLAG) == 0 && begin_ts <= snapshot.read_ts);
+    bool is_dead = (end_ts == snapshot.txn_id) || ((end_ts & EXEC_TS_TXN_FLAG) == 0 && end_ts <= snapshot.read_ts);
+    return is_born && !is_dead;
+}
+
+// deleted by a committed transaction (or never committed at all), no future snapshot can see it
+inline bool isVersionDead(Timestamp_t end_ts)
+{
+    return (end_ts & EXEC_TS_TXN_FLAG) == 0 && end_ts != EXEC_TS_INFINITY;
+}
+
+enum class EnumWriteType
+{
+    IDLE = 0,
+    INSERT,
+    DELETE,
+    UPDATE,   // a cell rewritten in place, the old value waits in the undo log
+};
+
+struct WriteRecord_t
+{
+    SqlTable_t*    p_table;
+    uint32_t       row_index;
+    EnumWriteType  write_type;
+    uint32_t       undo_index = 0;   // of an update, into vec_undo of the transaction
+};
+
+struct UndoValue_t
+{
+    uint32_t    column_index;
+    SqlValue_t  old_value;
+};
+
+struct SqlTransaction_t
+{
+    Snapshot_t                  snapshot;
+    std::vector<WriteRecord_t>  vec_write;
+    std::vector<UndoValue_t>    vec_undo;
+};
+
+// hands out snapshots and commit timestamps, a transaction stamps its versions with its id until it commits
+class SqlTransactionManager_t
+{
+public:
+    SqlTransaction_t begin();
+    void commit(SqlTransaction_t& txn);
+    void rollback(SqlTransaction_t& txn);
+    void rollbackStatement(SqlTransaction_t& txn, size_t num_write, size_t num_undo);   // undoes the writes past the marks, the transaction stays open
+
+    // a read-only snapshot outside any transaction, its id matches no version
+    inline Snapshot_t getSnapshot() const { return Snapshot_t{last_commit_ts_, EXEC_TS_TXN_FLAG}; }
+
+    // recovery replays every table with a manager of its own, the versions it committed must stay visible to this one
+    inline Timestamp_t getLastCommitTs() const { return last_commit_ts_; }
+    inline void raiseCommitTs(Timestamp_t commit_ts) { last_commit_ts_ = std::max(last_commit_ts_, commit_ts); }
+
+private:
+    void finish(SqlTransaction_t& txn);
+
+    Timestamp_t                 last_commit_ts_ = 0;
+    Timestamp_t                 next_txn_id_ = 1;
+    uint32_t                    num_active_txn_ = 0;
+};
+
+} // namespace sql::exec
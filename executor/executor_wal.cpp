@@ -0,0 +1,300 @@
+#include "errno.h"
+#include "fcntl.h"
+#include "limits.h"
+#include "stdio.h"
+#include "string.h"
+#include "unistd.h"
+#include "sys/stat.h"
+
+#include "executor/executor_wal.h"
+#include "executor/executor_hash.h"
+#include "trace/sql_trace.h"
+
+namespace sql::exec
+{
+
+// lengths are stored in host order, the log is not meant to move between machines
+static void putFixed32(std::string& buffer, uint32_t value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static std::string getHeader()
+{
+    std::string header(EXEC_WAL_MAGIC);
+    header.push_back(static_cast<char>(EXEC_WAL_VERSION));
+    return header;
+}
+
+static bool getFixed32(const char*& p_cursor, const char* p_end, uint32_t& value)
+{
+    if (p_end - p_cursor < static_cast<ptrdiff_t>(sizeof(value))) return false;
+    memcpy(&value, p_cursor, sizeof(value));
+    p_cursor += sizeof(value);
+    return true;
+}
+
+std::string SqlWriteAheadLog_t::getFilePath(const std::string& dir_path, uint64_t generation)
+{
+    char file_path[PATH_MAX];
+    snprintf(file_path, sizeof(file_path), EXEC_WAL_FILE_FORMAT, dir_path.c_str(), static_cast<unsigned long long>(generation));
+    return file_path;
+}
+
+bool SqlWriteAheadLog_t::isPresent(const std::string& dir_path, uint64_t generation)
+{
+    return access(getFilePath(dir_path, generation).c_str(), F_OK) == 0;
+}
+
+bool SqlWriteAheadLog_t::open(const std::string& dir_path, uint64_t generation, bool is_sync_io, std::vector<std::vector<LogEntry_t>>& vec_group)
+{
+    close();
+    vec_group.clear();
+    if (mkdir(dir_path.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        printf("Fail to create data directory \"%s\": %s\n", dir_path.c_str(), strerror(errno));
+        return false;
+    }
+
+    file_path_ = getFilePath(dir_path, generation);
+    fd_ = ::open(file_path_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+    {
+        printf("Fail to open log \"%s\": %s\n", file_path_.c_str(), strerror(errno));
+        return false;
+    }
+
+    auto header = getHeader();
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0)
+    {
+        printf("Fail to open log \"%s\": %s\n", file_path_.c_str(), strerror(errno));
+        close();
+        return false;
+    }
+    begin_offset_ = header.size();
+    write_offset_ = begin_offset_;
+    num_group_ = 0;
+    if (file_stat.st_size == 0)
+    {
+        if (pwrite(fd_, header.data(), header.size(), 0) != static_cast<ssize_t>(header.size()) || fdatasync(fd_) != 0)
+        {
+            printf("Fail to write log \"%s\": %s\n", file_path_.c_str(), strerror(errno));
+            close();
+            return false;
+        }
+    }
+    else if (!readGroup(static_cast<uint64_t>(file_stat.st_size), vec_group))
+    {
+        close();
+        return false;
+    }
+    num_group_ = vec_group.size();
+
+    std::vector<iovec> vec_iovec;
+    for (auto& buffer : arr_buffer_)
+    {
+        buffer.resize(EXEC_WAL_BUFFER_BYTE);
+        vec_iovec.emplace_back(iovec{buffer.data(), buffer.size()});
+    }
+    io_ring_.open(EXEC_IO_QUEUE_DEPTH, vec_iovec, is_sync_io);
+
+    durable_lsn_ = write_offset_;
+    return true;
+}
+
+bool SqlWriteAheadLog_t::readGroup(uint64_t file_byte, std::vector<std::vector<LogEntry_t>>& vec_group)
+{
+    // the log since the last checkpoint is read whole, a checkpoint keeps it small
+    std::string content(file_byte, '\0');
+    uint64_t num_read = 0;
+    while (num_read < file_byte)
+    {
+        auto result = pread(fd_, content.data() + num_read, file_byte - num_read, static_cast<off_t>(num_read));
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0)
+        {
+            printf("Fail to read log \"%s\": %s\n", file_path_.c_str(), (result < 0) ? strerror(errno) : "file shrank");
+            return false;
+        }
+        num_read += static_cast<uint64_t>(result);
+    }
+
+    auto header = getHeader();
+    if (content.compare(0, header.size(), header) != 0)
+    {
+        printf("Fail to open log \"%s\": not a log file of this version\n", file_path_.c_str());
+        return false;
+    }
+
+    // a crash leaves at most the groups of the last write torn, everything from the first bad group on was never acknowledged
+    const char* p_end = content.data() + content.size();
+    const char* p_group = content.data() + header.size();
+    while (p_end - p_group >= EXEC_WAL_GROUP_HEADER)
+    {
+        uint32_t body_byte;
+        uint64_t checksum;
+        memcpy(&body_byte, p_group, sizeof(body_byte));
+        memcpy(&checksum, p_group + sizeof(body_byte), sizeof(checksum));
+        const char* p_cursor = p_group + EXEC_WAL_GROUP_HEADER;
+        if (static_cast<uint64_t>(p_end - p_cursor) < body_byte || getChecksum(p_cursor, body_byte) != checksum) break;
+
+        const char* p_body_end = p_cursor + body_byte;
+        std::vector<LogEntry_t> vec_entry;
+        bool is_valid = true;
+        while (is_valid && p_cursor < p_body_end)
+        {
+            auto& entry = vec_entry.emplace_back();
+            uint32_t db_name_byte, packet_byte;
+            is_valid = getFixed32(p_cursor, p_body_end, db_name_byte) && static_cast<uint64_t>(p_body_end - p_cursor) >= db_name_byte;
+            if (!is_valid) break;
+            entry.db_name.assign(p_cursor, db_name_byte);
+            p_cursor += db_name_byte;
+            is_valid = getFixed32(p_cursor, p_body_end, packet_byte) && static_cast<uint64_t>(p_body_end - p_cursor) >= packet_byte
+                    && trace::decodePacketBody(p_cursor, p_cursor + packet_byte, entry.packet);
+            p_cursor += packet_byte;
+        }
+        if (!is_valid)
+        {
+            printf("Fail to open log \"%s\": group at byte %llu passes its checksum but does not decode\n", file_path_.c_str(),
+                   static_cast<unsigned long long>(p_group - content.data()));
+            return false;
+        }
+
+        vec_group.emplace_back(std::move(vec_entry));
+        p_group = p_body_end;
+    }
+
+    write_offset_ = static_cast<uint64_t>(p_group - content.data());
+    if (write_offset_ == file_byte) return true;
+
+    printf("Log \"%s\" ends in a torn group, %llu byte(s) from byte %llu on are dropped\n", file_path_.c_str(),
+           static_cast<unsigned long long>(file_byte - write_offset_), static_cast<unsigned long long>(write_offset_));
+    if (ftruncate(fd_, static_cast<off_t>(write_offset_)) != 0 || fdatasync(fd_) != 0)
+    {
+        printf("Fail to cut log \"%s\": %s\n", file_path_.c_str(), strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void SqlWriteAheadLog_t::close()
+{
+    if (fd_ < 0) return;
+
+    flush();
+    io_ring_.close();
+    ::close(fd_);
+    fd_ = -1;
+    active_buffer_ = 0;
+    active_byte_ = 0;
+    is_writing_ = false;
+    is_broken_ = false;
+}
+
+uint64_t SqlWriteAheadLog_t::append(const std::vector<LogEntry_t>& vec_entry)
+{
+    if (is_broken_) return 0;
+
+    group_.assign(EXEC_WAL_GROUP_HEADER, '\0');
+    for (auto& entry : vec_entry) encodeEntry(entry.db_name, entry.packet);
+    return appendGroup();
+}
+
+uint64_t SqlWriteAheadLog_t::append(const std::string& db_name, const std::vector<const PacketCollection_t*>& vec_p_packet)
+{
+    if (is_broken_) return 0;
+
+    group_.assign(EXEC_WAL_GROUP_HEADER, '\0');
+    for (auto p_packet : vec_p_packet) encodeEntry(db_name, *p_packet);
+    return appendGroup();
+}
+
+void SqlWriteAheadLog_t::encodeEntry(const std::string& db_name, const PacketCollection_t& packet)
+{
+    putFixed32(group_, static_cast<uint32_t>(db_name.size()));
+    group_.append(db_name);
+    size_t length_offset = group_.size();
+    putFixed32(group_, 0);
+    trace::encodePacketBody(group_, packet);
+    uint32_t packet_byte = static_cast<uint32_t>(group_.size() - length_offset - sizeof(uint32_t));
+    memcpy(group_.data() + length_offset, &packet_byte, sizeof(packet_byte));
+}
+
+uint64_t SqlWriteAheadLog_t::appendGroup()
+{
+    uint32_t body_byte = static_cast<uint32_t>(group_.size() - EXEC_WAL_GROUP_HEADER);
+    uint64_t checksum = getChecksum(group_.data() + EXEC_WAL_GROUP_HEADER, body_byte);
+    memcpy(group_.data(), &body_byte, sizeof(body_byte));
+    memcpy(group_.data() + sizeof(body_byte), &checksum, sizeof(checksum));
+    num_group_ ++;
+
+    // a group never straddles two writes, the buffer filled so far goes out first
+    if (active_byte_ + group_.size() > EXEC_WAL_BUFFER_BYTE)
+    {
+        while (active_byte_ > 0 && !is_broken_) poll(is_writing_);
+    }
+    if (group_.size() > EXEC_WAL_BUFFER_BYTE)
+    {
+        flush();
+        if (is_broken_ || !io_ring_.submitWrite(fd_, EXEC_IO_BUFFER_NONE, group_.data(), static_cast<uint32_t>(group_.size()), write_offset_, true, write_offset_ + group_.size()))
+        {
+            is_broken_ = true;
+            return 0;
+        }
+        is_writing_ = true;
+        write_offset_ += group_.size();
+        uint64_t lsn = write_offset_;
+        flush();
+        return is_broken_ ? 0 : lsn;
+    }
+
+    memcpy(arr_buffer_[active_buffer_].data() + active_byte_, group_.data(), group_.size());
+    active_byte_ += static_cast<uint32_t>(group_.size());
+    uint64_t lsn = write_offset_ + active_byte_;
+    submitBuffer();
+    return lsn;
+}
+
+void SqlWriteAheadLog_t::poll(bool is_wait)
+{
+    vec_completion_.clear();
+    io_ring_.reap(vec_completion_, is_wait && is_writing_);
+    for (auto& completion : vec_completion_)
+    {
+        is_writing_ = false;
+        if (completion.result >= 0)
+        {
+            durable_lsn_ = completion.tag;
+            continue;
+        }
+
+        if (!is_broken_) printf("Fail to write log \"%s\": %s, later commits are not durable\n", file_path_.c_str(), strerror(static_cast<int>(-completion.result)));
+        is_broken_ = true;
+    }
+    submitBuffer();
+}
+
+void SqlWriteAheadLog_t::submitBuffer()
+{
+    // one write at a time, its fdatasync then covers every group before it
+    if (is_writing_ || active_byte_ == 0 || is_broken_) return;
+
+    uint64_t end_offset = write_offset_ + active_byte_;
+    if (!io_ring_.submitWrite(fd_, active_buffer_, arr_buffer_[active_buffer_].data(), active_byte_, write_offset_, true, end_offset))
+    {
+        is_broken_ = true;
+        return;
+    }
+    is_writing_ = true;
+    write_offset_ = end_offset;
+    active_buffer_ = (active_buffer_ + 1) % EXEC_WAL_BUFFER_NUM;
+    active_byte_ = 0;
+}
+
+void SqlWriteAheadLog_t::flush()
+{
+    while ((is_writing_ || active_byte_ > 0) && !is_broken_) poll(true);
+}
+
+} // namespace sql::exec
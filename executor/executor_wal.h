@@ -0,0 +1,81 @@
+#pragma once
+
+#include "string"
+#include "vector"
+#include "array"
+#include "stdint.h"
+
+#include "def/sql_interface_def.h"
+#include "executor/executor_io.h"
+
+#define EXEC_WAL_FILE_FORMAT    "%s/sql.%llu.wal"   // data directory and generation, a checkpoint starts the next generation
+#define EXEC_WAL_MAGIC          "SQLWAL"
+#define EXEC_WAL_VERSION        1
+#define EXEC_WAL_BUFFER_BYTE    (1u << 20)   // a group larger than a log buffer is written from its own memory
+#define EXEC_WAL_BUFFER_NUM     2            // one buffer is on its way to the disk while the next one fills
+#define EXEC_WAL_GROUP_HEADER   12           // body length and checksum
+
+namespace sql::exec
+{
+
+// a committed write statement and the database it ran in
+struct LogEntry_t
+{
+    std::string         db_name;
+    PacketCollection_t  packet;
+};
+
+// the log of committed write statements, one group per transaction, written on io_uring with a linked fdatasync
+// file layout: the magic, the version byte, then the groups back to back
+// group: body length (4 bytes), FNV-1a checksum of the body (8 bytes), then per entry the database name and the packet body, each after its length (4 bytes)
+// a log sequence number is the file offset a group ends at, the groups appended while one write is in flight go out together in the next one
+class SqlWriteAheadLog_t
+{
+public:
+    ~SqlWriteAheadLog_t() { close(); }
+
+    // hands back the groups an earlier run left in the log of the generation, a torn or corrupt tail is cut off and appends go after the rest
+    bool open(const std::string& dir_path, uint64_t generation, bool is_sync_io, std::vector<std::vector<LogEntry_t>>& vec_group);
+    void close();   // writes out and waits for every group appended so far
+    inline bool isOpen() const { return fd_ >= 0; }
+
+    // the sequence number the group becomes durable at, 0 once the log is broken
+    uint64_t append(const std::vector<LogEntry_t>& vec_entry);
+    // a group of packets that stay with the caller, they are encoded where they are instead of being copied into entries
+    uint64_t append(const std::string& db_name, const std::vector<const PacketCollection_t*>& vec_p_packet);
+    // reaps the write in flight and starts the next one, waits for the write in flight when is_wait
+    void poll(bool is_wait);
+
+    inline uint64_t getDurableLsn() const { return durable_lsn_; }
+    inline uint64_t getGroupByte() const { return write_offset_ + active_byte_ - begin_offset_; }   // of every group in the log, appended or found at open
+    inline uint64_t getGroupNum() const { return num_group_; }   // the same groups counted, the index the next one replays at
+    static std::string getFilePath(const std::string& dir_path, uint64_t generation);
+    static bool isPresent(const std::string& dir_path, uint64_t generation);
+    inline bool isBroken() const { return is_broken_; }   // a write failed, no later group is ever durable
+    inline bool isAsync() const { return io_ring_.isAsync(); }
+
+private:
+    bool readGroup(uint64_t file_byte, std::vector<std::vector<LogEntry_t>>& vec_group);
+    void encodeEntry(const std::string& db_name, const PacketCollection_t& packet);
+    uint64_t appendGroup();
+    void submitBuffer();
+    void flush();
+
+    int                                                 fd_ = -1;
+    std::string                                         file_path_;
+    SqlIoRing_t                                         io_ring_;
+    std::vector<IoCompletion_t>                         vec_completion_;
+
+    std::array<std::vector<char>, EXEC_WAL_BUFFER_NUM>  arr_buffer_;       // registered with the ring, never resized after open()
+    uint32_t                                            active_buffer_ = 0;
+    uint32_t                                            active_byte_ = 0;
+    std::string                                         group_;            // the group being encoded, reused by every append
+    uint64_t                                            begin_offset_ = 0; // where the first group starts, after the header
+    uint64_t                                            write_offset_ = 0; // where the active buffer goes in the file
+    uint64_t                                            num_group_ = 0;
+    bool                                                is_writing_ = false;
+    uint64_t                                            durable_lsn_ = 0;
+    bool                                                is_broken_ = false;
+};
+
+} // namespace sql::exec
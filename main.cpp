@@ -1,11 +1,50 @@
 #include "stdlib.h"
+#include "string.h"
 
 #include "common/sql_app.h"
+#include "trace/sql_span.h"
 
 int main(int argc, char* argv[])
 {
+    // --shard N runs N pinned executor threads, each owning a primary key hash partition of every table
+    // --stats-file PATH rewrites PATH with the engine statistics every --stats-interval SEC seconds
+    // --perf-counters reads cycles, instructions and cache, branch and TLB misses around every statement
+    // --memory-limit MB rejects inserts once table storage holds MB megabytes
+    // --capture PATH records every statement into a trace for sql_replay
+    // --span-trace PATH writes a timeline of every statement in Chrome trace format
+    // --data-dir PATH logs every committed write to PATH before acknowledging its commit
+    // --sync-io writes that log with blocking calls instead of io_uring
+    // --checkpoint-mb MB copies every table to PATH once the log grows past MB megabytes, 0 only does so at exit
+    sql::exec::ExecutorOption_t option;
+    std::string capture_path;
+    std::string span_trace_path;
+    for (int index = 1; index < argc; index ++)
+    {
+        bool has_value = (index + 1 < argc);
+        if (strcmp(argv[index], "--perf-counters") == 0) option.is_perf_counter = true;
+        else if (has_value && strcmp(argv[index], "--shard") == 0) option.num_shard = static_cast<uint32_t>(atoi(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--stats-file") == 0) option.stats_file_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--stats-interval") == 0) option.stats_interval_sec = static_cast<uint32_t>(atoi(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--memory-limit") == 0) option.memory_limit_mb = static_cast<uint32_t>(atoi(argv[++ index]));
+        else if (has_value && strcmp(argv[index], "--capture") == 0) capture_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--span-trace") == 0) span_trace_path = argv[++ index];
+        else if (has_value && strcmp(argv[index], "--data-dir") == 0) option.data_dir_path = argv[++ index];
+        else if (strcmp(argv[index], "--sync-io") == 0) option.is_sync_io = true;
+        else if (has_value && strcmp(argv[index], "--checkpoint-mb") == 0) option.checkpoint_log_mb = static_cast<uint32_t>(atoi(argv[++ index]));
+        else
+        {
+            printf("Unknown option \"%s\"\n", argv[index]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!span_trace_path.empty() && !sql::trace::SqlSpanTracer_t::getInstance().start(span_trace_path))
+    {
+        return EXIT_FAILURE;
+    }
+
     sql::SqlApp sql_app;
-    if (!sql_app.init())
+    if (!sql_app.init(option, capture_path))
     {
         return EXIT_FAILURE;
     }
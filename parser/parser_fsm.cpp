@@ -1,11 +1,13 @@
 #include "algorithm"
+#include "stdexcept"
 
 #include "parser/parser_fsm.h"
+#include "trace/sql_span.h"
 
 namespace sql::fsm
 {
 
-bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq, std::shared_ptr<bool>& sp_app_running)
+bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>& sp_flq, std::shared_ptr<bool>& sp_app_running)
 {
     sp_lfq_ = sp_flq;
     sp_app_running_ = sp_app_running;
@@ -18,14 +20,39 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
         && registerParam("USE",      EnumParserParamType::KW_USE)
         && registerParam("TABLE",    EnumParserParamType::KW_TABLE)
         && registerParam("PRIMARY",  EnumParserParamType::KW_PRIMARY)
+        && registerParam("BLOOM",    EnumParserParamType::KW_BLOOM)
+        && registerParam("INDEX",    EnumParserParamType::KW_INDEX)
         && registerParam("SELECT",   EnumParserParamType::KW_SELECT)
         && registerParam("FROM",     EnumParserParamType::KW_FROM)
         && registerParam("WHERE",    EnumParserParamType::KW_WHERE)
+        && registerParam("LIKE",     EnumParserParamType::KW_LIKE)
         && registerParam("DELETE",   EnumParserParamType::KW_DELETE)
         && registerParam("INSERT",   EnumParserParamType::KW_INSERT)
+        && registerParam("UPDATE",   EnumParserParamType::KW_UPDATE)
+        && registerParam("SET",      EnumParserParamType::KW_SET)
         && registerParam("VALUES",   EnumParserParamType::KW_VALUES)
         && registerParam("INT",      EnumParserParamType::KW_VALTYPE)
         && registerParam("STRING",   EnumParserParamType::KW_VALTYPE)
+        && registerParam("BIGINT",   EnumParserParamType::KW_VALTYPE)
+        && registerParam("DOUBLE",   EnumParserParamType::KW_VALTYPE)
+        && registerParam("TIMESTAMP", EnumParserParamType::KW_VALTYPE)
+        && registerParam("ORDER",    EnumParserParamType::KW_ORDER)
+        && registerParam("BY",       EnumParserParamType::KW_BY)
+        && registerParam("ASC",      EnumParserParamType::KW_DIRECTION)
+        && registerParam("DESC",     EnumParserParamType::KW_DIRECTION)
+        && registerParam("LIMIT",    EnumParserParamType::KW_LIMIT)
+        && registerParam("OFFSET",   EnumParserParamType::KW_OFFSET)
+        && registerParam("GROUP",    EnumParserParamType::KW_GROUP)
+        && registerParam("JOIN",     EnumParserParamType::KW_JOIN)
+        && registerParam("ON",       EnumParserParamType::KW_ON)
+        && registerParam("BEGIN",    EnumParserParamType::KW_TRANSACTION)
+        && registerParam("COMMIT",   EnumParserParamType::KW_TRANSACTION)
+        && registerParam("ROLLBACK", EnumParserParamType::KW_TRANSACTION)
+        && registerParam("EXPLAIN",  EnumParserParamType::KW_EXPLAIN)
+        && registerParam("ANALYZE",  EnumParserParamType::KW_ANALYZE)
+        && registerParam("SHOW",     EnumParserParamType::KW_SHOW)
+        && registerParam("STATS",    EnumParserParamType::KW_SHOW_TARGET)
+        && registerParam("MEMORY",   EnumParserParamType::KW_SHOW_TARGET)
         && registerParam("EXIT",     EnumParserParamType::LOCAL_EXIT);
 
     if (!flag_register_param)
@@ -64,7 +91,7 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 auto p_carrier = verifyCarrier<PacketCreateDatabase_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -92,7 +119,7 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -133,7 +160,7 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -189,7 +216,89 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // a column with bloom filters
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME, EnumParserParamType::KW_BLOOM},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                auto& column = p_carrier->vec_column_property.back();
+                column.is_bloom = true;
+
+                return true; 
+            }}
+        )
+        // start a new column just after a bloom column
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                TableColumnProperty_t column;
+                column.column_name = this->context_.cur_param;
+                p_carrier->vec_column_property.emplace_back(column);
+
+                return true; 
+            }}
+        )
+        // end with a bloom column
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_BLOOM_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // a column with a radix tree index
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME, EnumParserParamType::KW_INDEX},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                auto& column = p_carrier->vec_column_property.back();
+                column.is_indexed = true;
+
+                return true; 
+            }}
+        )
+        // start a new column just after an indexed column
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                TableColumnProperty_t column;
+                column.column_name = this->context_.cur_param;
+                p_carrier->vec_column_property.emplace_back(column);
+
+                return true; 
+            }}
+        )
+        // end with an indexed column
+        && registerTransition(
+            TransitionKey_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::CREATE_TABLE_TBNAME_COLUMNNAME_TYPENAME_INDEX_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketCreateTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -207,125 +316,541 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
             TransitionKey_t{EnumParserState::DROP_DATABASE, EnumParserParamType::VALUE_OR_NAME},
             TransitionProperty_t{EnumParserState::DROP_DATABASE_DBNAME, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketDropDatabase_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketDropDatabase_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->db_name = this->context_.cur_param;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DROP_DATABASE_DBNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::DROP_DATABASE_DBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDropDatabase_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // drop table
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DROP, EnumParserParamType::KW_TABLE},
+            TransitionProperty_t{EnumParserState::DROP_TABLE, PacketCollection_t{PacketDropTable_t{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DROP_TABLE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::DROP_TABLE_TBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDropTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->table_name = this->context_.cur_param;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DROP_TABLE_TBNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::DROP_TABLE_TBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDropTable_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // use database
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_USE},
+            TransitionProperty_t{EnumParserState::USE, PacketCollection_t{PacketUseDatabase_t{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::USE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::USE_DBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUseDatabase_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->db_name = this->context_.cur_param;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::USE_DBNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::USE_DBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUseDatabase_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // begin / commit / rollback
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_TRANSACTION},
+            TransitionProperty_t{EnumParserState::TRANSACTION, PacketCollection_t{PacketTransaction_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketTransaction_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->action = FsmParser::getTransactionAction(this->context_.cur_param);
+                if (p_carrier->action == EnumTransactionActionType::IDLE) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::TRANSACTION, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::TRANSACTION_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketTransaction_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // explain [analyze], followed by a select, a delete or an update that carries the explain type
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_EXPLAIN},
+            TransitionProperty_t{EnumParserState::EXPLAIN, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN, EnumParserParamType::KW_ANALYZE},
+            TransitionProperty_t{EnumParserState::EXPLAIN_ANALYZE, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN, EnumParserParamType::KW_SELECT},
+            TransitionProperty_t{EnumParserState::SELECT, PacketCollection_t{PacketSelect_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::PLAN;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN, EnumParserParamType::KW_DELETE},
+            TransitionProperty_t{EnumParserState::DELETE, PacketCollection_t{PacketDelect_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::PLAN;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN_ANALYZE, EnumParserParamType::KW_SELECT},
+            TransitionProperty_t{EnumParserState::SELECT, PacketCollection_t{PacketSelect_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::ANALYZE;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN_ANALYZE, EnumParserParamType::KW_DELETE},
+            TransitionProperty_t{EnumParserState::DELETE, PacketCollection_t{PacketDelect_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::ANALYZE;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN, EnumParserParamType::KW_UPDATE},
+            TransitionProperty_t{EnumParserState::UPDATE, PacketCollection_t{PacketUpdate_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::PLAN;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::EXPLAIN_ANALYZE, EnumParserParamType::KW_UPDATE},
+            TransitionProperty_t{EnumParserState::UPDATE, PacketCollection_t{PacketUpdate_t{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->explain = EnumExplainType::ANALYZE;
+
+                return true;
+            }}
+        )
+        // show
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_SHOW},
+            TransitionProperty_t{EnumParserState::SHOW, PacketCollection_t{PacketShow_t{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SHOW, EnumParserParamType::KW_SHOW_TARGET},
+            TransitionProperty_t{EnumParserState::SHOW_TARGET, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketShow_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->target = FsmParser::getShowTarget(this->context_.cur_param);
+                if (p_carrier->target == EnumShowTargetType::IDLE) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SHOW_TARGET, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SHOW_TARGET_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketShow_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // select
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_SELECT},
+            TransitionProperty_t{EnumParserState::SELECT, PacketCollection_t{PacketSelect_t{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this](){ 
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseProjectionList(this->context_.cur_param, p_carrier->vec_projection)) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this](){ 
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseProjectionList(this->context_.cur_param, p_carrier->vec_projection)) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME, EnumParserParamType::KW_FROM},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM, PacketCollection_t{std::monostate{}}, [this](){ 
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                if (p_carrier->vec_projection.empty())
+                {
+                    this->context_.error_indication = EnumParserErrorIndication::NO_TRANSITION;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, PacketCollection_t{std::monostate{}}, [this](){ 
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->table_name = this->context_.cur_param;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_WHERE},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseCondition(this->context_.cur_param, p_carrier->condition)) return false;
+
+                return true;
+            }}
+        )
+        // a prefix match, the condition so far is a bare column name
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, EnumParserParamType::KW_LIKE},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_LIKE, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (p_carrier->condition.action != EnumConditionActionType::IDLE)
+                {
+                    context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_LIKE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseLikePattern(this->context_.cur_param, p_carrier->condition)) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!verifyCondition(p_carrier->condition)) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // select ... order by
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_ORDER},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, EnumParserParamType::KW_ORDER},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                return p_carrier != nullptr && verifyCondition(p_carrier->condition);
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER, EnumParserParamType::KW_BY},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER_BY, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->order.column_name = this->context_.cur_param;
+                p_carrier->order.direction = EnumOrderDirection::ASC;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME, EnumParserParamType::KW_DIRECTION},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME_DIRECTION, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->order.direction = FsmParser::getOrderDirection(this->context_.cur_param);
+                if (p_carrier->order.direction == EnumOrderDirection::IDLE) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME_DIRECTION, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME_DIRECTION_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // select ... limit
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_LIMIT},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, EnumParserParamType::KW_LIMIT},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                return p_carrier != nullptr && verifyCondition(p_carrier->condition);
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME, EnumParserParamType::KW_LIMIT},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_ORDER_BY_COLUMNNAME_DIRECTION, EnumParserParamType::KW_LIMIT},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_LIMIT, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT_NUM, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
-                p_carrier->db_name = this->context_.cur_param;
+                if (!parseNumber(this->context_.cur_param, p_carrier->limit.count)) return false;
+                p_carrier->limit.is_limited = true;
 
                 return true;
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::DROP_DATABASE_DBNAME, EnumParserParamType::END_MARKER},
-            TransitionProperty_t{EnumParserState::DROP_DATABASE_DBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_LIMIT_NUM, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT_NUM_END, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketDropDatabase_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
-        // drop table
         && registerTransition(
-            TransitionKey_t{EnumParserState::DROP, EnumParserParamType::KW_TABLE},
-            TransitionProperty_t{EnumParserState::DROP_TABLE, PacketCollection_t{PacketDropTable_t{}}, [this](){ return true; }}
+            TransitionKey_t{EnumParserState::SELECT_LIMIT_NUM, EnumParserParamType::KW_OFFSET},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT_NUM_OFFSET, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::DROP_TABLE, EnumParserParamType::VALUE_OR_NAME},
-            TransitionProperty_t{EnumParserState::DROP_TABLE_TBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_LIMIT_NUM_OFFSET, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT_NUM_OFFSET_NUM, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketDropTable_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
-                p_carrier->table_name = this->context_.cur_param;
+                if (!parseNumber(this->context_.cur_param, p_carrier->limit.offset)) return false;
 
                 return true;
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::DROP_TABLE_TBNAME, EnumParserParamType::END_MARKER},
-            TransitionProperty_t{EnumParserState::DROP_TABLE_TBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_LIMIT_NUM_OFFSET_NUM, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_LIMIT_NUM_OFFSET_NUM_END, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketDropTable_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
-        // use database
+        // select ... group by
         && registerTransition(
-            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_USE},
-            TransitionProperty_t{EnumParserState::USE, PacketCollection_t{PacketUseDatabase_t{}}, [this](){ return true; }}
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_GROUP},
+            TransitionProperty_t{EnumParserState::SELECT_GROUP, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::USE, EnumParserParamType::VALUE_OR_NAME},
-            TransitionProperty_t{EnumParserState::USE_DBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, EnumParserParamType::KW_GROUP},
+            TransitionProperty_t{EnumParserState::SELECT_GROUP, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketUseDatabase_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                return p_carrier != nullptr && verifyCondition(p_carrier->condition);
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_GROUP, EnumParserParamType::KW_BY},
+            TransitionProperty_t{EnumParserState::SELECT_GROUP_BY, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_GROUP_BY, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_GROUP_BY_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
-                p_carrier->db_name = this->context_.cur_param;
+                p_carrier->group_column_name = this->context_.cur_param;
 
                 return true;
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::USE_DBNAME, EnumParserParamType::END_MARKER},
-            TransitionProperty_t{EnumParserState::USE_DBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_GROUP_BY_COLUMNNAME, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_GROUP_BY_COLUMNNAME_END, PacketCollection_t{std::monostate{}}, [this]()
             {
-                auto p_carrier = verifyCarrier<PacketUseDatabase_t>(this->context_.data_carrier);
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
-        // select
+        // select ... join ... on
         && registerTransition(
-            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_SELECT},
-            TransitionProperty_t{EnumParserState::SELECT, PacketCollection_t{PacketSelect_t{}}, [this](){ return true; }}
+            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_JOIN},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT, EnumParserParamType::VALUE_OR_NAME},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME, PacketCollection_t{std::monostate{}}, [this](){ 
+            TransitionKey_t{EnumParserState::SELECT_JOIN, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
                 auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
-                p_carrier->column_name = this->context_.cur_param;
+                p_carrier->join.table_name = this->context_.cur_param;
 
                 return true;
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME, EnumParserParamType::KW_FROM},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME, EnumParserParamType::KW_ON},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM, EnumParserParamType::VALUE_OR_NAME},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, PacketCollection_t{std::monostate{}}, [this](){ 
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
                 auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
-                p_carrier->table_name = this->context_.cur_param;
+                if (!parseJoinCondition(this->context_.cur_param, p_carrier->join)) return false;
 
                 return true;
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::END_MARKER},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_END, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_END, PacketCollection_t{std::monostate{}}, [this]()
             {
                 auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME, EnumParserParamType::KW_WHERE},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND, EnumParserParamType::KW_WHERE},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
         )
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE, EnumParserParamType::VALUE_OR_NAME},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
             {
                 auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
@@ -334,14 +859,42 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 return true;
             }}
         )
+        // a prefix match, the condition so far is a bare column name
         && registerTransition(
-            TransitionKey_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE, EnumParserParamType::END_MARKER},
-            TransitionProperty_t{EnumParserState::SELECT_COLUMNNAME_FROM_TBNAME_WHERE_COND_END, PacketCollection_t{std::monostate{}}, [this]()
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND, EnumParserParamType::KW_LIKE},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND_LIKE, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (p_carrier->condition.action != EnumConditionActionType::IDLE)
+                {
+                    context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND_LIKE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
             {
                 auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
+                if (!parseLikePattern(this->context_.cur_param, p_carrier->condition)) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::SELECT_JOIN_TBNAME_ON_COND_WHERE_COND_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketSelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!verifyCondition(p_carrier->condition)) return false;
+
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -376,14 +929,150 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 return true;
             }}
         )
+        // a prefix match, the condition so far is a bare column name
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DELETE_TBNAME_WHERE_COND, EnumParserParamType::KW_LIKE},
+            TransitionProperty_t{EnumParserState::DELETE_TBNAME_WHERE_COND_LIKE, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (p_carrier->condition.action != EnumConditionActionType::IDLE)
+                {
+                    context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::DELETE_TBNAME_WHERE_COND_LIKE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::DELETE_TBNAME_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketDelect_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseLikePattern(this->context_.cur_param, p_carrier->condition)) return false;
+
+                return true;
+            }}
+        )
         && registerTransition(
             TransitionKey_t{EnumParserState::DELETE_TBNAME_WHERE_COND, EnumParserParamType::END_MARKER},
             TransitionProperty_t{EnumParserState::DELETE_TBNAME_WHERE_COND_END, PacketCollection_t{std::monostate{}}, [this]()
             {
                 auto p_carrier = verifyCarrier<PacketDelect_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
+                if (!verifyCondition(p_carrier->condition)) return false;
+
+                sendToExecutor(this->context_.data_carrier);
+                return true; 
+            }}
+        )
+        // update
+        && registerTransition(
+            TransitionKey_t{EnumParserState::IDLE, EnumParserParamType::KW_UPDATE},
+            TransitionProperty_t{EnumParserState::UPDATE, PacketCollection_t{PacketUpdate_t{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                p_carrier->table_name = this->context_.cur_param;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME, EnumParserParamType::KW_SET},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET, PacketCollection_t{std::monostate{}}, [this](){ return true; }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseAssignmentList(this->context_.cur_param, p_carrier->vec_assignment)) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseAssignmentList(this->context_.cur_param, p_carrier->vec_assignment)) return false;
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN, EnumParserParamType::KW_WHERE},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                // a lone "," leaves no assignment behind
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (p_carrier->vec_assignment.empty())
+                {
+                    context_.error_indication = EnumParserErrorIndication::INVALID_ASSIGNMENT;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseCondition(this->context_.cur_param, p_carrier->condition)) return false;
+
+                return true;
+            }}
+        )
+        // a prefix match, the condition so far is a bare column name
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND, EnumParserParamType::KW_LIKE},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND_LIKE, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (p_carrier->condition.action != EnumConditionActionType::IDLE)
+                {
+                    context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+                    return false;
+                }
+
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND_LIKE, EnumParserParamType::VALUE_OR_NAME},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!parseLikePattern(this->context_.cur_param, p_carrier->condition)) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                return true;
+            }}
+        )
+        && registerTransition(
+            TransitionKey_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND, EnumParserParamType::END_MARKER},
+            TransitionProperty_t{EnumParserState::UPDATE_TBNAME_SET_ASSIGN_WHERE_COND_END, PacketCollection_t{std::monostate{}}, [this]()
+            {
+                auto p_carrier = verifyCarrier<PacketUpdate_t>(this->context_.data_carrier);
+                if (p_carrier == nullptr) return false;
+                if (!verifyCondition(p_carrier->condition)) return false;
+
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -436,7 +1125,7 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
                 auto p_carrier = verifyCarrier<PacketInsert_t>(this->context_.data_carrier);
                 if (p_carrier == nullptr) return false;
 
-                sendToExecutor(PacketCollection_t{*p_carrier});
+                sendToExecutor(this->context_.data_carrier);
                 return true; 
             }}
         )
@@ -465,10 +1154,13 @@ bool FsmParser::init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq,
 
 bool FsmParser::parseInput(std::vector<std::string>& params)
 {
+    trace::SpanGuard_t span("parse", "parser");
+
     // reset context
     context_.cur_state        = EnumParserState::IDLE;
     context_.error_indication = EnumParserErrorIndication::IDLE;
     context_.cur_param        = "";
+    if (std::holds_alternative<std::monostate>(envelope_.packet)) std::swap(envelope_.packet, context_.data_carrier);   // left by a failed command
     context_.data_carrier     = std::monostate{};
 
     for (auto& param_string : params)
@@ -535,6 +1227,14 @@ bool FsmParser::parseCondition(std::string& str_condition, ConditionDescriptor_t
         }
     }
 
+    // a bare column name is completed by a following LIKE
+    if (!column_name.empty() && op1.empty())
+    {
+        condition.column_name = std::move(column_name);
+        condition.action = EnumConditionActionType::IDLE;
+        return true;
+    }
+
     if (column_name.empty() || op1.empty() || value.empty())
     {
         context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
@@ -559,6 +1259,148 @@ bool FsmParser::parseCondition(std::string& str_condition, ConditionDescriptor_t
     return true;
 }
 
+// abc% matches the values starting with abc and abc matches abc alone, the pattern may be quoted with '
+bool FsmParser::parseLikePattern(std::string& str_pattern, ConditionDescriptor_t& condition)
+{
+    std::string pattern = str_pattern;
+    if (pattern.size() >= 2 && pattern.front() == '\'' && pattern.back() == '\'') pattern = pattern.substr(1, pattern.size() - 2);
+
+    bool is_prefix = !pattern.empty() && pattern.back() == '%';
+    if (is_prefix) pattern.pop_back();
+    if (pattern.find_first_of("%_") != std::string::npos)
+    {
+        context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+        return false;
+    }
+
+    condition.action = is_prefix ? EnumConditionActionType::LIKE : EnumConditionActionType::EQ;
+    condition.anchor_val = std::move(pattern);
+    return true;
+}
+
+// a condition left as a bare column name was never completed
+bool FsmParser::verifyCondition(const ConditionDescriptor_t& condition)
+{
+    if (condition.action != EnumConditionActionType::IDLE) return true;
+
+    context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+    return false;
+}
+
+bool FsmParser::parseJoinCondition(std::string& str_condition, JoinDescriptor_t& join)
+{
+    ConditionDescriptor_t condition;
+    if (!parseCondition(str_condition, condition)) return false;
+
+    auto p_rhs_column_name = std::get_if<std::string>(&condition.anchor_val);
+    if (condition.action != EnumConditionActionType::EQ || p_rhs_column_name == nullptr)
+    {
+        context_.error_indication = EnumParserErrorIndication::INVALID_CONDITION;
+        return false;
+    }
+
+    join.lhs_column_name = std::move(condition.column_name);
+    join.rhs_column_name = std::move(*p_rhs_column_name);
+    return true;
+}
+
+bool FsmParser::parseProjectionList(std::string& str_projection, std::vector<ProjectionDescriptor_t>& vec_projection)
+{
+    // a token may hold several comma separated items, e.g. "a,COUNT(*)," or ","
+    std::string item = "";
+    auto append_item = [&]()
+    {
+        if (item.empty()) return true;
+
+        ProjectionDescriptor_t projection;
+        auto pos_open = item.find('(');
+        if (pos_open == std::string::npos)
+        {
+            projection.column_name = std::move(item);
+        }
+        else
+        {
+            if (item.back() != ')' || pos_open + 2 >= item.size())
+            {
+                context_.error_indication = EnumParserErrorIndication::INVALID_PROJECTION;
+                return false;
+            }
+
+            projection.aggregate = FsmParser::getAggregateType(item.substr(0, pos_open));
+            projection.column_name = item.substr(pos_open + 1, item.size() - pos_open - 2);
+            if (projection.aggregate == EnumAggregateType::IDLE || (projection.column_name == "*" && projection.aggregate != EnumAggregateType::COUNT))
+            {
+                context_.error_indication = EnumParserErrorIndication::INVALID_PROJECTION;
+                return false;
+            }
+        }
+
+        vec_projection.emplace_back(std::move(projection));
+        item.clear();
+        return true;
+    };
+
+    for (auto& _char : str_projection)
+    {
+        if (_char != ',') item.append(1, _char);
+        else if (!append_item()) return false;
+    }
+
+    return append_item();
+}
+
+bool FsmParser::parseAssignmentList(std::string& str_assignment, std::vector<AssignmentDescriptor_t>& vec_assignment)
+{
+    // a token may hold several comma separated "column=value" items, e.g. "a=1,b=2," or ","
+    std::string item = "";
+    auto append_item = [&]()
+    {
+        if (item.empty()) return true;
+
+        auto pos_equal = item.find('=');
+        if (pos_equal == 0 || pos_equal == std::string::npos || pos_equal + 1 == item.size())
+        {
+            context_.error_indication = EnumParserErrorIndication::INVALID_ASSIGNMENT;
+            return false;
+        }
+
+        vec_assignment.emplace_back(AssignmentDescriptor_t{item.substr(0, pos_equal), item.substr(pos_equal + 1)});
+        item.clear();
+        return true;
+    };
+
+    for (auto& _char : str_assignment)
+    {
+        if (_char != ',') item.append(1, _char);
+        else if (!append_item()) return false;
+    }
+
+    return append_item();
+}
+
+bool FsmParser::parseNumber(std::string& str_number, uint32_t& number)
+{
+    if (str_number.empty() || !std::all_of(str_number.begin(), str_number.end(), ::isdigit))
+    {
+        context_.error_indication = EnumParserErrorIndication::INVALID_NUMBER;
+        return false;
+    }
+
+    try
+    {
+        auto num_val = std::stoull(str_number);
+        if (num_val > UINT32_MAX) throw std::out_of_range(str_number);
+        number = static_cast<uint32_t>(num_val);
+    }
+    catch (std::out_of_range const &exception)
+    {
+        context_.error_indication = EnumParserErrorIndication::INVALID_NUMBER;
+        return false;
+    }
+
+    return true;
+}
+
 bool FsmParser::transit(EnumParserParamType param_type)
 {
     auto iter_state = state_transition_table_.find(TransitionKey_t{context_.cur_state, param_type}); 
@@ -577,7 +1419,10 @@ bool FsmParser::transit(EnumParserParamType param_type)
             return false;
         }
 
-        context_.data_carrier = iter_state->second.on_changing_data_carrier;
+        // a spent packet of the same type lends its buffers, the empty template is assigned over it in place
+        auto& carrier_template = iter_state->second.on_changing_data_carrier;
+        if (envelope_.packet.index() == carrier_template.index()) std::swap(context_.data_carrier, envelope_.packet);
+        context_.data_carrier = carrier_template;
     }
 
     if (!iter_state->second.func_action())
@@ -609,7 +1454,22 @@ void FsmParser::errorIndicationHandler()
         }
         case EnumParserErrorIndication::INVALID_CONDITION:
         {
-            printf("Invalid condition \"%s\"", context_.cur_param.c_str());
+            printf("Invalid condition \"%s\"\n", context_.cur_param.c_str());
+            break;
+        }
+        case EnumParserErrorIndication::INVALID_PROJECTION:
+        {
+            printf("Invalid projection \"%s\"\n", context_.cur_param.c_str());
+            break;
+        }
+        case EnumParserErrorIndication::INVALID_ASSIGNMENT:
+        {
+            printf("Invalid assignment \"%s\"\n", context_.cur_param.c_str());
+            break;
+        }
+        case EnumParserErrorIndication::INVALID_NUMBER:
+        {
+            printf("Invalid number \"%s\"\n", context_.cur_param.c_str());
             break;
         }
         default:
@@ -620,9 +1480,26 @@ void FsmParser::errorIndicationHandler()
     }
 }
 
-bool FsmParser::sendToExecutor(PacketCollection_t&& command)
+bool FsmParser::startCapture(const std::string& trace_path)
+{
+    return trace_writer_.open(trace_path);
+}
+
+bool FsmParser::sendToExecutor(PacketCollection_t& command)
 {
-    return sp_lfq_->push(command);
+    // the command is swapped into the envelope, never copied, and the carrier gets the spare in exchange
+    std::swap(envelope_.packet, command);
+    envelope_.enqueue_ns = getSteadyNs();
+
+    // the enqueue stamp doubles as the flow id that links this span to the dequeue on the executor
+    trace::SpanGuard_t span("enqueue", "queue", envelope_.enqueue_ns, trace::EnumSpanFlowType::START);
+
+    // recorded only when the executor is sure to get it, a replay sees the same packets
+    // the parser is the only producer, so a slot found free stays free until the push
+    if (trace_writer_.isOpen() && !sp_lfq_->isFull()) trace_writer_.write(envelope_);
+
+    // the slot hands back the packet the executor is done with, it is the spare for the next carrier
+    return sp_lfq_->pushSwap(envelope_);
 }
 
 EnumParserParamType FsmParser::getParamType(std::string copied_param)
@@ -633,10 +1510,13 @@ EnumParserParamType FsmParser::getParamType(std::string copied_param)
     {
         return EnumParserParamType::VALUE_OR_NAME;
     }
-    else
+
+    // a keyword is only reserved where the current state expects it, elsewhere it is a name or a value like any other word
+    if (state_transition_table_.find(TransitionKey_t{context_.cur_state, iter_param->second}) == state_transition_table_.end())
     {
-        return iter_param->second;
+        return EnumParserParamType::VALUE_OR_NAME;
     }
+    return iter_param->second;
 }
 
 EnumValueType FsmParser::getValueType(std::string copied_type)
@@ -644,8 +1524,47 @@ EnumValueType FsmParser::getValueType(std::string copied_type)
     std::transform(copied_type.begin(), copied_type.end(), copied_type.begin(), ::toupper);
     if (copied_type == "INT") return EnumValueType::VALUE_TYPE_INT;
     else if (copied_type == "STRING") return EnumValueType::VALUE_TYPE_STRING;
+    else if (copied_type == "BIGINT") return EnumValueType::VALUE_TYPE_BIGINT;
+    else if (copied_type == "DOUBLE") return EnumValueType::VALUE_TYPE_DOUBLE;
+    else if (copied_type == "TIMESTAMP") return EnumValueType::VALUE_TYPE_TIMESTAMP;
     return EnumValueType::VALUE_TYPE_IDLE;
 }
 
+EnumOrderDirection FsmParser::getOrderDirection(std::string copied_direction)
+{
+    std::transform(copied_direction.begin(), copied_direction.end(), copied_direction.begin(), ::toupper);
+    if (copied_direction == "ASC") return EnumOrderDirection::ASC;
+    else if (copied_direction == "DESC") return EnumOrderDirection::DESC;
+    return EnumOrderDirection::IDLE;
+}
+
+EnumAggregateType FsmParser::getAggregateType(std::string copied_aggregate)
+{
+    std::transform(copied_aggregate.begin(), copied_aggregate.end(), copied_aggregate.begin(), ::toupper);
+    if (copied_aggregate == "COUNT") return EnumAggregateType::COUNT;
+    else if (copied_aggregate == "SUM") return EnumAggregateType::SUM;
+    else if (copied_aggregate == "MIN") return EnumAggregateType::MIN;
+    else if (copied_aggregate == "MAX") return EnumAggregateType::MAX;
+    else if (copied_aggregate == "AVG") return EnumAggregateType::AVG;
+    return EnumAggregateType::IDLE;
+}
+
+EnumTransactionActionType FsmParser::getTransactionAction(std::string copied_action)
+{
+    std::transform(copied_action.begin(), copied_action.end(), copied_action.begin(), ::toupper);
+    if (copied_action == "BEGIN") return EnumTransactionActionType::BEGIN;
+    else if (copied_action == "COMMIT") return EnumTransactionActionType::COMMIT;
+    else if (copied_action == "ROLLBACK") return EnumTransactionActionType::ROLLBACK;
+    return EnumTransactionActionType::IDLE;
+}
+
+EnumShowTargetType FsmParser::getShowTarget(std::string copied_target)
+{
+    std::transform(copied_target.begin(), copied_target.end(), copied_target.begin(), ::toupper);
+    if (copied_target == "STATS") return EnumShowTargetType::STATS;
+    else if (copied_target == "MEMORY") return EnumShowTargetType::MEMORY;
+    return EnumShowTargetType::IDLE;
+}
+
 
 }
\ No newline at end of file
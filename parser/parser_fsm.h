@@ -9,6 +9,7 @@
 #include "def/parser_def.h"
 #include "def/sql_interface_def.h"
 #include "common/lock_free_queue.h"
+#include "trace/sql_trace.h"
 
 namespace sql::fsm
 {
@@ -35,27 +36,42 @@ struct FsmContext_t
 class FsmParser
 {
 public:
-    bool init(std::shared_ptr<LockFreeQueue<PacketCollection_t>>& sp_flq, std::shared_ptr<bool>& sp_app_running);
+    bool init(std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>& sp_flq, std::shared_ptr<bool>& sp_app_running);
     bool parseInput(std::vector<std::string>& params);
 
+    // records every packet handed to the executor into a trace sql_replay can feed back
+    bool startCapture(const std::string& trace_path);
+
 private:
     bool registerParam(std::string&& keyword, const EnumParserParamType param_type);
     bool registerTransition(TransitionKey_t&& condition, TransitionProperty_t&& action);
 
     bool parseCondition(std::string& str_condition, ConditionDescriptor_t& condition);
+    bool parseLikePattern(std::string& str_pattern, ConditionDescriptor_t& condition);
+    bool verifyCondition(const ConditionDescriptor_t& condition);
+    bool parseJoinCondition(std::string& str_condition, JoinDescriptor_t& join);
+    bool parseNumber(std::string& str_number, uint32_t& number);
+    bool parseAssignmentList(std::string& str_assignment, std::vector<AssignmentDescriptor_t>& vec_assignment);
+    bool parseProjectionList(std::string& str_projection, std::vector<ProjectionDescriptor_t>& vec_projection);
     bool transit(EnumParserParamType param_type);
     void errorIndicationHandler();
-    bool sendToExecutor(PacketCollection_t&& command);
+    bool sendToExecutor(PacketCollection_t& command);   // takes the command over instead of copying it
 
     EnumParserParamType getParamType(std::string copied_param);
     EnumValueType static getValueType(std::string copied_type);
+    EnumOrderDirection static getOrderDirection(std::string copied_direction);
+    EnumAggregateType static getAggregateType(std::string copied_aggregate);
+    EnumTransactionActionType static getTransactionAction(std::string copied_action);
+    EnumShowTargetType static getShowTarget(std::string copied_target);
 
     StateTransitionTable_t  state_transition_table_;
     ParamMappingTable_t     param_mapping_table_;
     FsmContext_t            context_;
 
-    std::shared_ptr<LockFreeQueue<PacketCollection_t>>  sp_lfq_;
+    std::shared_ptr<LockFreeQueue<PacketEnvelope_t>>  sp_lfq_;
+    PacketEnvelope_t                                    envelope_;   // traded for a slot of the ring on every send, then holds the spent packet
     std::shared_ptr<bool>                               sp_app_running_;
+    trace::SqlTraceWriter_t                             trace_writer_;
 };
 
 } // namespace fsm
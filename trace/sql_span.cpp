@@ -0,0 +1,134 @@
+#include "chrono"
+
+#include "trace/sql_span.h"
+
+namespace sql::trace
+{
+
+SqlSpanTracer_t& SqlSpanTracer_t::getInstance()
+{
+    static SqlSpanTracer_t tracer;
+    return tracer;
+}
+
+SqlSpanTracer_t::~SqlSpanTracer_t()
+{
+    stop();
+}
+
+bool SqlSpanTracer_t::start(const std::string& file_path)
+{
+    if (p_file_ != nullptr)
+    {
+        printf("Fail to start span tracing: already tracing\n");
+        return false;
+    }
+
+    p_file_ = fopen(file_path.c_str(), "w");
+    if (p_file_ == nullptr)
+    {
+        printf("Fail to open span trace \"%s\"\n", file_path.c_str());
+        return false;
+    }
+
+    // the array form, a viewer still loads the file when the closing bracket never got written
+    fprintf(p_file_, "[\n");
+    origin_ns_ = getSteadyNs();
+    is_first_event_ = true;
+    is_flushing_ = true;
+    th_flush_ = std::thread(&SqlSpanTracer_t::runFlush, this);
+    is_tracing_ = true;
+    return true;
+}
+
+void SqlSpanTracer_t::stop()
+{
+    if (!th_flush_.joinable()) return;
+
+    is_tracing_ = false;
+    is_flushing_ = false;
+    th_flush_.join();
+
+    flush();
+    fprintf(p_file_, "\n]\n");
+    fclose(p_file_);
+    p_file_ = nullptr;
+
+    uint64_t num_dropped = 0;
+    for (auto& p_ring : vec_ring_) num_dropped += p_ring->lfq.getFullCount();
+    if (num_dropped > 0) printf("Span trace dropped %lu span(s), the rings filled up between two flushes\n", num_dropped);
+}
+
+SqlSpanTracer_t::ThreadRing_t* SqlSpanTracer_t::getThreadRing()
+{
+    if (p_thread_ring_ != nullptr) return p_thread_ring_;
+
+    std::lock_guard<std::mutex> lock(mtx_ring_);
+    vec_ring_.emplace_back(std::make_unique<ThreadRing_t>());
+    vec_ring_.back()->tid = static_cast<uint32_t>(vec_ring_.size());
+    p_thread_ring_ = vec_ring_.back().get();
+    return p_thread_ring_;
+}
+
+void SqlSpanTracer_t::record(const Span_t& span)
+{
+    // a full ring drops the span and counts it, tracing never stalls a statement
+    getThreadRing()->lfq.push(span);
+}
+
+void SqlSpanTracer_t::nameThread(const std::string& name)
+{
+    auto p_ring = getThreadRing();
+    std::lock_guard<std::mutex> lock(mtx_ring_);
+    p_ring->name = name;
+    p_ring->is_name_written = false;
+}
+
+void SqlSpanTracer_t::runFlush()
+{
+    while (is_flushing_)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_SPAN_FLUSH_INTERVAL_MS));
+        flush();
+    }
+}
+
+// only the flush thread, or stop() once it has joined, gets here
+void SqlSpanTracer_t::flush()
+{
+    std::lock_guard<std::mutex> lock(mtx_ring_);
+
+    auto separate = [this]()
+    {
+        if (!is_first_event_) fprintf(p_file_, ",\n");
+        is_first_event_ = false;
+    };
+    auto getTs = [this](uint64_t ns) { return (ns >= origin_ns_) ? (ns - origin_ns_) / 1e3 : 0.0; };
+
+    Span_t span;
+    for (auto& p_ring : vec_ring_)
+    {
+        if (!p_ring->is_name_written && !p_ring->name.empty())
+        {
+            separate();
+            fprintf(p_file_, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", p_ring->tid, p_ring->name.c_str());
+            p_ring->is_name_written = true;
+        }
+
+        while (p_ring->lfq.pop(span))
+        {
+            separate();
+            fprintf(p_file_, "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                    span.name, span.category, getTs(span.begin_ns), (span.end_ns - span.begin_ns) / 1e3, p_ring->tid);
+            if (span.flow == EnumSpanFlowType::IDLE) continue;
+
+            // the arrow binds to the slice enclosing its timestamp, the start of this span
+            fprintf(p_file_, ",\n{\"name\":\"statement\",\"cat\":\"flow\",\"ph\":\"%s\",\"id\":%lu,\"ts\":%.3f,\"pid\":1,\"tid\":%u%s}",
+                    (span.flow == EnumSpanFlowType::START) ? "s" : "f", span.flow_id, getTs(span.begin_ns), p_ring->tid,
+                    (span.flow == EnumSpanFlowType::FINISH) ? ",\"bp\":\"e\"" : "");
+        }
+    }
+    fflush(p_file_);
+}
+
+} // namespace sql::trace
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "atomic"
+#include "memory"
+#include "mutex"
+#include "string"
+#include "thread"
+#include "vector"
+#include "stdint.h"
+#include "stdio.h"
+
+#include "def/sql_interface_def.h"
+#include "common/lock_free_queue.h"
+
+#define TRACE_SPAN_RING_SIZE        65536   // spans a thread can hold between two flushes, later ones are dropped
+#define TRACE_SPAN_FLUSH_INTERVAL_MS 100
+
+namespace sql::trace
+{
+
+// links a span on one thread to a span on another, drawn as an arrow on the timeline
+enum class EnumSpanFlowType
+{
+    IDLE      = 0,
+    START,
+    FINISH,
+};
+
+// names and categories must be string literals, a span is recorded without allocating
+struct Span_t
+{
+    const char*       name = nullptr;
+    const char*       category = nullptr;
+    uint64_t          begin_ns = 0;
+    uint64_t          end_ns = 0;
+    uint64_t          flow_id = 0;
+    EnumSpanFlowType  flow = EnumSpanFlowType::IDLE;
+};
+
+// opt-in timeline of where statements spend their time, written as Chrome trace event JSON (chrome://tracing, Perfetto)
+class SqlSpanTracer_t
+{
+public:
+    static SqlSpanTracer_t& getInstance();
+    ~SqlSpanTracer_t();
+
+    bool start(const std::string& file_path);
+    void stop();
+    static inline bool isTracing() { return is_tracing_.load(std::memory_order_relaxed); }
+
+    // into the ring of the calling thread, only that thread writes it and only the flush thread reads it
+    void record(const Span_t& span);
+    void nameThread(const std::string& name);
+
+private:
+    struct ThreadRing_t
+    {
+        uint32_t               tid;
+        std::string            name;
+        bool                   is_name_written = false;
+        LockFreeQueue<Span_t>  lfq{TRACE_SPAN_RING_SIZE};
+    };
+
+    SqlSpanTracer_t() = default;
+    ThreadRing_t* getThreadRing();
+    void runFlush();
+    void flush();
+
+    static inline std::atomic<bool>               is_tracing_ = false;
+    static inline thread_local ThreadRing_t*      p_thread_ring_ = nullptr;
+
+    std::mutex                                    mtx_ring_;
+    std::vector<std::unique_ptr<ThreadRing_t>>    vec_ring_;
+
+    FILE*                                         p_file_ = nullptr;
+    uint64_t                                      origin_ns_ = 0;
+    bool                                          is_first_event_ = true;
+    std::atomic<bool>                             is_flushing_ = false;
+    std::thread                                   th_flush_;
+};
+
+// records the lifetime of the guard as a span, costs one relaxed load when tracing is off
+class SpanGuard_t
+{
+public:
+    SpanGuard_t(const char* name, const char* category, uint64_t flow_id = 0, EnumSpanFlowType flow = EnumSpanFlowType::IDLE)
+        : span_{name, category, SqlSpanTracer_t::isTracing() ? getSteadyNs() : 0, 0, flow_id, flow} {}
+    ~SpanGuard_t()
+    {
+        if (span_.begin_ns == 0) return;
+        span_.end_ns = getSteadyNs();
+        SqlSpanTracer_t::getInstance().record(span_);
+    }
+
+private:
+    Span_t  span_;
+};
+
+} // namespace sql::trace
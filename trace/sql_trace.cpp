@@ -0,0 +1,523 @@
+#include "bit"
+#include "string.h"
+
+#include "trace/sql_trace.h"
+
+namespace sql::trace
+{
+
+// reads the fields of one record body, every get fails once the body runs out
+struct TraceCursor_t
+{
+    const char*  p_begin;
+    const char*  p_end;
+
+    bool getVarint(uint64_t& value)
+    {
+        value = 0;
+        for (uint32_t shift = 0; shift < 64 && p_begin < p_end; shift += 7)
+        {
+            uint8_t byte = static_cast<uint8_t>(*p_begin ++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+};
+
+static void putVarint(std::string& buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+// every field type has an encodeField and a decodeField, the packet types are built from them
+
+static void encodeField(std::string& buffer, const std::string& value)
+{
+    putVarint(buffer, value.size());
+    buffer.append(value);
+}
+
+static bool decodeField(TraceCursor_t& cursor, std::string& value)
+{
+    uint64_t size;
+    if (!cursor.getVarint(size) || size > static_cast<uint64_t>(cursor.p_end - cursor.p_begin)) return false;
+    value.assign(cursor.p_begin, size);
+    cursor.p_begin += size;
+    return true;
+}
+
+static void encodeField(std::string& buffer, const bool value)
+{
+    putVarint(buffer, value ? 1 : 0);
+}
+
+static bool decodeField(TraceCursor_t& cursor, bool& value)
+{
+    uint64_t raw;
+    if (!cursor.getVarint(raw)) return false;
+    value = (raw != 0);
+    return true;
+}
+
+static void encodeField(std::string& buffer, const uint32_t value)
+{
+    putVarint(buffer, value);
+}
+
+static bool decodeField(TraceCursor_t& cursor, uint32_t& value)
+{
+    uint64_t raw;
+    if (!cursor.getVarint(raw)) return false;
+    value = static_cast<uint32_t>(raw);
+    return true;
+}
+
+template <typename EnumType, typename = std::enable_if_t<std::is_enum_v<EnumType>>>
+static void encodeField(std::string& buffer, const EnumType value)
+{
+    putVarint(buffer, static_cast<uint64_t>(value));
+}
+
+template <typename EnumType, typename = std::enable_if_t<std::is_enum_v<EnumType>>>
+static bool decodeField(TraceCursor_t& cursor, EnumType& value)
+{
+    uint64_t raw;
+    if (!cursor.getVarint(raw)) return false;
+    value = static_cast<EnumType>(raw);
+    return true;
+}
+
+static void encodeField(std::string& buffer, const SqlValue_t& value)
+{
+    putVarint(buffer, value.index());
+    if (auto p_int = std::get_if<int32_t>(&value))
+    {
+        // zigzag, small negative numbers stay one byte
+        putVarint(buffer, (static_cast<uint32_t>(*p_int) << 1) ^ static_cast<uint32_t>(*p_int >> 31));
+    }
+    else if (auto p_string = std::get_if<std::string>(&value))
+    {
+        encodeField(buffer, *p_string);
+    }
+    else if (auto p_bigint = std::get_if<int64_t>(&value))
+    {
+        putVarint(buffer, (static_cast<uint64_t>(*p_bigint) << 1) ^ static_cast<uint64_t>(*p_bigint >> 63));
+    }
+    else if (auto p_double = std::get_if<double>(&value))
+    {
+        putVarint(buffer, std::bit_cast<uint64_t>(*p_double));
+    }
+}
+
+static bool decodeField(TraceCursor_t& cursor, SqlValue_t& value)
+{
+    uint64_t index;
+    if (!cursor.getVarint(index)) return false;
+    switch (index)
+    {
+        case 0:
+        {
+            value = std::monostate{};
+            return true;
+        }
+        case 1:
+        {
+            uint64_t raw;
+            if (!cursor.getVarint(raw)) return false;
+            value = static_cast<int32_t>((static_cast<uint32_t>(raw) >> 1) ^ (0u - (static_cast<uint32_t>(raw) & 1)));
+            return true;
+        }
+        case 2:
+        {
+            std::string str_value;
+            if (!decodeField(cursor, str_value)) return false;
+            value = std::move(str_value);
+            return true;
+        }
+        case 3:
+        {
+            uint64_t raw;
+            if (!cursor.getVarint(raw)) return false;
+            value = static_cast<int64_t>((raw >> 1) ^ (0ull - (raw & 1)));
+            return true;
+        }
+        case 4:
+        {
+            uint64_t raw;
+            if (!cursor.getVarint(raw)) return false;
+            value = std::bit_cast<double>(raw);
+            return true;
+        }
+        default: return false;
+    }
+}
+
+static void encodeField(std::string& buffer, const TableColumnProperty_t& value)
+{
+    encodeField(buffer, value.column_name);
+    encodeField(buffer, value.value_type);
+    encodeField(buffer, value.is_primary);
+    encodeField(buffer, value.is_bloom);
+    encodeField(buffer, value.is_indexed);
+}
+
+static bool decodeField(TraceCursor_t& cursor, TableColumnProperty_t& value)
+{
+    return decodeField(cursor, value.column_name) && decodeField(cursor, value.value_type)
+        && decodeField(cursor, value.is_primary) && decodeField(cursor, value.is_bloom)
+        && decodeField(cursor, value.is_indexed);
+}
+
+static void encodeField(std::string& buffer, const ConditionDescriptor_t& value)
+{
+    encodeField(buffer, value.column_name);
+    encodeField(buffer, value.action);
+    encodeField(buffer, value.anchor_val);
+}
+
+static bool decodeField(TraceCursor_t& cursor, ConditionDescriptor_t& value)
+{
+    return decodeField(cursor, value.column_name) && decodeField(cursor, value.action) && decodeField(cursor, value.anchor_val);
+}
+
+static void encodeField(std::string& buffer, const OrderDescriptor_t& value)
+{
+    encodeField(buffer, value.column_name);
+    encodeField(buffer, value.direction);
+}
+
+static bool decodeField(TraceCursor_t& cursor, OrderDescriptor_t& value)
+{
+    return decodeField(cursor, value.column_name) && decodeField(cursor, value.direction);
+}
+
+static void encodeField(std::string& buffer, const LimitDescriptor_t& value)
+{
+    encodeField(buffer, value.is_limited);
+    encodeField(buffer, value.count);
+    encodeField(buffer, value.offset);
+}
+
+static bool decodeField(TraceCursor_t& cursor, LimitDescriptor_t& value)
+{
+    return decodeField(cursor, value.is_limited) && decodeField(cursor, value.count) && decodeField(cursor, value.offset);
+}
+
+static void encodeField(std::string& buffer, const JoinDescriptor_t& value)
+{
+    encodeField(buffer, value.table_name);
+    encodeField(buffer, value.lhs_column_name);
+    encodeField(buffer, value.rhs_column_name);
+}
+
+static bool decodeField(TraceCursor_t& cursor, JoinDescriptor_t& value)
+{
+    return decodeField(cursor, value.table_name) && decodeField(cursor, value.lhs_column_name) && decodeField(cursor, value.rhs_column_name);
+}
+
+static void encodeField(std::string& buffer, const ProjectionDescriptor_t& value)
+{
+    encodeField(buffer, value.column_name);
+    encodeField(buffer, value.aggregate);
+}
+
+static bool decodeField(TraceCursor_t& cursor, ProjectionDescriptor_t& value)
+{
+    return decodeField(cursor, value.column_name) && decodeField(cursor, value.aggregate);
+}
+
+static void encodeField(std::string& buffer, const AssignmentDescriptor_t& value)
+{
+    encodeField(buffer, value.column_name);
+    encodeField(buffer, value.value);
+}
+
+static bool decodeField(TraceCursor_t& cursor, AssignmentDescriptor_t& value)
+{
+    return decodeField(cursor, value.column_name) && decodeField(cursor, value.value);
+}
+
+template <typename ElementType>
+static void encodeField(std::string& buffer, const std::vector<ElementType>& vec_value)
+{
+    putVarint(buffer, vec_value.size());
+    for (auto& value : vec_value) encodeField(buffer, value);
+}
+
+template <typename ElementType>
+static bool decodeField(TraceCursor_t& cursor, std::vector<ElementType>& vec_value)
+{
+    uint64_t size;
+    if (!cursor.getVarint(size)) return false;
+
+    // every element takes at least one byte, a damaged size can not make it allocate past the body
+    if (size > static_cast<uint64_t>(cursor.p_end - cursor.p_begin)) return false;
+    vec_value.resize(size);
+    for (auto& value : vec_value)
+    {
+        if (!decodeField(cursor, value)) return false;
+    }
+    return true;
+}
+
+static void encodeField(std::string&, const std::monostate&) {}
+static bool decodeField(TraceCursor_t&, std::monostate&) { return true; }
+
+static void encodeField(std::string& buffer, const PacketCreateDatabase_t& packet) { encodeField(buffer, packet.db_name); }
+static bool decodeField(TraceCursor_t& cursor, PacketCreateDatabase_t& packet) { return decodeField(cursor, packet.db_name); }
+
+static void encodeField(std::string& buffer, const PacketDropDatabase_t& packet) { encodeField(buffer, packet.db_name); }
+static bool decodeField(TraceCursor_t& cursor, PacketDropDatabase_t& packet) { return decodeField(cursor, packet.db_name); }
+
+static void encodeField(std::string& buffer, const PacketUseDatabase_t& packet) { encodeField(buffer, packet.db_name); }
+static bool decodeField(TraceCursor_t& cursor, PacketUseDatabase_t& packet) { return decodeField(cursor, packet.db_name); }
+
+static void encodeField(std::string& buffer, const PacketDropTable_t& packet) { encodeField(buffer, packet.table_name); }
+static bool decodeField(TraceCursor_t& cursor, PacketDropTable_t& packet) { return decodeField(cursor, packet.table_name); }
+
+static void encodeField(std::string& buffer, const PacketTransaction_t& packet) { encodeField(buffer, packet.action); }
+static bool decodeField(TraceCursor_t& cursor, PacketTransaction_t& packet) { return decodeField(cursor, packet.action); }
+
+static void encodeField(std::string& buffer, const PacketShow_t& packet) { encodeField(buffer, packet.target); }
+static bool decodeField(TraceCursor_t& cursor, PacketShow_t& packet) { return decodeField(cursor, packet.target); }
+
+static void encodeField(std::string& buffer, const PacketCreateTable_t& packet)
+{
+    encodeField(buffer, packet.table_name);
+    encodeField(buffer, packet.vec_column_property);
+}
+
+static bool decodeField(TraceCursor_t& cursor, PacketCreateTable_t& packet)
+{
+    return decodeField(cursor, packet.table_name) && decodeField(cursor, packet.vec_column_property);
+}
+
+static void encodeField(std::string& buffer, const PacketSelect_t& packet)
+{
+    encodeField(buffer, packet.table_name);
+    encodeField(buffer, packet.vec_projection);
+    encodeField(buffer, packet.join);
+    encodeField(buffer, packet.condition);
+    encodeField(buffer, packet.group_column_name);
+    encodeField(buffer, packet.order);
+    encodeField(buffer, packet.limit);
+    encodeField(buffer, packet.explain);
+}
+
+static bool decodeField(TraceCursor_t& cursor, PacketSelect_t& packet)
+{
+    return decodeField(cursor, packet.table_name) && decodeField(cursor, packet.vec_projection) && decodeField(cursor, packet.join)
+        && decodeField(cursor, packet.condition) && decodeField(cursor, packet.group_column_name) && decodeField(cursor, packet.order)
+        && decodeField(cursor, packet.limit) && decodeField(cursor, packet.explain);
+}
+
+static void encodeField(std::string& buffer, const PacketDelect_t& packet)
+{
+    encodeField(buffer, packet.table_name);
+    encodeField(buffer, packet.condition);
+    encodeField(buffer, packet.explain);
+}
+
+static bool decodeField(TraceCursor_t& cursor, PacketDelect_t& packet)
+{
+    return decodeField(cursor, packet.table_name) && decodeField(cursor, packet.condition) && decodeField(cursor, packet.explain);
+}
+
+static void encodeField(std::string& buffer, const PacketInsert_t& packet)
+{
+    encodeField(buffer, packet.table_name);
+    encodeField(buffer, packet.vec_value);
+}
+
+static bool decodeField(TraceCursor_t& cursor, PacketInsert_t& packet)
+{
+    return decodeField(cursor, packet.table_name) && decodeField(cursor, packet.vec_value);
+}
+
+static void encodeField(std::string& buffer, const PacketUpdate_t& packet)
+{
+    encodeField(buffer, packet.table_name);
+    encodeField(buffer, packet.vec_assignment);
+    encodeField(buffer, packet.condition);
+    encodeField(buffer, packet.explain);
+}
+
+static bool decodeField(TraceCursor_t& cursor, PacketUpdate_t& packet)
+{
+    return decodeField(cursor, packet.table_name) && decodeField(cursor, packet.vec_assignment) && decodeField(cursor, packet.condition)
+        && decodeField(cursor, packet.explain);
+}
+
+// walks the packet types in variant order, a new packet type only needs its encodeField and decodeField
+template <size_t Index = 0>
+static void encodePacket(std::string& buffer, const PacketCollection_t& packet)
+{
+    if constexpr (Index < std::variant_size_v<PacketCollection_t>)
+    {
+        if (packet.index() == Index) encodeField(buffer, std::get<Index>(packet));
+        else encodePacket<Index + 1>(buffer, packet);
+    }
+}
+
+template <size_t Index = 0>
+static bool decodePacket(TraceCursor_t& cursor, uint64_t packet_type, PacketCollection_t& packet)
+{
+    if constexpr (Index < std::variant_size_v<PacketCollection_t>)
+    {
+        if (packet_type != Index) return decodePacket<Index + 1>(cursor, packet_type, packet);
+
+        std::variant_alternative_t<Index, PacketCollection_t> typed_packet;
+        if (!decodeField(cursor, typed_packet)) return false;
+        packet = std::move(typed_packet);
+        return true;
+    }
+    return false;
+}
+
+void encodePacketBody(std::string& buffer, const PacketCollection_t& packet)
+{
+    putVarint(buffer, packet.index());
+    encodePacket(buffer, packet);
+}
+
+bool decodePacketBody(const char* p_begin, const char* p_end, PacketCollection_t& packet)
+{
+    TraceCursor_t cursor{p_begin, p_end};
+    uint64_t packet_type;
+    return cursor.getVarint(packet_type) && decodePacket(cursor, packet_type, packet) && cursor.p_begin == cursor.p_end;
+}
+
+bool SqlTraceWriter_t::open(const std::string& path)
+{
+    close();
+    p_file_ = fopen(path.c_str(), "wb");
+    if (p_file_ == nullptr)
+    {
+        printf("Fail to open trace \"%s\" for writing\n", path.c_str());
+        return false;
+    }
+
+    std::string header(TRACE_MAGIC);
+    putVarint(header, TRACE_VERSION);
+    if (fwrite(header.data(), 1, header.size(), p_file_) != header.size())
+    {
+        printf("Fail to write trace \"%s\"\n", path.c_str());
+        close();
+        return false;
+    }
+    last_ns_ = 0;
+    return true;
+}
+
+void SqlTraceWriter_t::close()
+{
+    if (p_file_ == nullptr) return;
+    fclose(p_file_);
+    p_file_ = nullptr;
+}
+
+bool SqlTraceWriter_t::write(const PacketEnvelope_t& envelope)
+{
+    // the first record carries the full timestamp, the later ones only the gap to their predecessor
+    buffer_.clear();
+    putVarint(buffer_, envelope.enqueue_ns - last_ns_);
+    putVarint(buffer_, envelope.packet.index());
+    encodePacket(buffer_, envelope.packet);
+    last_ns_ = envelope.enqueue_ns;
+
+    std::string length;
+    putVarint(length, buffer_.size());
+    if (fwrite(length.data(), 1, length.size(), p_file_) != length.size() || fwrite(buffer_.data(), 1, buffer_.size(), p_file_) != buffer_.size())
+    {
+        printf("Fail to write trace record, capture stopped\n");
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SqlTraceReader_t::open(const std::string& path)
+{
+    close();
+    p_file_ = fopen(path.c_str(), "rb");
+    if (p_file_ == nullptr)
+    {
+        printf("Fail to open trace \"%s\"\n", path.c_str());
+        return false;
+    }
+
+    char magic[sizeof(TRACE_MAGIC) - 1];
+    if (fread(magic, 1, sizeof(magic), p_file_) != sizeof(magic) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+    {
+        printf("Fail to open trace \"%s\": not a trace file\n", path.c_str());
+        close();
+        return false;
+    }
+    int version = fgetc(p_file_);
+    if (version != TRACE_VERSION)
+    {
+        printf("Fail to open trace \"%s\": version %d is not supported\n", path.c_str(), version);
+        close();
+        return false;
+    }
+    last_ns_ = 0;
+    is_broken_ = false;
+    return true;
+}
+
+void SqlTraceReader_t::close()
+{
+    if (p_file_ == nullptr) return;
+    fclose(p_file_);
+    p_file_ = nullptr;
+}
+
+bool SqlTraceReader_t::read(PacketEnvelope_t& envelope)
+{
+    if (p_file_ == nullptr) return false;
+
+    uint64_t size = 0;
+    for (uint32_t shift = 0; ; shift += 7)
+    {
+        int byte = fgetc(p_file_);
+        if (byte == EOF)
+        {
+            // a clean end falls between two records
+            is_broken_ = (shift > 0);
+            return false;
+        }
+        size |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) break;
+        if (shift >= 63)
+        {
+            is_broken_ = true;
+            return false;
+        }
+    }
+
+    buffer_.resize(size);
+    if (fread(buffer_.data(), 1, size, p_file_) != size)
+    {
+        is_broken_ = true;
+        return false;
+    }
+
+    TraceCursor_t cursor{buffer_.data(), buffer_.data() + size};
+    uint64_t gap_ns, packet_type;
+    if (!cursor.getVarint(gap_ns) || !cursor.getVarint(packet_type) || !decodePacket(cursor, packet_type, envelope.packet))
+    {
+        is_broken_ = true;
+        return false;
+    }
+    last_ns_ += gap_ns;
+    envelope.enqueue_ns = last_ns_;
+    return true;
+}
+
+} // namespace sql::trace
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "string"
+#include "stdint.h"
+#include "stdio.h"
+
+#include "def/sql_interface_def.h"
+
+#define TRACE_MAGIC      "SQLTRACE"
+#define TRACE_VERSION    2
+
+namespace sql::trace
+{
+
+// file layout: the magic, the version, then one record per packet
+// record: varint body length, varint nanoseconds since the previous record, varint packet type, the packet fields
+// integers are LEB128 varints (zigzag for signed ones), strings and vectors are prefixed with their length
+
+// the packet type and fields of one record, without its framing, the write-ahead log keeps its statements this way
+void encodePacketBody(std::string& buffer, const PacketCollection_t& packet);
+bool decodePacketBody(const char* p_begin, const char* p_end, PacketCollection_t& packet);
+
+class SqlTraceWriter_t
+{
+public:
+    ~SqlTraceWriter_t() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+    inline bool isOpen() const { return p_file_ != nullptr; }
+
+    bool write(const PacketEnvelope_t& envelope);
+
+private:
+    FILE*        p_file_ = nullptr;
+    uint64_t     last_ns_ = 0;
+    std::string  buffer_;       // reused by every record
+};
+
+class SqlTraceReader_t
+{
+public:
+    ~SqlTraceReader_t() { close(); }
+
+    bool open(const std::string& path);
+    void close();
+
+    // false at the end of the trace, isBroken() tells a clean end from a damaged record
+    bool read(PacketEnvelope_t& envelope);
+    inline bool isBroken() const { return is_broken_; }
+
+private:
+    FILE*        p_file_ = nullptr;
+    uint64_t     last_ns_ = 0;
+    bool         is_broken_ = false;
+    std::string  buffer_;
+};
+
+} // namespace sql::trace